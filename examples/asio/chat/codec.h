@@ -67,6 +67,16 @@ class LengthHeaderCodec : muduo::noncopyable
     conn->send(&buf);
   }
 
+  // encodes once, for sending the same message to many connections
+  static muduo::string encode(const muduo::StringPiece& message)
+  {
+    int32_t len = static_cast<int32_t>(message.size());
+    int32_t be32 = muduo::net::sockets::hostToNetwork32(len);
+    muduo::string result(reinterpret_cast<const char*>(&be32), sizeof be32);
+    result.append(message.data(), message.size());
+    return result;
+  }
+
  private:
   StringMessageCallback messageCallback_;
   const static size_t kHeaderLen = sizeof(int32_t);
@@ -59,7 +59,9 @@ class ChatServer : noncopyable
                        const string& message,
                        Timestamp)
   {
-    EventLoop::Functor f = std::bind(&ChatServer::distributeMessage, this, message);
+    // encoded once, shared by all connections of all loops
+    MessagePtr encoded = std::make_shared<const string>(LengthHeaderCodec::encode(message));
+    EventLoop::Functor f = std::bind(&ChatServer::distributeMessage, this, encoded);
     LOG_DEBUG;
 
     MutexLockGuard lock(mutex_);
@@ -77,8 +79,9 @@ class ChatServer : noncopyable
   }
 
   typedef std::set<TcpConnectionPtr> ConnectionList;
+  typedef std::shared_ptr<const string> MessagePtr;
 
-  void distributeMessage(const string& message)
+  void distributeMessage(const MessagePtr& message)
   {
     LOG_DEBUG << "begin";
     //LocalConnections是thread local变量，所以不需要保护
@@ -86,7 +89,7 @@ class ChatServer : noncopyable
         it != LocalConnections::instance().end();
         ++it)
     {
-      codec_.send(get_pointer(*it), message);
+      (*it)->send(message);
     }
     LOG_DEBUG << "end";
   }
@@ -42,7 +42,7 @@ class Topic : public muduo::copyable
   {
     content_ = content;
     lastPubTime_ = time;
-    string message = makeMessage();
+    std::shared_ptr<const string> message = std::make_shared<const string>(makeMessage());
     for (std::set<TcpConnectionPtr>::iterator it = audiences_.begin();
          it != audiences_.end();
          ++it)
@@ -0,0 +1,45 @@
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/TcpServer.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+// Same as echo.cc and sortedlist.cc, with TcpServer::setIdleTimeout().
+
+void onConnection(const TcpConnectionPtr& conn)
+{
+  LOG_INFO << "EchoServer - " << conn->peerAddress().toIpPort() << " -> "
+           << conn->localAddress().toIpPort() << " is "
+           << (conn->connected() ? "UP" : "DOWN");
+}
+
+void onMessage(const TcpConnectionPtr& conn,
+               Buffer* buf,
+               Timestamp time)
+{
+  conn->send(buf);
+}
+
+int main(int argc, char* argv[])
+{
+  EventLoop loop;
+  InetAddress listenAddr(2007);
+  int idleSeconds = 10;
+  if (argc > 1)
+  {
+    idleSeconds = atoi(argv[1]);
+  }
+  LOG_INFO << "pid = " << getpid() << ", idle seconds = " << idleSeconds;
+  TcpServer server(&loop, listenAddr, "EchoServer");
+  server.setConnectionCallback(onConnection);
+  server.setMessageCallback(onMessage);
+  server.setIdleTimeout(idleSeconds);
+  server.start();
+  loop.loop();
+}
+
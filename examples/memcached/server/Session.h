@@ -41,7 +41,7 @@ class Session : public std::enable_shared_from_this<Session>,
   {
     LOG_INFO << "requests processed: " << requestsProcessed_
              << " input buffer size: " << conn_->inputBuffer()->internalCapacity()
-             << " output buffer size: " << conn_->outputBuffer()->internalCapacity();
+             << " output bytes: " << conn_->outputBytes();
   }
 
  private:
@@ -126,7 +126,7 @@ class Tunnel : public std::enable_shared_from_this<Tunnel>,
 
     if (which == kServer)
     {
-      if (serverConn_->outputBuffer()->readableBytes() > 0)
+      if (serverConn_->outputBytes() > 0)
       {
         clientConn_->stopRead();
         serverConn_->setWriteCompleteCallback(
@@ -136,7 +136,7 @@ class Tunnel : public std::enable_shared_from_this<Tunnel>,
     }
     else
     {
-      if (clientConn_->outputBuffer()->readableBytes() > 0)
+      if (clientConn_->outputBytes() > 0)
       {
         serverConn_->stopRead();
         clientConn_->setWriteCompleteCallback(
@@ -0,0 +1,284 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+
+#include <muduo/base/Affinity.h>
+
+#include <muduo/base/FileUtil.h>
+
+#include <algorithm>
+
+#include <ctype.h>
+#include <dirent.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+
+using namespace muduo;
+
+namespace
+{
+
+const int kMaxFileSize = 1024 * 1024;
+
+string readFirstLine(const char* filename)
+{
+  string content;
+  FileUtil::readFile(filename, kMaxFileSize, &content);
+  size_t eol = content.find('\n');
+  if (eol != string::npos)
+  {
+    content.resize(eol);
+  }
+  return content;
+}
+
+bool isNuma()
+{
+  return ::access("/sys/devices/system/node/node1", F_OK) == 0;
+}
+
+}  // namespace
+
+CpuSet::CpuSet(const std::vector<int>& cpus)
+{
+  for (int cpu : cpus)
+  {
+    add(cpu);
+  }
+}
+
+CpuSet CpuSet::parse(StringArg cpulist)
+{
+  CpuSet result;
+  const char* p = cpulist.c_str();
+  while (*p != '\0' && *p != '\n')
+  {
+    char* end = NULL;
+    long first = ::strtol(p, &end, 10);
+    long last = first;
+    if (end == p || first < 0)
+    {
+      return CpuSet();
+    }
+    p = end;
+    if (*p == '-')
+    {
+      ++p;
+      last = ::strtol(p, &end, 10);
+      if (end == p || last < first)
+      {
+        return CpuSet();
+      }
+      p = end;
+    }
+    for (long cpu = first; cpu <= last; ++cpu)
+    {
+      result.add(static_cast<int>(cpu));
+    }
+    if (*p == ',')
+    {
+      ++p;
+    }
+    else if (*p != '\0' && *p != '\n')
+    {
+      return CpuSet();
+    }
+  }
+  return result;
+}
+
+CpuSet CpuSet::allowed()
+{
+  CpuSet result;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (::sched_getaffinity(0, sizeof set, &set) == 0)
+  {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+      if (CPU_ISSET(cpu, &set))
+      {
+        result.add(cpu);
+      }
+    }
+  }
+  return result;
+}
+
+CpuSet CpuSet::ofNode(int node)
+{
+  char filename[64];
+  snprintf(filename, sizeof filename, "/sys/devices/system/node/node%d/cpulist", node);
+  return parse(readFirstLine(filename));
+}
+
+CpuSet CpuSet::ofDevice(StringArg ifname)
+{
+  // "  45:   1234   0  IR-PCI-MSI 524289-edge  eth0-TxRx-0"
+  CpuSet result;
+  string interrupts;
+  FileUtil::readFile("/proc/interrupts", kMaxFileSize, &interrupts);
+  const size_t len = ::strlen(ifname.c_str());
+  size_t start = 0;
+  while (start < interrupts.size())
+  {
+    size_t eol = interrupts.find('\n', start);
+    if (eol == string::npos)
+    {
+      eol = interrupts.size();
+    }
+    string line(interrupts, start, eol - start);
+    start = eol + 1;
+
+    size_t pos = line.find_last_of(' ');
+    string name(line, pos == string::npos ? 0 : pos + 1);
+    if (name.compare(0, len, ifname.c_str()) != 0
+        || (name.size() > len && name[len] != '-'))
+    {
+      continue;
+    }
+    int irq = atoi(line.c_str());
+    char filename[64];
+    snprintf(filename, sizeof filename, "/proc/irq/%d/effective_affinity_list", irq);
+    CpuSet cpus = parse(readFirstLine(filename));
+    if (cpus.empty())
+    {
+      snprintf(filename, sizeof filename, "/proc/irq/%d/smp_affinity_list", irq);
+      cpus = parse(readFirstLine(filename));
+    }
+    if (!cpus.empty())
+    {
+      // queues on one CPU show up once
+      result.add(cpus[0]);
+    }
+  }
+  return result;
+}
+
+bool CpuSet::contains(int cpu) const
+{
+  return std::find(cpus_.begin(), cpus_.end(), cpu) != cpus_.end();
+}
+
+void CpuSet::add(int cpu)
+{
+  if (cpu >= 0 && !contains(cpu))
+  {
+    cpus_.push_back(cpu);
+  }
+}
+
+string CpuSet::toString() const
+{
+  string result;
+  size_t i = 0;
+  while (i < cpus_.size())
+  {
+    size_t j = i;
+    while (j + 1 < cpus_.size() && cpus_[j + 1] == cpus_[j] + 1)
+    {
+      ++j;
+    }
+    char buf[32];
+    if (j == i)
+    {
+      snprintf(buf, sizeof buf, "%d", cpus_[i]);
+    }
+    else
+    {
+      snprintf(buf, sizeof buf, "%d-%d", cpus_[i], cpus_[j]);
+    }
+    if (!result.empty())
+    {
+      result += ',';
+    }
+    result += buf;
+    i = j + 1;
+  }
+  return result;
+}
+
+CpuSet ThreadAffinity::cpusOf(size_t index) const
+{
+  CpuSet result;
+  if (mode_ == kEachOne)
+  {
+    result.add(cpus_[index]);
+  }
+  else if (mode_ == kShared)
+  {
+    result = cpus_;
+  }
+  return result;
+}
+
+bool ThreadAffinity::apply(size_t index) const
+{
+  CpuSet cpus = cpusOf(index);
+  if (cpus.empty())
+  {
+    return true;
+  }
+  bool ok = affinity::pinCurrentThread(cpus);
+  if (ok && numaLocal_ && isNuma())
+  {
+    ok = affinity::preferNode(affinity::nodeOfCpu(cpus[0]));
+  }
+  return ok;
+}
+
+bool affinity::pinCurrentThread(const CpuSet& cpus)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus.cpus())
+  {
+    if (cpu < CPU_SETSIZE)
+    {
+      CPU_SET(cpu, &set);
+    }
+  }
+  return CPU_COUNT(&set) > 0 && ::sched_setaffinity(0, sizeof set, &set) == 0;
+}
+
+int affinity::nodeOfCpu(int cpu)
+{
+  // /sys/devices/system/cpu/cpuN/nodeM links to its node
+  char dirname[64];
+  snprintf(dirname, sizeof dirname, "/sys/devices/system/cpu/cpu%d", cpu);
+  int node = 0;
+  DIR* dir = ::opendir(dirname);
+  if (dir)
+  {
+    struct dirent* entry = NULL;
+    while ((entry = ::readdir(dir)) != NULL)
+    {
+      if (::strncmp(entry->d_name, "node", 4) == 0 && isdigit(entry->d_name[4]))
+      {
+        node = atoi(entry->d_name + 4);
+        break;
+      }
+    }
+    ::closedir(dir);
+  }
+  return node;
+}
+
+bool affinity::preferNode(int node)
+{
+  // no libnuma, set_mempolicy(2) has no glibc wrapper
+  const int kBits = static_cast<int>(sizeof(unsigned long) * 8);
+  if (node < 0 || node >= kBits)
+  {
+    return false;
+  }
+  unsigned long mask = 1UL << node;
+  // maxnode counts one more than the bits of mask
+  return ::syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, kBits + 1) == 0;
+}
@@ -0,0 +1,121 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+
+#ifndef MUDUO_BASE_AFFINITY_H
+#define MUDUO_BASE_AFFINITY_H
+
+#include <muduo/base/copyable.h>
+#include <muduo/base/StringPiece.h>
+#include <muduo/base/Types.h>
+
+#include <vector>
+
+namespace muduo
+{
+
+///
+/// An ordered list of CPUs.
+///
+/// Order matters, ThreadAffinity puts i-th thread of a pool on i-th CPU,
+/// so a list from ofDevice() lines up threads with NIC receive queues.
+///
+class CpuSet : public muduo::copyable
+{
+ public:
+  CpuSet() { }
+  explicit CpuSet(const std::vector<int>& cpus);
+
+  /// Parses a cpulist, like "0-3,8,10-11", invalid ones give an empty set.
+  static CpuSet parse(StringArg cpulist);
+
+  /// CPUs the calling thread is allowed to run on.
+  static CpuSet allowed();
+
+  /// CPUs of NUMA node, from /sys/devices/system/node.
+  static CpuSet ofNode(int node);
+
+  /// CPUs handling the interrupts of network device ifname, in the order
+  /// of its queues, one per queue, from /proc/interrupts.
+  /// Empty if the device doesn't show up there, e.g. some virtual NICs.
+  static CpuSet ofDevice(StringArg ifname);
+
+  bool empty() const { return cpus_.empty(); }
+  size_t size() const { return cpus_.size(); }
+  bool contains(int cpu) const;
+  /// i-th CPU, wraps around.
+  int operator[](size_t i) const { return cpus_[i % cpus_.size()]; }
+  const std::vector<int>& cpus() const { return cpus_; }
+
+  /// Appends cpu unless present.
+  void add(int cpu);
+
+  /// Same format as parse(), in list order.
+  string toString() const;
+
+ private:
+  std::vector<int> cpus_;
+};
+
+///
+/// Where threads of a pool run, and where they get memory from.
+///
+/// Applied in the thread before anything else, so objects it creates,
+/// like the EventLoop of an IO thread, are allocated near its CPU.
+///
+class ThreadAffinity : public muduo::copyable
+{
+ public:
+  enum Mode
+  {
+    kNone,     // up to the scheduler
+    kEachOne,  // i-th thread on cpus[i], wraps around
+    kShared,   // every thread on any of cpus
+  };
+
+  /// Not pinned.
+  ThreadAffinity()
+    : mode_(kNone), numaLocal_(false)
+  { }
+
+  /// With numaLocal, memory is preferably allocated from the NUMA node of
+  /// the thread's (first) CPU.
+  ThreadAffinity(Mode mode, const CpuSet& cpus, bool numaLocal = true)
+    : mode_(cpus.empty() ? kNone : mode), cpus_(cpus), numaLocal_(numaLocal)
+  { }
+
+  Mode mode() const { return mode_; }
+  const CpuSet& cpus() const { return cpus_; }
+
+  /// CPUs of index-th thread of a pool, empty if not pinned.
+  CpuSet cpusOf(size_t index) const;
+
+  /// Applies to the calling thread, the index-th of its pool.
+  /// Returns false on failure, the thread runs unpinned then.
+  bool apply(size_t index) const;
+
+ private:
+  Mode mode_;
+  CpuSet cpus_;
+  bool numaLocal_;
+};
+
+namespace affinity
+{
+
+/// Pins the calling thread to cpus.
+bool pinCurrentThread(const CpuSet& cpus);
+
+/// NUMA node of cpu, 0 if unknown or not NUMA.
+int nodeOfCpu(int cpu);
+
+/// Makes the calling thread allocate from node first, falling back to
+/// other nodes when it is full.  Pages are placed on first touch.
+bool preferNode(int node);
+
+}  // namespace affinity
+
+}  // namespace muduo
+
+#endif  // MUDUO_BASE_AFFINITY_H
@@ -4,13 +4,133 @@
 // Author: Shuo Chen (chenshuo at chenshuo dot com)
 
 #include <muduo/base/AsyncLogging.h>
+#include <muduo/base/BinaryLog.h>
+#include <muduo/base/LockFreeQueue.h>
 #include <muduo/base/LogFile.h>
 #include <muduo/base/Timestamp.h>
 
+#include <queue>
+
+#include <assert.h>
+#include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 
 using namespace muduo;
 
+namespace
+{
+
+// in front of each line in a chunk
+struct FrameHeader
+{
+  enum Kind
+  {
+    kText,
+    kRecord,   // of LOG_FMT
+  };
+
+  int64_t microSecondsSinceEpoch;
+  int len;
+  int kind;
+};
+
+const int kHeaderSize = static_cast<int>(sizeof(FrameHeader));
+
+// lines [begin, end) of one thread
+struct Range
+{
+  const char* begin;
+  const char* end;
+};
+
+struct Cursor
+{
+  int64_t time;
+  size_t thread;
+  size_t range;
+  const char* pos;
+
+  bool operator<(const Cursor& rhs) const
+  {
+    // later on top is lower priority, threads break ties
+    return time > rhs.time || (time == rhs.time && thread > rhs.thread);
+  }
+};
+
+FrameHeader headerAt(const char* pos)
+{
+  FrameHeader header;
+  memcpy(&header, pos, sizeof header);
+  return header;
+}
+
+}  // namespace
+
+struct AsyncLogging::Chunk : noncopyable
+{
+  // not zeroed, pages are touched only as it fills up
+  explicit Chunk(int size)
+    : data(new char[size]), capacity(size), length(0), committed(0), flushed(0)
+  { }
+
+  int avail() const { return capacity - length; }
+
+  void append(const void* buf, int len)
+  {
+    memcpy(data.get() + length, buf, len);
+    length += len;
+  }
+
+  // written by its thread only
+  std::unique_ptr<char[]> data;
+  const int capacity;
+  int length;
+  // length of whole lines, published to the backend
+  std::atomic<int> committed;
+  // written out so far, backend only
+  int flushed;
+};
+
+struct AsyncLogging::ThreadBuffer : noncopyable
+{
+  explicit ThreadBuffer(int maxChunks)
+    : full(maxChunks),
+      free(maxChunks),
+      current(NULL),
+      chunks(0),
+      exited(false)
+  { }
+
+  ~ThreadBuffer()
+  {
+    delete current.load();
+    Chunk* chunk = NULL;
+    while (full.tryTake(&chunk))
+    {
+      delete chunk;
+    }
+    while (free.tryTake(&chunk))
+    {
+      delete chunk;
+    }
+  }
+
+  SpscRing<Chunk*> full;         // to the backend
+  SpscRing<Chunk*> free;         // back from the backend
+  std::atomic<Chunk*> current;   // appended by its thread, NULL if none
+  int chunks;                    // allocated, thread only
+  std::atomic<bool> exited;
+};
+
+AsyncLogging::ThreadHandle::~ThreadHandle()
+{
+  if (buffer)
+  {
+    buffer->exited = true;
+  }
+}
+
 AsyncLogging::AsyncLogging(const string& basename,
                            off_t rollSize,
                            int flushInterval)
@@ -18,50 +138,110 @@ AsyncLogging::AsyncLogging(const string& basename,
     running_(false),
     basename_(basename),
     rollSize_(rollSize),
+    preallocate_(0),
+    bytesPerSync_(0),
+    chunkSize_(kDefaultChunkSize),
+    maxChunks_(kDefaultMaxChunks),
     thread_(std::bind(&AsyncLogging::threadFunc, this), "Logging"),
     latch_(1),
+    fullChunks_(0),
+    dropped_(0),
+    droppedTotal_(0),
     mutex_(),
     cond_(mutex_),
-    currentBuffer_(new Buffer),
-    nextBuffer_(new Buffer),
-    buffers_()
+    binaryFile_(false),
+    sitesRolls_(0)
+{
+}
+
+AsyncLogging::~AsyncLogging()
 {
-  currentBuffer_->bzero();
-  nextBuffer_->bzero();
-  buffers_.reserve(16);
+  if (running_)
+  {
+    stop();
+  }
 }
 
 //这个函数是把日志信息append到前端的内存里面   前端
 void AsyncLogging::append(const char* logline, int len)
 {
-  muduo::MutexLockGuard lock(mutex_);
-  if (currentBuffer_->avail() > len)
+  appendFrame(logline, len, FrameHeader::kText, Timestamp::now().microSecondsSinceEpoch());
+}
+
+void AsyncLogging::appendBinary(const char* record, int len)
+{
+  binlog::RecordHeader header;
+  assert(len >= static_cast<int>(sizeof header));
+  memcpy(&header, record, sizeof header);
+  appendFrame(record, len, FrameHeader::kRecord, header.microSecondsSinceEpoch);
+}
+
+void AsyncLogging::appendFrame(const char* data, int len, int kind, int64_t microSecondsSinceEpoch)
+{
+  ThreadBuffer* tb = local_.value().buffer.get();
+  if (tb == NULL)
   {
-    //当前的缓冲区可写字节数是否大于len
-    currentBuffer_->append(logline, len);
+    tb = registerThread();
   }
-  else
+
+  Chunk* chunk = tb->current.load(std::memory_order_relaxed);
+  if (chunk == NULL || chunk->avail() <= kHeaderSize + len)
   {
-    //当前缓冲区不够写，将当前缓冲区添加到待写入文件的已填满的缓冲区
-    //这里使用移动语义之后，currentBuffer_不再有指向了
-    buffers_.push_back(std::move(currentBuffer_));
+    //当前缓冲区不够写，交给后端，换一块空闲的
+    chunk = nextChunk(tb, chunk);
+    if (chunk == NULL || chunk->avail() <= kHeaderSize + len)
+    {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      droppedTotal_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  }
+
+  FrameHeader header = { microSecondsSinceEpoch, len, kind };
+  chunk->append(&header, kHeaderSize);
+  chunk->append(data, len);
+  chunk->committed.store(chunk->length, std::memory_order_release);
+}
+
+AsyncLogging::ThreadBuffer* AsyncLogging::registerThread()
+{
+  std::shared_ptr<ThreadBuffer> tb(new ThreadBuffer(maxChunks_));
+  local_.value().buffer = tb;
+  MutexLockGuard lock(mutex_);
+  threads_.push_back(tb);
+  return tb.get();
+}
 
-    //将当前缓冲区设置为预备缓冲区
-    if (nextBuffer_)
+// hands full over, returns a free one, or NULL if the backend is behind
+AsyncLogging::Chunk* AsyncLogging::nextChunk(ThreadBuffer* tb, Chunk* full)
+{
+  if (full)
+  {
+    // queued before replaced, so the backend sees it in the queue
+    // if it has seen its replacement
+    bool queued = tb->full.tryPut(full);
+    assert(queued); (void) queued;
+    tb->current.store(NULL, std::memory_order_release);
+    //有一块比较大的缓冲区写满了，通知后端开始写入日志，而不是一有消息就通知写
+    if (fullChunks_.fetch_add(1) == 0)
     {
-      //使用移动语义，currentBuffer_指向了nextBuffer_所指向的缓冲区，nextBuffer_不在有指向了
-      currentBuffer_ = std::move(nextBuffer_);
+      MutexLockGuard lock(mutex_);
+      cond_.notify();
     }
-    else
+  }
+
+  Chunk* chunk = NULL;
+  if (!tb->free.tryTake(&chunk))
+  {
+    if (tb->chunks >= maxChunks_)
     {
-      //这种情况，极少发生，前端写入速度太快，一下子把两块缓冲区都写完了，
-      //那么，只好分配一块新的缓冲区
-      currentBuffer_.reset(new Buffer); // Rarely happens
+      return NULL;
     }
-    currentBuffer_->append(logline, len);
-    cond_.notify();    //有一块比较大的缓冲区写满了，这个兄弟就通知后端开始写入日志，
-                       //而不是一有消息就通知写，这样效率太底
+    chunk = new Chunk(chunkSize_);
+    ++tb->chunks;
   }
+  tb->current.store(chunk, std::memory_order_release);
+  return chunk;
 }
 
 //后端
@@ -70,92 +250,186 @@ void AsyncLogging::threadFunc()
   assert(running_ == true);
   latch_.countDown();
   LogFile output(basename_, rollSize_, false);
-  //准备了两块空闲缓冲区
-  BufferPtr newBuffer1(new Buffer);
-  BufferPtr newBuffer2(new Buffer);
-  newBuffer1->bzero();
-  newBuffer2->bzero();
-  BufferVector buffersToWrite;
-  buffersToWrite.reserve(16);
+  output.setPreallocate(preallocate_);
+  output.setBytesPerSync(bytesPerSync_);
+  output.setRollCallback(rollCallback_);
   while (running_)
   {
-    assert(newBuffer1 && newBuffer1->length() == 0);
-    assert(newBuffer2 && newBuffer2->length() == 0);
-    assert(buffersToWrite.empty());
-
-    //交换buffers_和buffersToWrite之后，离开缓冲区
     {
       muduo::MutexLockGuard lock(mutex_);
-      //即使是虚假的唤醒，我们也写日志文件，这个是可以的，所以用了非常规做法
-      if (buffers_.empty())  // unusual usage!  非常规的做法，不能解决虚假唤醒
+      if (fullChunks_.load() == 0)
       {
-        //等待前端写满了一个或者多个buffer，或者一个超时时间到来
+        //等待前端写满了一块或者多块buffer，或者一个超时时间到来
         cond_.waitForSeconds(flushInterval_);
       }
-      //将当前缓冲区移入buffers_，这个时候currentBuffer_已经没有指向了
-      buffers_.push_back(std::move(currentBuffer_));
-      //将空闲的newBuffer1置为当前缓冲区
-      currentBuffer_ = std::move(newBuffer1);
-      //buffer_与buffersToWrite交换，这样后面的代码在写日志的时候
-      //可以在临界区之外安全的访问buffersToWrite
-      buffersToWrite.swap(buffers_);
-      if (!nextBuffer_)
-      {
-        //确保前端始终有一个预备buffer可供调配，减少前端临界区分配内存的概率，缩短前端临界区长度
-        nextBuffer_ = std::move(newBuffer2);
-      }
     }
+    writeOnce(&output);
+    output.flush();
+  }
+  writeOnce(&output);
+  output.flush();
+}
 
-    assert(!buffersToWrite.empty());
+// Takes what all threads have appended, and writes it ordered by time.
+void AsyncLogging::writeOnce(LogFile* output)
+{
+  fullChunks_.store(0);
+  std::vector<std::shared_ptr<ThreadBuffer>> threads;
+  {
+    MutexLockGuard lock(mutex_);
+    threads = threads_;
+  }
 
-    //消息堆积
-    //前端陷入死循环，拼命发送日志消息，超过后端的处理能力，这就是典型的生产速度
-    //超过消费速度的问题，会造成数据在内存中堆积，严重时引发性能问题（可用内存不足）
-    //或程序崩溃(分配内存失败)
-    if (buffersToWrite.size() > 25)
+  std::vector<std::vector<Range>> ranges(threads.size());
+  std::vector<std::pair<ThreadBuffer*, Chunk*>> drained;
+  bool removeExited = false;
+  for (size_t i = 0; i < threads.size(); ++i)
+  {
+    ThreadBuffer* tb = threads[i].get();
+    bool exited = tb->exited.load();
+    // before the queue, see nextChunk()
+    Chunk* current = tb->current.load(std::memory_order_acquire);
+    Chunk* chunk = NULL;
+    while (tb->full.tryTake(&chunk))
     {
-      char buf[256];
-      snprintf(buf, sizeof buf, "Dropped log messages at %s, %zd larger buffers\n",
-               Timestamp::now().toFormattedString().c_str(),
-               buffersToWrite.size()-2);
-      fputs(buf, stderr);
-      output.append(buf, static_cast<int>(strlen(buf)));
-      //丢掉多余日志，以腾出内存，仅保留两块缓冲区
-      buffersToWrite.erase(buffersToWrite.begin()+2, buffersToWrite.end());
+      int committed = chunk->committed.load(std::memory_order_acquire);
+      Range range = { chunk->data.get() + chunk->flushed, chunk->data.get() + committed };
+      ranges[i].push_back(range);
+      chunk->flushed = committed;
+      drained.push_back(std::make_pair(tb, chunk));
     }
-
-    for (const auto& buffer : buffersToWrite)
+    if (current)
     {
-      // FIXME: use unbuffered stdio FILE ? or use ::writev ?
-      output.append(buffer->data(), buffer->length());
+      int committed = current->committed.load(std::memory_order_acquire);
+      Range range = { current->data.get() + current->flushed, current->data.get() + committed };
+      ranges[i].push_back(range);
+      current->flushed = committed;
     }
+    removeExited = removeExited || exited;
+  }
 
-    if (buffersToWrite.size() > 2)
+  // merges lines of all threads by time
+  std::priority_queue<Cursor> heap;
+  for (size_t i = 0; i < ranges.size(); ++i)
+  {
+    for (size_t r = 0; r < ranges[i].size(); ++r)
     {
-      // drop non-bzero-ed buffers, avoid trashing
-      //仅保存两个buffer,用于newBuffer1与newBuffer2
-      buffersToWrite.resize(2);
+      if (ranges[i][r].begin < ranges[i][r].end)
+      {
+        Cursor cursor = { headerAt(ranges[i][r].begin).microSecondsSinceEpoch, i, r, ranges[i][r].begin };
+        heap.push(cursor);
+        break;
+      }
     }
+  }
+  while (!heap.empty())
+  {
+    Cursor cursor = heap.top();
+    heap.pop();
+    FrameHeader header = headerAt(cursor.pos);
+    writeFrame(output, header.kind, cursor.pos + kHeaderSize, header.len);
+    cursor.pos += kHeaderSize + header.len;
+    const std::vector<Range>& rs = ranges[cursor.thread];
+    while (cursor.pos >= rs[cursor.range].end && ++cursor.range < rs.size())
+    {
+      cursor.pos = rs[cursor.range].begin;
+    }
+    if (cursor.range < rs.size())
+    {
+      cursor.time = headerAt(cursor.pos).microSecondsSinceEpoch;
+      heap.push(cursor);
+    }
+  }
 
-    if (!newBuffer1)
+  int64_t dropped = dropped_.exchange(0);
+  if (dropped > 0)
+  {
+    char buf[256];
+    snprintf(buf, sizeof buf, "Dropped %" PRId64 " log messages at %s\n",
+             dropped, Timestamp::now().toFormattedString().c_str());
+    fputs(buf, stderr);
+    writeFrame(output, FrameHeader::kText, buf, static_cast<int>(strlen(buf)));
+  }
+
+  // written, back to their threads
+  for (const auto& item : drained)
+  {
+    Chunk* chunk = item.second;
+    chunk->length = 0;
+    chunk->committed.store(0, std::memory_order_relaxed);
+    chunk->flushed = 0;
+    bool queued = item.first->free.tryPut(chunk);
+    assert(queued); (void) queued;
+  }
+
+  if (removeExited)
+  {
+    // exited and all written, nothing more is coming
+    MutexLockGuard lock(mutex_);
+    for (size_t i = 0; i < threads_.size(); )
     {
-      assert(!buffersToWrite.empty());
-      newBuffer1 = std::move(buffersToWrite.back());
-      buffersToWrite.pop_back();
-      newBuffer1->reset();
+      ThreadBuffer* tb = threads_[i].get();
+      Chunk* current = tb->current.load(std::memory_order_acquire);
+      if (tb->exited.load() && tb->full.empty()
+          && (current == NULL || current->flushed == current->committed.load()))
+      {
+        threads_[i] = std::move(threads_.back());
+        threads_.pop_back();
+      }
+      else
+      {
+        ++i;
+      }
     }
+  }
+}
 
-    if (!newBuffer2)
+void AsyncLogging::writeFrame(LogFile* output, int kind, const char* data, int len)
+{
+  if (!binaryFile_)
+  {
+    if (kind == FrameHeader::kText)
+    {
+      output->append(data, len);
+    }
+    else
     {
-      assert(!buffersToWrite.empty());
-      newBuffer2 = std::move(buffersToWrite.back());
-      buffersToWrite.pop_back();
-      newBuffer2->reset();
+      LogStream stream;
+      binlog::format(data, len, &stream);
+      output->append(stream.buffer().data(), stream.buffer().length());
     }
+    return;
+  }
 
-    buffersToWrite.clear();
-    output.flush();
+  // one append per entry, so it does not straddle a roll
+  entry_.clear();
+  binlog::EntryHeader header;
+  header.len = static_cast<uint32_t>(len);
+  if (kind == FrameHeader::kText)
+  {
+    header.kind = binlog::EntryHeader::kText;
   }
-  output.flush();
+  else
+  {
+    header.kind = binlog::EntryHeader::kRecord;
+    if (output->rolls() != sitesRolls_)
+    {
+      sitesRolls_ = output->rolls();
+      sitesDefined_.clear();
+    }
+    binlog::RecordHeader record;
+    memcpy(&record, data, sizeof record);
+    if (record.site >= sitesDefined_.size())
+    {
+      sitesDefined_.resize(record.site + 1);
+    }
+    if (!sitesDefined_[record.site])
+    {
+      sitesDefined_[record.site] = true;
+      binlog::encodeSite(*binlog::site(record.site), &entry_);
+    }
+  }
+  entry_.append(reinterpret_cast<const char*>(&header), sizeof header);
+  entry_.append(data, len);
+  output->append(entry_.data(), static_cast<int>(entry_.size()));
 }
-
@@ -6,36 +6,70 @@
 #ifndef MUDUO_BASE_ASYNCLOGGING_H
 #define MUDUO_BASE_ASYNCLOGGING_H
 
-#include <muduo/base/BlockingQueue.h>
-#include <muduo/base/BoundedBlockingQueue.h>
 #include <muduo/base/CountDownLatch.h>
 #include <muduo/base/Mutex.h>
 #include <muduo/base/Thread.h>
+#include <muduo/base/ThreadLocal.h>
 #include <muduo/base/LogStream.h>
 
 #include <atomic>
+#include <functional>
+#include <memory>
 #include <vector>
 
 namespace muduo
 {
 
+class LogFile;
+
+///
+/// Asynchronous logging to a LogFile.
+///
+/// Each logging thread appends to its own buffer, with no lock: full
+/// buffers are handed to the backend thread through a lock-free queue,
+/// and come back the same way once written.  The backend also writes
+/// what's in the current buffers, every flushInterval seconds.
+/// Lines written together are merged by the time they were appended.
+///
+/// Each thread that logs holds up to maxChunksPerThread chunks of
+/// chunkSize bytes, 4 x 256KiB = 1MiB by default, allocated as needed
+/// and kept till the thread exits.  Pages are touched as a chunk fills,
+/// but stay resident after that.  Lines that find all chunks of their
+/// thread full, as the backend falls behind, are dropped.
+///
+/// Records of LOG_FMT given to appendBinary() are formatted by the
+/// backend thread, or written as they are with setBinaryFile(true), to
+/// be decoded offline by binlog_decode.
+///
 class AsyncLogging : noncopyable
 {
  public:
+  static const int kDefaultChunkSize = 256 * 1024;
+  static const int kDefaultMaxChunks = 4;
 
   AsyncLogging(const string& basename,
                off_t rollSize,
                int flushInterval = 3);
 
-  ~AsyncLogging()
-  {
-    if (running_)
-    {
-      stop();
-    }
-  }
+  ~AsyncLogging();
+
   //供前端生产者线程调用（日志数据写到缓冲区）
   void append(const char* logline, int len);
+  /// A record of LOG_FMT, see Logger::setBinaryOutput().
+  void appendBinary(const char* record, int len);
+
+  /// Writes binlog entries instead of text, call before start().
+  void setBinaryFile(bool on) { binaryFile_ = on; }
+
+  /// See LogFile, call before start().
+  void setPreallocate(off_t bytes) { preallocate_ = bytes; }
+  void setBytesPerSync(off_t bytes) { bytesPerSync_ = bytes; }
+  void setRollCallback(const std::function<void (const string&)>& cb) { rollCallback_ = cb; }
+
+  /// Memory of each logging thread, see above, call before start().
+  /// A line longer than chunkSize is dropped.
+  void setChunkSize(int bytes) { chunkSize_ = bytes; }
+  void setMaxChunksPerThread(int n) { maxChunks_ = n; }
 
   void start()
   {
@@ -51,30 +85,49 @@ class AsyncLogging : noncopyable
     thread_.join();
   }
 
+  /// Lines dropped so far, because the backend couldn't keep up.
+  int64_t dropped() const { return droppedTotal_.load(std::memory_order_relaxed); }
+
  private:
+  struct Chunk;
+  struct ThreadBuffer;
+  struct ThreadHandle
+  {
+    ~ThreadHandle();
+    std::shared_ptr<ThreadBuffer> buffer;
+  };
 
   //供后端消费者线程调用(将数据写到日志文件)
   void threadFunc();
-
-  typedef muduo::detail::FixedBuffer<muduo::detail::kLargeBuffer> Buffer;
-  typedef std::vector<std::unique_ptr<Buffer>> BufferVector;
-  //可以理解为Buffer的智能指针，能够管理Buffer的生存期
-  //类似于C++11中的unique_ptr, 具备移动语义
-  //两个unique_ptr不能指向同一个对象，不能进行复制操作，
-  //BufferVector的值类型就是unique_ptr<Buffer>
-  typedef BufferVector::value_type BufferPtr;
+  ThreadBuffer* registerThread();
+  Chunk* nextChunk(ThreadBuffer* tb, Chunk* full);
+  void appendFrame(const char* data, int len, int kind, int64_t microSecondsSinceEpoch);
+  void writeOnce(LogFile* output);
+  void writeFrame(LogFile* output, int kind, const char* data, int len);
 
   const int flushInterval_;  //超时时间，在flushInterval_秒内，缓冲区没写满，仍然将缓冲区中的数据写到文件
   std::atomic<bool> running_;
-  const string basename_;       
+  const string basename_;
   const off_t rollSize_;
+  off_t preallocate_;
+  off_t bytesPerSync_;
+  int chunkSize_;
+  int maxChunks_;
+  std::function<void (const string&)> rollCallback_;
   muduo::Thread thread_;
   muduo::CountDownLatch latch_;    //用于等待线程启动
+  muduo::ThreadLocal<ThreadHandle> local_;
+  std::atomic<int> fullChunks_;    // handed over since last write
+  std::atomic<int64_t> dropped_;   // since last write
+  std::atomic<int64_t> droppedTotal_;
   muduo::MutexLock mutex_;
   muduo::Condition cond_ GUARDED_BY(mutex_);
-  BufferPtr currentBuffer_ GUARDED_BY(mutex_);    //当前缓冲区
-  BufferPtr nextBuffer_ GUARDED_BY(mutex_);       //预备缓冲区
-  BufferVector buffers_ GUARDED_BY(mutex_);       //待写入文件的已填满的缓冲区
+  std::vector<std::shared_ptr<ThreadBuffer>> threads_ GUARDED_BY(mutex_);
+  bool binaryFile_;
+  // backend only, sites defined in the current file
+  std::vector<bool> sitesDefined_;
+  int sitesRolls_;
+  string entry_;
 };
 
 }  // namespace muduo
@@ -0,0 +1,381 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+
+#include <muduo/base/BinaryLog.h>
+
+#include <muduo/base/CurrentThread.h>
+#include <muduo/base/Mutex.h>
+#include <muduo/base/TimeZone.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace muduo
+{
+
+// in Logging.cc
+extern Logger::OutputFunc g_output;
+extern Logger::FlushFunc g_flush;
+extern Logger::BinaryOutputFunc g_binaryOutput;
+extern TimeZone g_logTimeZone;
+extern const char* LogLevelName[Logger::NUM_LOG_LEVELS];
+
+namespace binlog
+{
+
+const uint32_t kMaxSites = 16 * 1024;
+
+// filled in once, read with no lock
+std::atomic<const Site*> g_sites[kMaxSites];
+uint32_t g_numSites = 0;
+MutexLock g_sitesMutex;
+
+__thread char t_time[64];
+__thread time_t t_lastSecond;
+
+// a long string leaves room for the arguments after it
+const size_t kReservedForArgs = 256;
+
+// entries larger than this are garbage
+const uint32_t kMaxEntrySize = 1024 * 1024;
+
+void formatTime(int64_t microSecondsSinceEpoch, LogStream* out)
+{
+  time_t seconds = static_cast<time_t>(microSecondsSinceEpoch / Timestamp::kMicroSecondsPerSecond);
+  int microseconds = static_cast<int>(microSecondsSinceEpoch % Timestamp::kMicroSecondsPerSecond);
+  if (seconds != t_lastSecond)
+  {
+    t_lastSecond = seconds;
+    struct tm tm_time;
+    if (g_logTimeZone.valid())
+    {
+      tm_time = g_logTimeZone.toLocalTime(seconds);
+    }
+    else
+    {
+      ::gmtime_r(&seconds, &tm_time);
+    }
+
+    int len = snprintf(t_time, sizeof(t_time), "%4d%02d%02d %02d:%02d:%02d",
+        tm_time.tm_year + 1900, tm_time.tm_mon + 1, tm_time.tm_mday,
+        tm_time.tm_hour, tm_time.tm_min, tm_time.tm_sec);
+    assert(len == 17); (void)len;
+  }
+
+  out->append(t_time, 17);
+  Fmt us(g_logTimeZone.valid() ? ".%06d " : ".%06dZ ", microseconds);
+  out->append(us.data(), us.length());
+}
+
+template<typename T>
+bool take(const char** cur, const char* end, T* v)
+{
+  if (static_cast<size_t>(end - *cur) < sizeof(T))
+  {
+    return false;
+  }
+  memcpy(v, *cur, sizeof(T));
+  *cur += sizeof(T);
+  return true;
+}
+
+// formats one argument of type
+bool formatArg(char type, const char** cur, const char* end, LogStream* out)
+{
+  switch (type)
+  {
+    case 'i':
+    {
+      int64_t v = 0;
+      if (!take(cur, end, &v)) return false;
+      *out << v;
+      return true;
+    }
+    case 'u':
+    {
+      uint64_t v = 0;
+      if (!take(cur, end, &v)) return false;
+      *out << v;
+      return true;
+    }
+    case 'd':
+    {
+      double v = 0;
+      if (!take(cur, end, &v)) return false;
+      *out << v;
+      return true;
+    }
+    case 'c':
+    {
+      char v = 0;
+      if (!take(cur, end, &v)) return false;
+      *out << v;
+      return true;
+    }
+    case 'p':
+    {
+      uint64_t v = 0;
+      if (!take(cur, end, &v)) return false;
+      *out << reinterpret_cast<const void*>(static_cast<uintptr_t>(v));
+      return true;
+    }
+    case 's':
+    {
+      uint32_t len = 0;
+      if (!take(cur, end, &len) || static_cast<size_t>(end - *cur) < len) return false;
+      // truncated like a long line of LogStream, but not lost
+      int avail = out->buffer().avail() - 64;
+      out->append(*cur, std::min(static_cast<int>(len), std::max(avail, 0)));
+      *cur += len;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+}  // namespace binlog
+}  // namespace muduo
+
+using namespace muduo;
+using namespace muduo::binlog;
+
+uint32_t binlog::registerSite(Logger::LogLevel level, const char* file, int line,
+                              const char* func, const char* format, const char* types)
+{
+  MutexLockGuard lock(g_sitesMutex);
+  if (g_numSites >= kMaxSites)
+  {
+    fprintf(stderr, "Too many LOG_FMT sites, %s:%d\n", file, line);
+    abort();
+  }
+  // lives as long as the program
+  Site* s = new Site;
+  s->id = g_numSites;
+  s->level = level;
+  s->line = line;
+  s->file = Logger::SourceFile(file).data_;
+  s->func = func;
+  s->format = format;
+  s->types = types;
+  g_sites[g_numSites].store(s, std::memory_order_release);
+  return g_numSites++;
+}
+
+const Site* binlog::site(uint32_t id)
+{
+  return id < kMaxSites ? g_sites[id].load(std::memory_order_acquire) : NULL;
+}
+
+bool binlog::format(const Site& s, const char* record, int len, LogStream* out)
+{
+  RecordHeader header;
+  if (len < static_cast<int>(sizeof header))
+  {
+    return false;
+  }
+  memcpy(&header, record, sizeof header);
+  const char* cur = record + sizeof header;
+  const char* end = record + len;
+
+  formatTime(header.microSecondsSinceEpoch, out);
+  char tid[32];
+  int tidLen = snprintf(tid, sizeof tid, "%5d ", header.tid);
+  out->append(tid, tidLen);
+  out->append(LogLevelName[s.level], 6);
+  // as LOG_TRACE and LOG_DEBUG
+  if (s.level <= Logger::DEBUG)
+  {
+    *out << s.func << ' ';
+  }
+
+  bool ok = true;
+  const char* types = s.types;
+  const char* fmt = s.format;
+  while (const char* brace = strstr(fmt, "{}"))
+  {
+    out->append(fmt, static_cast<int>(brace - fmt));
+    if (*types != '\0' && ok)
+    {
+      ok = formatArg(*types++, &cur, end, out);
+    }
+    else
+    {
+      out->append("{}", 2);
+    }
+    fmt = brace + 2;
+  }
+  *out << fmt << " - " << s.file << ':' << s.line << '\n';
+  return ok && cur == end;
+}
+
+bool binlog::format(const char* record, int len, LogStream* out)
+{
+  RecordHeader header;
+  if (len < static_cast<int>(sizeof header))
+  {
+    return false;
+  }
+  memcpy(&header, record, sizeof header);
+  const Site* s = site(header.site);
+  return s != NULL && format(*s, record, len, out);
+}
+
+void binlog::encodeSite(const Site& s, string* out)
+{
+  int32_t fields[3] = { static_cast<int32_t>(s.id), s.level, s.line };
+  EntryHeader header;
+  header.kind = EntryHeader::kSite;
+  header.len = static_cast<uint32_t>(sizeof fields + strlen(s.file) + strlen(s.func)
+                                     + strlen(s.format) + strlen(s.types) + 4);
+  out->append(reinterpret_cast<const char*>(&header), sizeof header);
+  out->append(reinterpret_cast<const char*>(fields), sizeof fields);
+  const char* strs[] = { s.file, s.func, s.format, s.types };
+  for (const char* str : strs)
+  {
+    out->append(str, strlen(str) + 1);
+  }
+}
+
+Encoder::Encoder(uint32_t s)
+  : cur_(buf_),
+    truncated_(false)
+{
+  RecordHeader header = { s, CurrentThread::tid(), Timestamp::now().microSecondsSinceEpoch() };
+  put(&header, sizeof header);
+}
+
+void Encoder::putString(const char* str, size_t len)
+{
+  size_t avail = static_cast<size_t>(buf_ + sizeof buf_ - cur_);
+  size_t room = avail > sizeof(uint32_t) + kReservedForArgs
+              ? avail - sizeof(uint32_t) - kReservedForArgs : 0;
+  uint32_t n = static_cast<uint32_t>(std::min(len, room));
+  put(&n, sizeof n);
+  put(str, n);
+}
+
+void Encoder::finish()
+{
+  RecordHeader header;
+  memcpy(&header, buf_, sizeof header);
+  const Site* s = site(header.site);
+  assert(s != NULL);
+  if (truncated_)
+  {
+    // too many arguments, the record would not decode
+    LogStream stream;
+    stream << "LOG_FMT record too large - " << s->file << ':' << s->line << '\n';
+    g_output(stream.buffer().data(), stream.buffer().length());
+  }
+  else if (g_binaryOutput)
+  {
+    g_binaryOutput(buf_, length());
+  }
+  else
+  {
+    LogStream stream;
+    binlog::format(*s, buf_, length(), &stream);
+    g_output(stream.buffer().data(), stream.buffer().length());
+  }
+  if (s->level == Logger::FATAL)
+  {
+    g_flush();
+    abort();
+  }
+}
+
+void Decoder::decode(const char* data, size_t len, string* out)
+{
+  pending_.append(data, len);
+  size_t pos = 0;
+  EntryHeader header;
+  while (pending_.size() - pos >= sizeof header)
+  {
+    memcpy(&header, pending_.data() + pos, sizeof header);
+    if (header.len > kMaxEntrySize
+        || header.kind < EntryHeader::kSite || header.kind > EntryHeader::kText)
+    {
+      // not ours, or corrupted, no way to find the next entry
+      ++errors_;
+      pending_.clear();
+      return;
+    }
+    if (pending_.size() - pos - sizeof header < header.len)
+    {
+      break;
+    }
+    decodeEntry(header, pending_.data() + pos + sizeof header, out);
+    pos += sizeof header + header.len;
+  }
+  pending_.erase(0, pos);
+}
+
+void Decoder::decodeEntry(const EntryHeader& header, const char* payload, string* out)
+{
+  const char* end = payload + header.len;
+  if (header.kind == EntryHeader::kSite)
+  {
+    int32_t fields[3];
+    const char* cur = payload;
+    if (!take(&cur, end, &fields))
+    {
+      ++errors_;
+      return;
+    }
+    string strs[4];
+    for (string& str : strs)
+    {
+      const char* nul = static_cast<const char*>(memchr(cur, '\0', end - cur));
+      if (nul == NULL || fields[1] < 0 || fields[1] >= Logger::NUM_LOG_LEVELS)
+      {
+        ++errors_;
+        return;
+      }
+      str.assign(cur, nul);
+      cur = nul + 1;
+    }
+    // a site is defined again in every file
+    SiteText& st = sites_[static_cast<uint32_t>(fields[0])];
+    st.file.swap(strs[0]);
+    st.func.swap(strs[1]);
+    st.format.swap(strs[2]);
+    st.types.swap(strs[3]);
+    st.site.id = static_cast<uint32_t>(fields[0]);
+    st.site.level = static_cast<Logger::LogLevel>(fields[1]);
+    st.site.line = fields[2];
+    st.site.file = st.file.c_str();
+    st.site.func = st.func.c_str();
+    st.site.format = st.format.c_str();
+    st.site.types = st.types.c_str();
+  }
+  else if (header.kind == EntryHeader::kRecord)
+  {
+    RecordHeader record;
+    const char* cur = payload;
+    std::map<uint32_t, SiteText>::const_iterator it;
+    if (!take(&cur, end, &record)
+        || (it = sites_.find(record.site)) == sites_.end())
+    {
+      ++errors_;
+      return;
+    }
+    LogStream stream;
+    if (!binlog::format(it->second.site, payload, static_cast<int>(header.len), &stream))
+    {
+      ++errors_;
+    }
+    out->append(stream.buffer().data(), stream.buffer().length());
+    ++records_;
+  }
+  else
+  {
+    out->append(payload, header.len);
+  }
+}
@@ -0,0 +1,279 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+
+#ifndef MUDUO_BASE_BINARYLOG_H
+#define MUDUO_BASE_BINARYLOG_H
+
+#include <muduo/base/Logging.h>
+#include <muduo/base/StringPiece.h>
+
+#include <map>
+#include <type_traits>
+
+#include <stdint.h>
+#include <string.h>
+
+namespace muduo
+{
+
+///
+/// Binary logging, formatting deferred.
+///
+/// LOG_FMT(INFO, "accepted {} from {}", fd, peer) records the id of its
+/// call site and the raw arguments only, the text is made later on, by
+/// AsyncLogging's backend thread, or offline by binlog_decode.
+/// Each {} in the format is replaced by the next argument, formatted as
+/// LogStream would.  Arguments are integers, enums, floating points,
+/// chars, pointers, C strings, strings and StringPieces.
+///
+/// Records go to Logger::setBinaryOutput(), they're formatted in place
+/// and go to Logger::setOutput() if it's not set.
+///
+#define LOG_FMT(level, fmt, ...) \
+  do \
+  { \
+    if (muduo::Logger::logLevel() <= muduo::Logger::level) \
+    { \
+      static const uint32_t muduo_binlog_site = muduo::binlog::registerSite( \
+          muduo::Logger::level, __FILE__, __LINE__, __func__, fmt, \
+          decltype(muduo::binlog::typeList(__VA_ARGS__))::types()); \
+      muduo::binlog::log(muduo_binlog_site, ##__VA_ARGS__); \
+    } \
+  } while (0)
+
+namespace binlog
+{
+
+/// A call site of LOG_FMT.
+struct Site
+{
+  uint32_t id;
+  Logger::LogLevel level;
+  int line;
+  const char* file;     // basename
+  const char* func;
+  const char* format;
+  const char* types;    // one char per argument, see ArgTraits
+};
+
+/// In front of the arguments of each record.
+struct RecordHeader
+{
+  uint32_t site;
+  int tid;
+  int64_t microSecondsSinceEpoch;
+};
+
+const int kMaxRecordSize = detail::kSmallBuffer;
+
+/// Returns the id of a new site, called once per LOG_FMT.
+uint32_t registerSite(Logger::LogLevel level, const char* file, int line,
+                      const char* func, const char* format, const char* types);
+
+/// Registered site of id, NULL if none.
+const Site* site(uint32_t id);
+
+/// Formats record like a line of Logger, returns false if it's malformed.
+bool format(const Site& site, const char* record, int len, LogStream* out);
+
+/// Formats a record of a registered site.
+bool format(const char* record, int len, LogStream* out);
+
+///
+/// Files written by AsyncLogging::setBinaryFile(true) are a sequence of
+/// entries, each an EntryHeader then its payload.  A site is defined in
+/// a file before its first record.
+///
+struct EntryHeader
+{
+  enum Kind
+  {
+    kSite = 1,     // id, level, line, then file, func, format, types with '\0'
+    kRecord = 2,   // RecordHeader then arguments
+    kText = 3,     // a line of Logger
+  };
+
+  uint32_t kind;
+  uint32_t len;
+};
+
+/// Encodes a kSite entry.
+void encodeSite(const Site& site, string* out);
+
+///
+/// Turns entries back into lines of text, fed in pieces of any size.
+///
+class Decoder : noncopyable
+{
+ public:
+  Decoder() : records_(0), errors_(0) { }
+
+  void decode(const char* data, size_t len, string* out);
+
+  int64_t records() const { return records_; }
+  /// Records of undefined sites, or otherwise malformed.
+  int64_t errors() const { return errors_; }
+
+ private:
+  struct SiteText
+  {
+    Site site;
+    string file;
+    string func;
+    string format;
+    string types;
+  };
+
+  void decodeEntry(const EntryHeader& header, const char* payload, string* out);
+
+  string pending_;
+  std::map<uint32_t, SiteText> sites_;
+  int64_t records_;
+  int64_t errors_;
+};
+
+class Encoder : noncopyable
+{
+ public:
+  explicit Encoder(uint32_t site);
+
+  void putInt(int64_t v) { put(&v, sizeof v); }
+  void putUInt(uint64_t v) { put(&v, sizeof v); }
+  void putDouble(double v) { put(&v, sizeof v); }
+  void putChar(char c) { put(&c, sizeof c); }
+  // truncated to fit
+  void putString(const char* str, size_t len);
+
+  const char* data() const { return buf_; }
+  int length() const { return static_cast<int>(cur_ - buf_); }
+
+  /// Hands the record to Logger's binary output.
+  void finish();
+
+ private:
+  void put(const void* data, size_t len)
+  {
+    if (static_cast<size_t>(buf_ + sizeof buf_ - cur_) >= len)
+    {
+      memcpy(cur_, data, len);
+      cur_ += len;
+    }
+    else
+    {
+      truncated_ = true;
+    }
+  }
+
+  char buf_[kMaxRecordSize];
+  char* cur_;
+  bool truncated_;
+};
+
+///
+/// How an argument is encoded, kType tags it in Site::types.
+///
+template<typename T, typename Enable = void>
+struct ArgTraits;
+
+template<typename T>
+struct ArgTraits<T, typename std::enable_if<std::is_integral<T>::value
+                                            && std::is_signed<T>::value>::type>
+{
+  static const char kType = 'i';
+  static void encode(Encoder* enc, T v) { enc->putInt(v); }
+};
+
+template<typename T>
+struct ArgTraits<T, typename std::enable_if<std::is_integral<T>::value
+                                            && !std::is_signed<T>::value>::type>
+{
+  static const char kType = 'u';
+  static void encode(Encoder* enc, T v) { enc->putUInt(v); }
+};
+
+template<typename T>
+struct ArgTraits<T, typename std::enable_if<std::is_enum<T>::value>::type>
+{
+  static const char kType = 'i';
+  static void encode(Encoder* enc, T v) { enc->putInt(static_cast<int64_t>(v)); }
+};
+
+template<typename T>
+struct ArgTraits<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+  static const char kType = 'd';
+  static void encode(Encoder* enc, T v) { enc->putDouble(v); }
+};
+
+template<typename T>
+struct ArgTraits<T*, void>
+{
+  static const char kType = 'p';
+  static void encode(Encoder* enc, const T* v) { enc->putUInt(reinterpret_cast<uintptr_t>(v)); }
+};
+
+template<>
+struct ArgTraits<char, void>
+{
+  static const char kType = 'c';
+  static void encode(Encoder* enc, char v) { enc->putChar(v); }
+};
+
+template<>
+struct ArgTraits<const char*, void>
+{
+  static const char kType = 's';
+  static void encode(Encoder* enc, const char* v) { enc->putString(v, strlen(v)); }
+};
+
+template<>
+struct ArgTraits<char*, void> : ArgTraits<const char*, void>
+{
+};
+
+template<>
+struct ArgTraits<string, void>
+{
+  static const char kType = 's';
+  static void encode(Encoder* enc, const string& v) { enc->putString(v.data(), v.size()); }
+};
+
+template<>
+struct ArgTraits<StringPiece, void>
+{
+  static const char kType = 's';
+  static void encode(Encoder* enc, StringPiece v)
+  {
+    enc->putString(v.data(), static_cast<size_t>(v.size()));
+  }
+};
+
+template<typename... Args>
+struct TypeList
+{
+  static const char* types()
+  {
+    static const char kTypes[] = { ArgTraits<typename std::decay<Args>::type>::kType..., '\0' };
+    return kTypes;
+  }
+};
+
+// unevaluated, for decltype in LOG_FMT
+template<typename... Args>
+TypeList<Args...> typeList(const Args&...);
+
+template<typename... Args>
+void log(uint32_t site, const Args&... args)
+{
+  Encoder enc(site);
+  int expand[] = { 0, (ArgTraits<typename std::decay<Args>::type>::encode(&enc, args), 0)... };
+  (void) expand;
+  enc.finish();
+}
+
+}  // namespace binlog
+}  // namespace muduo
+
+#endif  // MUDUO_BASE_BINARYLOG_H
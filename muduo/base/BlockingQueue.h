@@ -53,7 +53,7 @@ class BlockingQueue : noncopyable
     //构造对象，值初始化
     T front(std::move(queue_.front()));
     queue_.pop_front();
-    return std::move(front);
+    return front;
   }
 
   size_t size() const
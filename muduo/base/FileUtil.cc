@@ -17,20 +17,47 @@ using namespace muduo;
 
 FileUtil::AppendFile::AppendFile(StringArg filename)
   : fp_(::fopen(filename.c_str(), "ae")),  // 'e' for O_CLOEXEC
-    writtenBytes_(0)
+    writtenBytes_(0),
+    startOffset_(0),
+    bytesPerSync_(0),
+    syncedBytes_(0),
+    droppedBytes_(0),
+    preallocated_(false)
 {
   assert(fp_);
   //设定文件指针的缓冲区为buffer,如果没有设定，文件指针的缓冲区就是默认的，
   //文件缓冲区超过了64*1024也会自动flush到文件，不需要我们手动flush
   ::setbuffer(fp_, buffer_, sizeof buffer_);
-  // posix_fadvise POSIX_FADV_DONTNEED ?
+  struct stat statbuf;
+  if (::fstat(::fileno(fp_), &statbuf) == 0)
+  {
+    startOffset_ = statbuf.st_size;
+  }
 }
 
 FileUtil::AppendFile::~AppendFile()
 {
+  if (preallocated_)
+  {
+    // gives back the blocks past the end
+    ::fflush(fp_);
+    if (::ftruncate(::fileno(fp_), startOffset_ + writtenBytes_) < 0)
+    {
+      fprintf(stderr, "AppendFile::~AppendFile() ftruncate failed %s\n", strerror_tl(errno));
+    }
+  }
   ::fclose(fp_);
 }
 
+void FileUtil::AppendFile::preallocate(off_t bytes)
+{
+  // not all file systems can, it's only a hint anyway
+  if (::fallocate(::fileno(fp_), FALLOC_FL_KEEP_SIZE, startOffset_ + writtenBytes_, bytes) == 0)
+  {
+    preallocated_ = true;
+  }
+}
+
 void FileUtil::AppendFile::append(const char* logline, const size_t len)
 {
   size_t n = write(logline, len);
@@ -53,6 +80,10 @@ void FileUtil::AppendFile::append(const char* logline, const size_t len)
   }
 
   writtenBytes_ += len;
+  if (bytesPerSync_ > 0 && writtenBytes_ - syncedBytes_ >= bytesPerSync_)
+  {
+    sync();
+  }
 }
 
 void FileUtil::AppendFile::flush()
@@ -60,6 +91,25 @@ void FileUtil::AppendFile::flush()
   ::fflush(fp_);
 }
 
+void FileUtil::AppendFile::sync()
+{
+  ::fflush(fp_);
+  int fd = ::fileno(fp_);
+  // neither waits for the disk: the first one only queues the pages
+  // for writeback, the second one drops the previous range, which is
+  // most likely written back by now, a log is seldom read again.
+  ::sync_file_range(fd, startOffset_ + syncedBytes_, writtenBytes_ - syncedBytes_,
+                    SYNC_FILE_RANGE_WRITE);
+  // a length of 0 would be to the end
+  if (syncedBytes_ > droppedBytes_)
+  {
+    ::posix_fadvise(fd, startOffset_ + droppedBytes_, syncedBytes_ - droppedBytes_,
+                    POSIX_FADV_DONTNEED);
+    droppedBytes_ = syncedBytes_;
+  }
+  syncedBytes_ = writtenBytes_;
+}
+
 size_t FileUtil::AppendFile::write(const char* logline, size_t len)
 {
   // #undef fwrite_unlocked
@@ -73,13 +73,29 @@ class AppendFile : noncopyable
 
   off_t writtenBytes() const { return writtenBytes_; }
 
+  /// Allocates disk space for bytes more, without changing the file size,
+  /// so a file written bit by bit is less fragmented.
+  /// What's left over is released when closed.
+  void preallocate(off_t bytes);
+
+  /// Starts writeback every bytes written, and drops what's been written
+  /// back from page cache, so dirty pages don't pile up until the kernel
+  /// throttles the writer.  0 for never.
+  void setBytesPerSync(off_t bytes) { bytesPerSync_ = bytes; }
+
  private:
 
   size_t write(const char* logline, size_t len);
+  void sync();
 
   FILE* fp_;
   char buffer_[64*1024];
   off_t writtenBytes_;
+  off_t startOffset_;     // file size when opened
+  off_t bytesPerSync_;
+  off_t syncedBytes_;     // writeback started
+  off_t droppedBytes_;    // dropped from page cache
+  bool preallocated_;
 };
 
 }  // namespace FileUtil
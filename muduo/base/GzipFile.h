@@ -57,6 +57,14 @@ class GzipFile : noncopyable
 
   // int flush(int f) { return ::gzflush(file_, f); }
 
+  // flushes the rest and closes, return false if that failed, eg. ENOSPC
+  bool close()
+  {
+    gzFile file = file_;
+    file_ = NULL;
+    return file != NULL && ::gzclose(file) == Z_OK;
+  }
+
   static GzipFile openForRead(StringArg filename)
   {
     return GzipFile(::gzopen(filename.c_str(), "rbe"));
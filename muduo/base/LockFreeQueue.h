@@ -0,0 +1,328 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+
+#ifndef MUDUO_BASE_LOCKFREEQUEUE_H
+#define MUDUO_BASE_LOCKFREEQUEUE_H
+
+#include <muduo/base/noncopyable.h>
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <sched.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+namespace muduo
+{
+
+namespace detail
+{
+
+inline void futexWait(std::atomic<int>* addr, int expected)
+{
+  ::syscall(SYS_futex, reinterpret_cast<int*>(addr), FUTEX_WAIT_PRIVATE,
+            expected, NULL, NULL, 0);
+}
+
+inline void futexWake(std::atomic<int>* addr, int n)
+{
+  ::syscall(SYS_futex, reinterpret_cast<int*>(addr), FUTEX_WAKE_PRIVATE,
+            n, NULL, NULL, 0);
+}
+
+}  // namespace detail
+
+///
+/// Bounded lock-free ring, a drop-in for BoundedBlockingQueue.
+///
+/// Each slot has a sequence number telling whether it's ready to be
+/// written or read, by Dmitry Vyukov, so a put() or take() costs one CAS
+/// on the shared index, and none at all on a side declared single, e.g.
+/// SpscQueue is a plain ring of loads and stores.
+/// put() and take() spin for a while, then sleep on a futex.  Waking a
+/// sleeper costs a fence for every operation, both blocking or not,
+/// unless kBlocking is false, then only tryPut() and tryTake() are there
+/// and they wake nobody.
+///
+/// Capacity is rounded up to a power of 2.
+///
+template<typename T, bool kSingleProducer = false, bool kSingleConsumer = false,
+         bool kBlocking = true>
+class LockFreeQueue : noncopyable
+{
+ public:
+  explicit LockFreeQueue(size_t capacity)
+    : capacity_(roundUp(capacity)),
+      mask_(capacity_ - 1),
+      cells_(new Cell[capacity_]),
+      tail_(0),
+      head_(0)
+  {
+    for (size_t i = 0; i < capacity_; ++i)
+    {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ~LockFreeQueue()
+  {
+    T x;
+    while (tryTake(&x))
+    {
+    }
+  }
+
+  /// false if full.
+  bool tryPut(const T& x)
+  {
+    T copy(x);
+    return tryPut(std::move(copy));
+  }
+
+  /// false if full, x is left intact then.
+  bool tryPut(T&& x)
+  {
+    if (!push(&x))
+    {
+      return false;
+    }
+    wake(&notEmpty_);
+    return true;
+  }
+
+  /// false if empty.
+  bool tryTake(T* x)
+  {
+    if (!pop(x))
+    {
+      return false;
+    }
+    wake(&notFull_);
+    return true;
+  }
+
+  void put(const T& x)
+  {
+    T copy(x);
+    put(std::move(copy));
+  }
+
+  void put(T&& x)
+  {
+    static_assert(kBlocking, "put() of a queue that never blocks");
+    for (int spins = 0; !tryPut(std::move(x)); ++spins)
+    {
+      if (spins >= kSpins)
+      {
+        wait(&notFull_, [&] { return push(&x); });
+        wake(&notEmpty_);
+        return;
+      }
+      ::sched_yield();
+    }
+  }
+
+  T take()
+  {
+    static_assert(kBlocking, "take() of a queue that never blocks");
+    T x;
+    for (int spins = 0; !tryTake(&x); ++spins)
+    {
+      if (spins >= kSpins)
+      {
+        wait(&notEmpty_, [&] { return pop(&x); });
+        wake(&notFull_);
+        break;
+      }
+      ::sched_yield();
+    }
+    return x;
+  }
+
+  /// Approximate while others put or take.
+  size_t size() const
+  {
+    size_t tail = tail_.load(std::memory_order_acquire);
+    size_t head = head_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  bool empty() const { return size() == 0; }
+  bool full() const { return size() >= capacity_; }
+  size_t capacity() const { return capacity_; }
+
+ private:
+  static const int kSpins = 64;
+
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+    T* value() { return reinterpret_cast<T*>(&storage); }
+  };
+
+  // a futex word bumped on every wakeup, and sleepers on it
+  struct Waiters
+  {
+    Waiters() : seq(0), count(0) { }
+    std::atomic<int> seq;
+    std::atomic<int> count;
+    char pad[64 - 2 * sizeof(std::atomic<int>)];
+  };
+
+  static size_t roundUp(size_t n)
+  {
+    size_t capacity = 2;
+    while (capacity < n)
+    {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  bool push(T* x)
+  {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    Cell* cell = NULL;
+    for (;;)
+    {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0)
+      {
+        if (kSingleProducer)
+        {
+          tail_.store(pos + 1, std::memory_order_relaxed);
+          break;
+        }
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+      else if (diff < 0)
+      {
+        return false;
+      }
+      else
+      {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    new (cell->value()) T(std::move(*x));
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T* x)
+  {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    Cell* cell = NULL;
+    for (;;)
+    {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0)
+      {
+        if (kSingleConsumer)
+        {
+          head_.store(pos + 1, std::memory_order_relaxed);
+          break;
+        }
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+      else if (diff < 0)
+      {
+        return false;
+      }
+      else
+      {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+    T* value = cell->value();
+    *x = std::move(*value);
+    value->~T();
+    cell->sequence.store(pos + capacity_, std::memory_order_release);
+    return true;
+  }
+
+  // either ready() sees what the waker did, or the waker sees count > 0
+  template<typename Ready>
+  void wait(Waiters* w, Ready ready)
+  {
+    for (;;)
+    {
+      int seq = w->seq.load(std::memory_order_acquire);
+      w->count.fetch_add(1);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (ready())
+      {
+        w->count.fetch_sub(1);
+        return;
+      }
+      detail::futexWait(&w->seq, seq);
+      w->count.fetch_sub(1);
+    }
+  }
+
+  void wake(Waiters* w)
+  {
+    if (!kBlocking)
+    {
+      return;
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (w->count.load(std::memory_order_relaxed) > 0)
+    {
+      w->seq.fetch_add(1, std::memory_order_release);
+      detail::futexWake(&w->seq, 1);
+    }
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  // producers and consumers don't share cache lines
+  char pad0_[64];
+  std::atomic<size_t> tail_;
+  char pad1_[64 - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> head_;
+  char pad2_[64 - sizeof(std::atomic<size_t>)];
+  Waiters notEmpty_;
+  Waiters notFull_;
+};
+
+template<typename T>
+using MpmcQueue = LockFreeQueue<T, false, false>;
+
+template<typename T>
+using MpscQueue = LockFreeQueue<T, false, true>;
+
+template<typename T>
+using SpscQueue = LockFreeQueue<T, true, true>;
+
+/// Of tryPut() and tryTake() only, for those polling it.
+template<typename T>
+using MpmcRing = LockFreeQueue<T, false, false, false>;
+
+template<typename T>
+using SpscRing = LockFreeQueue<T, true, true, false>;
+
+}  // namespace muduo
+
+#endif  // MUDUO_BASE_LOCKFREEQUEUE_H
@@ -0,0 +1,110 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+
+#pragma once
+
+#include <muduo/base/BlockingQueue.h>
+#include <muduo/base/GzipFile.h>
+#include <muduo/base/Thread.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace muduo
+{
+
+///
+/// Gzips rolled log files in a thread of its own, so neither the logging
+/// threads nor the backend of AsyncLogging wait for it.
+///
+///   LogCompressor compressor;
+///   logFile.setRollCallback(std::bind(&LogCompressor::compress, &compressor, _1));
+///
+/// Files queued when destroyed are still compressed.
+///
+class LogCompressor : noncopyable
+{
+ public:
+  LogCompressor()
+    : thread_(std::bind(&LogCompressor::threadFunc, this), "LogCompressor")
+  {
+    thread_.start();
+  }
+
+  ~LogCompressor()
+  {
+    queue_.put(string());
+    thread_.join();
+  }
+
+  /// Thread safe.
+  void compress(const string& filename)
+  {
+    if (!filename.empty())
+    {
+      queue_.put(filename);
+    }
+  }
+
+  /// Writes filename.gz, then removes filename.
+  /// Leaves filename as it is on failure.
+  static bool compressFile(const string& filename)
+  {
+    FILE* in = ::fopen(filename.c_str(), "rbe");
+    if (in == NULL)
+    {
+      fprintf(stderr, "LogCompressor: open %s failed %s\n", filename.c_str(), strerror(errno));
+      return false;
+    }
+    // renamed once complete, so a .gz is never partial
+    string tmpname = filename + ".gz.tmp";
+    bool ok = false;
+    {
+      GzipFile out = GzipFile::openForWriteTruncate(tmpname);
+      if (out.valid())
+      {
+#if ZLIB_VERNUM >= 0x1240
+        out.setBuffer(64 * 1024);
+#endif
+        char buf[64 * 1024];
+        size_t n = 0;
+        ok = true;
+        while (ok && (n = ::fread(buf, 1, sizeof buf, in)) > 0)
+        {
+          ok = out.write(StringPiece(buf, static_cast<int>(n))) == static_cast<int>(n);
+        }
+        ok = ok && !::ferror(in);
+        // the last of the deflate stream is written here
+        ok = out.close() && ok;
+      }
+    }
+    ::fclose(in);
+    if (ok && ::rename(tmpname.c_str(), (filename + ".gz").c_str()) == 0)
+    {
+      ::unlink(filename.c_str());
+      return true;
+    }
+    fprintf(stderr, "LogCompressor: compress %s failed\n", filename.c_str());
+    ::unlink(tmpname.c_str());
+    return false;
+  }
+
+ private:
+  void threadFunc()
+  {
+    string filename;
+    while (!(filename = queue_.take()).empty())
+    {
+      compressFile(filename);
+    }
+  }
+
+  BlockingQueue<string> queue_;
+  Thread thread_;
+};
+
+}  // namespace muduo
@@ -24,10 +24,13 @@ LogFile::LogFile(const string& basename,
     flushInterval_(flushInterval),
     checkEveryN_(checkEveryN),
     count_(0),
+    rolls_(0),
     mutex_(threadSafe ? new MutexLock : NULL), //这里不需要delete来销毁new对象，因为智能指针
     startOfPeriod_(0),
     lastRoll_(0),
-    lastFlush_(0)
+    lastFlush_(0),
+    preallocate_(0),
+    bytesPerSync_(0)
 {
   //断言basename是否能找到/
   assert(basename.find('/') == string::npos);
@@ -105,11 +108,37 @@ bool LogFile::rollFile()
     lastFlush_ = now;
     startOfPeriod_ = start;
     file_.reset(new FileUtil::AppendFile(filename));
+    ++rolls_;
+    if (preallocate_ > 0)
+    {
+      file_->preallocate(preallocate_);
+    }
+    file_->setBytesPerSync(bytesPerSync_);
+    filename_.swap(filename);
+    if (rollCallback_ && !filename.empty() && filename != filename_)
+    {
+      rollCallback_(filename);
+    }
     return true;
   }
   return false;
 }
 
+void LogFile::setPreallocate(off_t bytes)
+{
+  preallocate_ = bytes;
+  if (preallocate_ > 0)
+  {
+    file_->preallocate(preallocate_);
+  }
+}
+
+void LogFile::setBytesPerSync(off_t bytes)
+{
+  bytesPerSync_ = bytes;
+  file_->setBytesPerSync(bytesPerSync_);
+}
+
 string LogFile::getLogFileName(const string& basename, time_t* now)
 {
   string filename;
@@ -9,6 +9,7 @@
 #include <muduo/base/Mutex.h>
 #include <muduo/base/Types.h>
 
+#include <functional>
 #include <memory>
 
 namespace muduo
@@ -35,6 +36,18 @@ class LogFile : noncopyable
   void append(const char* logline, int len);
   void flush();
   bool rollFile();
+  /// Files opened so far.
+  int rolls() const { return rolls_; }
+
+  typedef std::function<void (const string& filename)> RollCallback;
+
+  /// Preallocates bytes for each file, the current one included.
+  void setPreallocate(off_t bytes);
+  /// See FileUtil::AppendFile::setBytesPerSync().
+  void setBytesPerSync(off_t bytes);
+  /// Called with the name of a file once rolled away from and closed,
+  /// in the thread of append().  LogCompressor::compress() gzips it.
+  void setRollCallback(const RollCallback& cb) { rollCallback_ = cb; }
 
  private:
   void append_unlocked(const char* logline, int len);
@@ -50,6 +63,7 @@ class LogFile : noncopyable
   const int checkEveryN_;
 
   int count_;
+  int rolls_;
 
   std::unique_ptr<MutexLock> mutex_;
   //开始记入日志时间(调整至零点的时间)
@@ -59,6 +73,10 @@ class LogFile : noncopyable
   //上一次日志写入文件的时间
   time_t lastFlush_;
   std::unique_ptr<FileUtil::AppendFile> file_;
+  string filename_;
+  off_t preallocate_;
+  off_t bytesPerSync_;
+  RollCallback rollCallback_;
 
   const static int kRollPerSeconds_ = 60*60*24;
 };
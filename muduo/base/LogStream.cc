@@ -6,6 +6,7 @@
 #include <muduo/base/LogStream.h>
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <type_traits>
 #include <assert.h>
@@ -16,7 +17,6 @@
 using namespace muduo;
 using namespace muduo::detail;
 
-// TODO: better itoa.
 #if defined(__clang__)
 #pragma clang diagnostic ignored "-Wtautological-compare"
 #else
@@ -28,35 +28,74 @@ namespace muduo
 namespace detail
 {
 
-const char digits[] = "9876543210123456789";
-const char* zero = digits + 9;
-static_assert(sizeof(digits) == 20, "wrong number of digits");
-
 const char digitsHex[] = "0123456789ABCDEF";
 static_assert(sizeof digitsHex == 17, "wrong number of digitsHex");
 
-// Efficient Integer to String Conversions, by Matthew Wilson.
-template<typename T>
-size_t convert(char buf[], T value)
+// "00" "01" ... "99", two digits at a time
+const char digitPairs[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+static_assert(sizeof digitPairs == 201, "wrong number of digitPairs");
+
+int countDigits(uint64_t v)
 {
-  T i = value;
-  char* p = buf;
+  int n = 1;
+  for (;;)
+  {
+    if (v < 10) return n;
+    if (v < 100) return n + 1;
+    if (v < 1000) return n + 2;
+    if (v < 10000) return n + 3;
+    v /= 10000;
+    n += 4;
+  }
+}
 
-  do
+// writes the digits of v, ending at end
+template<typename U>
+void writeDigits(char* end, U v)
+{
+  while (v >= 100)
   {
-    //这个lsd表示最后一个数字
-    int lsd = static_cast<int>(i % 10);
-    i /= 10;
-    *p++ = zero[lsd];
-  } while (i != 0);
+    U r = v % 100;
+    v /= 100;
+    end -= 2;
+    memcpy(end, digitPairs + 2 * r, 2);
+  }
+  if (v >= 10)
+  {
+    memcpy(end - 2, digitPairs + 2 * v, 2);
+  }
+  else
+  {
+    end[-1] = static_cast<char>('0' + v);
+  }
+}
 
+// Knows the length up front, and writes in place from the end,
+// with half as many divisions as one digit at a time.
+template<typename T>
+size_t convert(char buf[], T value)
+{
+  typedef typename std::make_unsigned<T>::type U;
+  U i = static_cast<U>(value);
+  char* p = buf;
   if (value < 0)
   {
     *p++ = '-';
+    i = static_cast<U>(static_cast<U>(0) - i);
   }
+  p += countDigits(i);
+  writeDigits(p, i);
   *p = '\0';
-  std::reverse(buf, p);
-
   return p - buf;
 }
 
@@ -78,6 +117,128 @@ size_t convertHex(char buf[], uintptr_t value)
   return p - buf;
 }
 
+const double kPow10[] =
+{
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+  1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+};
+
+// Same as snprintf "%.12g", for 1e-5 <= |v| < 1e15, returns -1 otherwise.
+//
+// v * 10^(11-x) has 12 digits before the point, where x is the decimal
+// exponent of v.  10^n is exact for n <= 22, so it takes one rounding
+// only, off by half an ulp, less than 2^-13 below 2^40.  Rounding it to
+// an integer is right unless the fraction is that close to .5, which
+// is left to snprintf.
+int formatDouble(char* buf, double v)
+{
+  if (v == 0)
+  {
+    char* p = buf;
+    if (std::signbit(v))
+    {
+      *p++ = '-';
+    }
+    *p++ = '0';
+    *p = '\0';
+    return static_cast<int>(p - buf);
+  }
+  double a = std::fabs(v);
+  if (!(a >= 1e-5 && a < 1e15))
+  {
+    return -1;
+  }
+
+  int x = 0;
+  if (a >= 1)
+  {
+    while (x < 14 && a >= kPow10[x + 1]) ++x;
+  }
+  else
+  {
+    while (x > -5 && a * kPow10[-x] < 1) --x;
+  }
+
+  const uint64_t kMin = 100000000000ULL;  // 12 digits
+  uint64_t digits = 0;
+  for (int tries = 0; ; ++tries)
+  {
+    if (tries == 3 || x < -5 || x > 14)
+    {
+      return -1;
+    }
+    int e = 11 - x;
+    double scaled = e >= 0 ? a * kPow10[e] : a / kPow10[-e];
+    double whole = std::floor(scaled);
+    double fraction = scaled - whole;
+    if (std::fabs(fraction - 0.5) < 1e-3)
+    {
+      return -1;
+    }
+    digits = static_cast<uint64_t>(whole) + (fraction > 0.5 ? 1 : 0);
+    if (digits >= kMin * 10)
+    {
+      ++x;   // x too small, or rounded up to 10^12
+    }
+    else if (digits < kMin)
+    {
+      --x;
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  char d[12];
+  writeDigits(d + 12, digits);
+  int last = 11;
+  while (d[last] == '0') --last;
+
+  char* p = buf;
+  if (v < 0)
+  {
+    *p++ = '-';
+  }
+  if (x < -4 || x >= 12)
+  {
+    *p++ = d[0];
+    if (last > 0)
+    {
+      *p++ = '.';
+      memcpy(p, d + 1, last);
+      p += last;
+    }
+    *p++ = 'e';
+    *p++ = x < 0 ? '-' : '+';
+    int ax = x < 0 ? -x : x;
+    memcpy(p, digitPairs + 2 * ax, 2);
+    p += 2;
+  }
+  else if (x >= 0)
+  {
+    memcpy(p, d, x + 1);
+    p += x + 1;
+    if (last > x)
+    {
+      *p++ = '.';
+      memcpy(p, d + x + 1, last - x);
+      p += last - x;
+    }
+  }
+  else
+  {
+    *p++ = '0';
+    *p++ = '.';
+    memset(p, '0', -x - 1);
+    p += -x - 1;
+    memcpy(p, d, last + 1);
+    p += last + 1;
+  }
+  *p = '\0';
+  return static_cast<int>(p - buf);
+}
+
 template class FixedBuffer<kSmallBuffer>;
 template class FixedBuffer<kLargeBuffer>;
 
@@ -187,12 +348,15 @@ LogStream& LogStream::operator<<(const void* p)
   return *this;
 }
 
-// FIXME: replace this with Grisu3 by Florian Loitsch.
 LogStream& LogStream::operator<<(double v)
 {
   if (buffer_.avail() >= kMaxNumericSize)
   {
-    int len = snprintf(buffer_.current(), kMaxNumericSize, "%.12g", v);
+    int len = formatDouble(buffer_.current(), v);
+    if (len < 0)
+    {
+      len = snprintf(buffer_.current(), kMaxNumericSize, "%.12g", v);
+    }
     buffer_.add(len);
   }
   return *this;
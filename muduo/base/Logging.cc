@@ -111,6 +111,7 @@ void defaultFlush()
 
 Logger::OutputFunc g_output = defaultOutput;
 Logger::FlushFunc g_flush = defaultFlush;
+Logger::BinaryOutputFunc g_binaryOutput = NULL;
 TimeZone g_logTimeZone;
 
 }  // namespace muduo
@@ -225,6 +226,11 @@ void Logger::setFlush(FlushFunc flush)
   g_flush = flush;
 }
 
+void Logger::setBinaryOutput(BinaryOutputFunc out)
+{
+  g_binaryOutput = out;
+}
+
 void Logger::setTimeZone(const TimeZone& tz)
 {
   g_logTimeZone = tz;
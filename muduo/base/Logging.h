@@ -75,6 +75,9 @@ class Logger
   typedef void (*FlushFunc)();
   static void setOutput(OutputFunc);
   static void setFlush(FlushFunc);
+  // for records of LOG_FMT, see BinaryLog.h
+  typedef void (*BinaryOutputFunc)(const char* record, int len);
+  static void setBinaryOutput(BinaryOutputFunc);
   static void setTimeZone(const TimeZone& tz);
 
  private:
@@ -8,8 +8,10 @@
 #include <muduo/base/Exception.h>
 #include <muduo/base/Logging.h>
 
+#include <algorithm>
 #include <type_traits>
 
+#include <ctype.h>
 #include <errno.h>
 #include <stdio.h>
 #include <unistd.h>
@@ -57,6 +59,25 @@ class ThreadNameInitializer
 
 ThreadNameInitializer init;
 
+// The kernel keeps 15 chars of a thread name, "EchoServer-loop12" would
+// become "EchoServer-loop", so keeps the trailing number of a pool thread,
+// "EchoServer-lo12", which top(1) and perf(1) show.
+string kernelThreadName(const string& name)
+{
+  const size_t kMaxLength = 15;
+  if (name.size() <= kMaxLength)
+  {
+    return name;
+  }
+  size_t digits = name.size();
+  while (digits > 0 && isdigit(static_cast<unsigned char>(name[digits - 1])))
+  {
+    --digits;
+  }
+  size_t tail = std::min(name.size() - digits, kMaxLength / 2);
+  return name.substr(0, kMaxLength - tail) + name.substr(name.size() - tail);
+}
+
 struct ThreadData
 {
   typedef muduo::Thread::ThreadFunc ThreadFunc;
@@ -83,7 +104,7 @@ struct ThreadData
     latch_ = NULL;
 
     muduo::CurrentThread::t_threadName = name_.empty() ? "muduoThread" : name_.c_str();
-    ::prctl(PR_SET_NAME, muduo::CurrentThread::t_threadName);
+    ::prctl(PR_SET_NAME, kernelThreadName(name_).c_str());
     try
     {
       func_();
@@ -18,7 +18,7 @@ template<typename T>
 class ThreadLocalSingleton : noncopyable
 {
  public:
-  ThreadLocalSingle ton() = delete;
+  ThreadLocalSingleton() = delete;
   ~ThreadLocalSingleton() = delete;
 
   static T& instance()
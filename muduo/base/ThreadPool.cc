@@ -6,19 +6,120 @@
 #include <muduo/base/ThreadPool.h>
 
 #include <muduo/base/Exception.h>
+#include <muduo/base/LockFreeQueue.h>
+#include <muduo/base/WorkStealingDeque.h>
+
+#include <deque>
+#include <random>
 
 #include <assert.h>
+#include <sched.h>
 #include <stdio.h>
 
 using namespace muduo;
 
+namespace muduo
+{
+namespace detail
+{
+
+struct ThreadPoolWorker : noncopyable
+{
+  ThreadPoolWorker(ThreadPool* p, size_t i)
+    : pool(p), index(i), random(static_cast<unsigned>(i + 1))
+  { }
+
+  ~ThreadPoolWorker()
+  {
+    while (ThreadPool::Task* task = deque.pop())
+    {
+      delete task;
+    }
+  }
+
+  ThreadPool* const pool;
+  const size_t index;
+  WorkStealingDeque<ThreadPool::Task> deque;
+  std::minstd_rand random;
+};
+
+// Lock-free ring of tasks, spills into a locked deque when full,
+// which is slow but rare.
+class TaskRing : noncopyable
+{
+ public:
+  typedef ThreadPool::Task Task;
+  static const size_t kCapacity = 4096;
+
+  TaskRing()
+    : ring_(kCapacity),
+      overflowSize_(0)
+  {
+  }
+
+  void push(Task&& task)
+  {
+    if (overflowSize_.load(std::memory_order_acquire) == 0
+        && ring_.tryPut(std::move(task)))
+    {
+      return;
+    }
+    MutexLockGuard lock(mutex_);
+    overflow_.push_back(std::move(task));
+    overflowSize_.store(overflow_.size(), std::memory_order_release);
+  }
+
+  bool pop(Task* task)
+  {
+    if (ring_.tryTake(task))
+    {
+      return true;
+    }
+    if (overflowSize_.load(std::memory_order_acquire) > 0)
+    {
+      MutexLockGuard lock(mutex_);
+      if (!overflow_.empty())
+      {
+        *task = std::move(overflow_.front());
+        overflow_.pop_front();
+        overflowSize_.store(overflow_.size(), std::memory_order_release);
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  MpmcRing<Task> ring_;  // polled, never waited on
+  std::atomic<size_t> overflowSize_;
+  MutexLock mutex_;
+  std::deque<Task> overflow_ GUARDED_BY(mutex_);
+};
+
+const size_t TaskRing::kCapacity;
+
+}  // namespace detail
+}  // namespace muduo
+
+namespace
+{
+__thread detail::ThreadPoolWorker* t_worker = NULL;
+
+// searches this many times before going to sleep
+const int kSpins = 16;
+}
+
 ThreadPool::ThreadPool(const string& nameArg)
   : mutex_(),
     notEmpty_(mutex_),
     notFull_(mutex_),
     name_(nameArg),
+    ring_(new detail::TaskRing),
     maxQueueSize_(0),
-    running_(false)
+    running_(false),
+    pending_(0),
+    sleeping_(0),
+    blocked_(0)
 {
 }
 
@@ -36,11 +137,15 @@ void ThreadPool::start(int numThreads)
   running_ = true;
   threads_.reserve(numThreads);
   for (int i = 0; i < numThreads; ++i)
+  {
+    workers_.emplace_back(new detail::ThreadPoolWorker(this, i));
+  }
+  for (int i = 0; i < numThreads; ++i)
   {
     char id[32];
     snprintf(id, sizeof id, "%d", i+1);
     threads_.emplace_back(new muduo::Thread(
-          std::bind(&ThreadPool::runInThread, this), name_+id));
+          std::bind(&ThreadPool::runInThread, this, i), name_+id));
     threads_[i]->start();
   }
   if (numThreads == 0 && threadInitCallback_)
@@ -55,6 +160,7 @@ void ThreadPool::stop()
   MutexLockGuard lock(mutex_);
   running_ = false;
   notEmpty_.notifyAll();
+  notFull_.notifyAll();
   }
   for (auto& thr : threads_)
   {
@@ -64,77 +170,161 @@ void ThreadPool::stop()
 
 size_t ThreadPool::queueSize() const
 {
-  MutexLockGuard lock(mutex_);
-  return queue_.size();
+  int64_t pending = pending_.load(std::memory_order_relaxed);
+  return pending > 0 ? static_cast<size_t>(pending) : 0;
 }
-//这个扑街函数的作用是往任务队列中添加任务
+
 void ThreadPool::run(Task task)
 {
   if (threads_.empty())
   {
     task();
+    return;
+  }
+
+  detail::ThreadPoolWorker* worker = t_worker;
+  if (worker && worker->pool == this)
+  {
+    pending_.fetch_add(1);
+    worker->deque.push(new Task(std::move(task)));
   }
   else
+  {
+    reserve();
+    ring_->push(std::move(task));
+  }
+  // pairs with the check in runInThread(), either we see a sleeper,
+  // or it sees pending_ > 0
+  if (sleeping_.load() > 0)
   {
     MutexLockGuard lock(mutex_);
-    while (isFull())
-    {
-      notFull_.wait();
-    }
-    assert(!isFull());
-
-    queue_.push_back(std::move(task));
     notEmpty_.notify();
   }
 }
 
-ThreadPool::Task ThreadPool::take()
+// counts a task to be queued, blocks while full
+void ThreadPool::reserve()
 {
-  MutexLockGuard lock(mutex_);
-  // always use a while-loop, due to spurious wakeup
-  while (queue_.empty() && running_)
+  if (maxQueueSize_ == 0)
   {
-    notEmpty_.wait();
+    pending_.fetch_add(1);
+    return;
   }
-  Task task;
-  if (!queue_.empty())
+  const int64_t maxSize = static_cast<int64_t>(maxQueueSize_);
+  int64_t pending = pending_.load();
+  for (;;)
   {
-    task = queue_.front();
-    queue_.pop_front();
-    //如果maxQueueSize大于0，说明设置了最大队列长度，否则的话，就不需要notify，因为一定不会满
-    if (maxQueueSize_ > 0)
+    if (pending < maxSize)
     {
-      notFull_.notify();
+      if (pending_.compare_exchange_weak(pending, pending + 1))
+      {
+        return;
+      }
+      continue;
+    }
+    MutexLockGuard lock(mutex_);
+    blocked_.fetch_add(1);
+    while (running_ && pending_.load() >= maxSize)
+    {
+      notFull_.wait();
+    }
+    blocked_.fetch_sub(1);
+    if (!running_)
+    {
+      pending_.fetch_add(1);
+      return;
     }
+    pending = pending_.load();
+  }
+}
+
+void ThreadPool::taken()
+{
+  int64_t pending = pending_.fetch_sub(1) - 1;
+  // wakes blocked callers at half full, not for every task taken,
+  // pending_ goes down one by one, so it can't skip that
+  if (maxQueueSize_ > 0
+      && pending == static_cast<int64_t>(maxQueueSize_ / 2)
+      && blocked_.load() > 0)
+  {
+    MutexLockGuard lock(mutex_);
+    notFull_.notifyAll();
   }
-  return task;
 }
 
-bool ThreadPool::isFull() const
+bool ThreadPool::take(detail::ThreadPoolWorker* worker, Task* task)
 {
-  mutex_.assertLocked();
-  return maxQueueSize_ > 0 && queue_.size() >= maxQueueSize_;
+  Task* local = worker->deque.pop();
+  if (local == NULL && !ring_->pop(task))
+  {
+    // steals from a random victim onwards
+    const size_t n = workers_.size();
+    size_t start = worker->random() % n;
+    for (size_t i = 0; i < n && local == NULL; ++i)
+    {
+      detail::ThreadPoolWorker* victim = workers_[(start + i) % n].get();
+      if (victim != worker)
+      {
+        local = victim->deque.steal();
+      }
+    }
+    if (local == NULL)
+    {
+      return false;
+    }
+  }
+  if (local)
+  {
+    *task = std::move(*local);
+    delete local;
+  }
+  taken();
+  return true;
 }
 
-void ThreadPool::runInThread()
+void ThreadPool::runInThread(size_t index)
 {
   try
   {
+    detail::ThreadPoolWorker* worker = workers_[index].get();
+    t_worker = worker;
+    if (!affinity_.apply(index))
+    {
+      fprintf(stderr, "ThreadPool %s failed to pin thread %zu to cpus %s\n",
+              name_.c_str(), index, affinity_.cpusOf(index).toString().c_str());
+    }
     if (threadInitCallback_)
     {
       threadInitCallback_();
     }
+    int spins = 0;
     while (running_)
     {
-      //take()的时候可能由于任务队列为空，导致等待条件变量
-      //所以stop的时候要加一个notEmpty_.notifyall()来唤醒
-      //线程池所以阻塞的线程
-      Task task(take());
-      if (task)
+      Task task;
+      if (take(worker, &task))
       {
+        spins = 0;
         task();
       }
+      else if (++spins < kSpins)
+      {
+        ::sched_yield();
+      }
+      else
+      {
+        spins = 0;
+        MutexLockGuard lock(mutex_);
+        sleeping_.fetch_add(1);
+        // a task counted but not yet queued, or in the middle of being
+        // stolen, shows up soon
+        if (running_ && pending_.load() == 0)
+        {
+          notEmpty_.wait();
+        }
+        sleeping_.fetch_sub(1);
+      }
     }
+    t_worker = NULL;
   }
   catch (const Exception& ex)
   {
@@ -155,4 +345,3 @@ void ThreadPool::runInThread()
     throw; // rethrow
   }
 }
-
@@ -6,17 +6,35 @@
 #ifndef MUDUO_BASE_THREADPOOL_H
 #define MUDUO_BASE_THREADPOOL_H
 
+#include <muduo/base/Affinity.h>
 #include <muduo/base/Condition.h>
 #include <muduo/base/Mutex.h>
 #include <muduo/base/Thread.h>
 #include <muduo/base/Types.h>
 
-#include <deque>
+#include <atomic>
 #include <vector>
 
 namespace muduo
 {
 
+namespace detail
+{
+struct ThreadPoolWorker;
+class TaskRing;
+}
+
+///
+/// Work stealing thread pool.
+///
+/// Each worker has its own deque, tasks run by a worker go there and are
+/// taken LIFO, tasks from other threads go to a shared lock-free ring.
+/// An idle worker takes from its deque, then the ring, then steals FIFO
+/// from a random other worker, and sleeps only when all are empty,
+/// so the mutex is touched only to sleep and wake up.
+///
+/// Tasks run in no particular order.
+///
 class ThreadPool : noncopyable
 {
  public:
@@ -26,35 +44,48 @@ class ThreadPool : noncopyable
   ~ThreadPool();
 
   // Must be called before start().
+  /// run() from other threads blocks while maxSize tasks are waiting,
+  /// a worker never blocks on its own pool, or it could deadlock.
   void setMaxQueueSize(int maxSize) { maxQueueSize_ = maxSize; }
   void setThreadInitCallback(const Task& cb)
   { threadInitCallback_ = cb; }
+  /// Applied in each thread before its init callback.
+  void setThreadAffinity(const ThreadAffinity& affinity)
+  { affinity_ = affinity; }
 
   void start(int numThreads);
+  /// Waits for running tasks, the waiting ones are dropped.
   void stop();
 
   const string& name() const
   { return name_; }
 
+  /// Tasks waiting, in all queues.
   size_t queueSize() const;
 
   // Could block if maxQueueSize > 0
   void run(Task f);
 
  private:
-  bool isFull() const REQUIRES(mutex_);
-  void runInThread();
-  Task take();
+  void reserve();
+  void taken();
+  bool take(detail::ThreadPoolWorker* worker, Task* task);
+  void runInThread(size_t index);
 
   mutable MutexLock mutex_;
   Condition notEmpty_ GUARDED_BY(mutex_);
   Condition notFull_ GUARDED_BY(mutex_);
   string name_;
   Task threadInitCallback_;
+  ThreadAffinity affinity_;
   std::vector<std::unique_ptr<muduo::Thread>> threads_;
-  std::deque<Task> queue_ GUARDED_BY(mutex_);
+  std::vector<std::unique_ptr<detail::ThreadPoolWorker>> workers_;
+  std::unique_ptr<detail::TaskRing> ring_;
   size_t maxQueueSize_;
-  bool running_;
+  std::atomic<bool> running_;
+  std::atomic<int64_t> pending_;  // waiting in deques and ring
+  std::atomic<int> sleeping_;     // workers in notEmpty_
+  std::atomic<int> blocked_;      // callers of run() in notFull_
 };
 
 }  // namespace muduo
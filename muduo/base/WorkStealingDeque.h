@@ -0,0 +1,162 @@
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+//
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+
+#ifndef MUDUO_BASE_WORKSTEALINGDEQUE_H
+#define MUDUO_BASE_WORKSTEALINGDEQUE_H
+
+#include <muduo/base/noncopyable.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <assert.h>
+#include <stdint.h>
+
+namespace muduo
+{
+
+///
+/// Chase-Lev work stealing deque of T*, lock free.
+///
+/// The owner thread pushes and pops at the bottom, LIFO, which keeps its
+/// caches warm, any other thread steals from the top, FIFO.
+/// Grows as needed, outgrown arrays are kept until destruction, since a
+/// thief might still be reading one.
+/// See "Correct and Efficient Work-Stealing for Weak Memory Models",
+/// Lê et al., PPoPP 2013.
+///
+template<typename T>
+class WorkStealingDeque : noncopyable
+{
+ public:
+  explicit WorkStealingDeque(int64_t capacity = 1024)
+    : top_(0),
+      bottom_(0),
+      array_(new Array(capacity))
+  {
+    assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+    arrays_.emplace_back(array_.load(std::memory_order_relaxed));
+  }
+
+  /// Owner only.
+  void push(T* item)
+  {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Array* a = array_.load(std::memory_order_relaxed);
+    if (b - t > a->capacity - 1)
+    {
+      a = grow(a, t, b);
+    }
+    a->put(b, item);
+    // publishes *item to thieves
+    bottom_.store(b + 1, std::memory_order_release);
+  }
+
+  /// Owner only, NULL if empty.
+  T* pop()
+  {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Array* a = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    T* item = NULL;
+    if (t <= b)
+    {
+      item = a->get(b);
+      if (t == b)
+      {
+        // the last one, races with thieves
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed))
+        {
+          item = NULL;
+        }
+        bottom_.store(b + 1, std::memory_order_relaxed);
+      }
+    }
+    else
+    {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  /// Any thread, NULL if empty or lost a race, which is worth a retry
+  /// only if size() > 0.
+  T* steal()
+  {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    T* item = NULL;
+    if (t < b)
+    {
+      Array* a = array_.load(std::memory_order_acquire);
+      item = a->get(t);
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed))
+      {
+        item = NULL;
+      }
+    }
+    return item;
+  }
+
+  /// Approximate if called from other threads.
+  int64_t size() const
+  {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    return b > t ? b - t : 0;
+  }
+
+  bool empty() const { return size() == 0; }
+
+ private:
+  struct Array
+  {
+    explicit Array(int64_t cap)
+      : capacity(cap),
+        mask(cap - 1),
+        items(new std::atomic<T*>[cap])
+    { }
+
+    T* get(int64_t i) const
+    { return items[i & mask].load(std::memory_order_relaxed); }
+
+    void put(int64_t i, T* item)
+    { items[i & mask].store(item, std::memory_order_relaxed); }
+
+    const int64_t capacity;
+    const int64_t mask;
+    std::unique_ptr<std::atomic<T*>[]> items;
+  };
+
+  Array* grow(Array* a, int64_t t, int64_t b)
+  {
+    Array* bigger = new Array(a->capacity * 2);
+    for (int64_t i = t; i < b; ++i)
+    {
+      bigger->put(i, a->get(i));
+    }
+    arrays_.emplace_back(bigger);
+    array_.store(bigger, std::memory_order_release);
+    return bigger;
+  }
+
+  // top_ and bottom_ on their own cache lines, thieves hammer top_
+  std::atomic<int64_t> top_;
+  char pad_[64 - sizeof(std::atomic<int64_t>)];
+  std::atomic<int64_t> bottom_;
+  std::atomic<Array*> array_;
+  std::vector<std::unique_ptr<Array>> arrays_;  // owner only
+};
+
+}  // namespace muduo
+
+#endif  // MUDUO_BASE_WORKSTEALINGDEQUE_H
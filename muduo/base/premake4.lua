@@ -7,7 +7,9 @@ project "base"
     headersdir('muduo/base')
     headers('*.h')
     files {
+            'Affinity.cc',
             'AsyncLogging.cc',
+            'BinaryLog.cc',
             'Condition.cc',
             'CountDownLatch.cc',
             'Date.cc',
@@ -0,0 +1,86 @@
+#include <muduo/base/Affinity.h>
+#include <muduo/base/CountDownLatch.h>
+#include <muduo/base/Mutex.h>
+#include <muduo/base/ThreadPool.h>
+
+#include <map>
+
+#include <sched.h>
+#include <sys/prctl.h>
+
+//#define BOOST_TEST_MODULE AffinityTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using muduo::string;
+using muduo::CpuSet;
+using muduo::ThreadAffinity;
+
+BOOST_AUTO_TEST_CASE(testCpuSetParse)
+{
+  CpuSet cpus = CpuSet::parse("0-3,8,10-11\n");
+  BOOST_CHECK_EQUAL(cpus.size(), 7);
+  BOOST_CHECK(cpus.contains(2));
+  BOOST_CHECK(!cpus.contains(9));
+  BOOST_CHECK_EQUAL(cpus[4], 8);
+  BOOST_CHECK_EQUAL(cpus[7], 0);
+  BOOST_CHECK_EQUAL(cpus.toString(), string("0-3,8,10-11"));
+
+  // keeps the order, drops duplicates
+  std::vector<int> list = { 5, 1, 2, 5 };
+  BOOST_CHECK_EQUAL(CpuSet(list).toString(), string("5,1-2"));
+
+  BOOST_CHECK(CpuSet::parse("").empty());
+  BOOST_CHECK(CpuSet::parse("3-1").empty());
+  BOOST_CHECK(CpuSet::parse("1,x").empty());
+  BOOST_CHECK(!CpuSet::allowed().empty());
+  BOOST_CHECK(!CpuSet::ofNode(0).empty());
+  BOOST_CHECK(CpuSet::ofDevice("no-such-nic0").empty());
+}
+
+BOOST_AUTO_TEST_CASE(testThreadAffinity)
+{
+  CpuSet cpus = CpuSet::parse("4,6");
+  ThreadAffinity none;
+  BOOST_CHECK(none.cpusOf(0).empty());
+  BOOST_CHECK(ThreadAffinity(ThreadAffinity::kEachOne, CpuSet()).mode() == ThreadAffinity::kNone);
+
+  ThreadAffinity each(ThreadAffinity::kEachOne, cpus);
+  BOOST_CHECK_EQUAL(each.cpusOf(0).toString(), string("4"));
+  BOOST_CHECK_EQUAL(each.cpusOf(1).toString(), string("6"));
+  BOOST_CHECK_EQUAL(each.cpusOf(2).toString(), string("4"));
+
+  ThreadAffinity shared(ThreadAffinity::kShared, cpus);
+  BOOST_CHECK_EQUAL(shared.cpusOf(1).toString(), string("4,6"));
+}
+
+BOOST_AUTO_TEST_CASE(testThreadPoolAffinity)
+{
+  CpuSet allowed = CpuSet::allowed();
+  const int kThreads = 3;
+  muduo::MutexLock mutex;
+  std::map<string, string> pinned;
+  muduo::CountDownLatch latch(kThreads);
+
+  muduo::ThreadPool pool("AffinityTestPool");
+  pool.setThreadAffinity(ThreadAffinity(ThreadAffinity::kEachOne, allowed));
+  pool.setThreadInitCallback([&] {
+    char name[16] = "";
+    ::prctl(PR_GET_NAME, name);
+    {
+    muduo::MutexLockGuard lock(mutex);
+    pinned[name] = CpuSet::allowed().toString();
+    }
+    latch.countDown();
+  });
+  pool.start(kThreads);
+  latch.wait();
+  pool.stop();
+
+  // long names keep their index
+  BOOST_REQUIRE_EQUAL(pinned.size(), kThreads);
+  BOOST_CHECK_EQUAL(pinned["AffinityTestPo1"], ThreadAffinity(ThreadAffinity::kEachOne, allowed).cpusOf(0).toString());
+  BOOST_CHECK_EQUAL(pinned["AffinityTestPo2"], ThreadAffinity(ThreadAffinity::kEachOne, allowed).cpusOf(1).toString());
+  BOOST_CHECK_EQUAL(pinned["AffinityTestPo3"], ThreadAffinity(ThreadAffinity::kEachOne, allowed).cpusOf(2).toString());
+}
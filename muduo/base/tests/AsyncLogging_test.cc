@@ -1,7 +1,12 @@
 #include <muduo/base/AsyncLogging.h>
 #include <muduo/base/Logging.h>
+#include <muduo/base/Thread.h>
 #include <muduo/base/Timestamp.h>
 
+#include <memory>
+#include <vector>
+
+#include <inttypes.h>
 #include <stdio.h>
 #include <sys/resource.h>
 #include <unistd.h>
@@ -42,6 +47,39 @@ void bench(bool longLog)
   }
 }
 
+// lines/s of the front end, many threads logging at once
+void benchThreads(int numThreads)
+{
+  muduo::Logger::setOutput(asyncOutput);
+
+  const int kLines = 200*1000;
+  std::vector<std::unique_ptr<muduo::Thread>> threads;
+  for (int i = 0; i < numThreads; ++i)
+  {
+    threads.emplace_back(new muduo::Thread([] {
+      for (int n = 0; n < kLines; ++n)
+      {
+        LOG_INFO << "Hello 0123456789" << " abcdefghijklmnopqrstuvwxyz " << n;
+      }
+    }));
+  }
+  int64_t dropped = g_asyncLog->dropped();
+  muduo::Timestamp start = muduo::Timestamp::now();
+  for (auto& thr : threads)
+  {
+    thr->start();
+  }
+  for (auto& thr : threads)
+  {
+    thr->join();
+  }
+  double seconds = timeDifference(muduo::Timestamp::now(), start);
+  printf("%2d threads: %10.0f lines/s, %" PRId64 " dropped\n",
+         numThreads, numThreads * kLines / seconds, g_asyncLog->dropped() - dropped);
+  struct timespec ts = { 1, 0 };
+  nanosleep(&ts, NULL);
+}
+
 int main(int argc, char* argv[])
 {
   {
@@ -59,6 +97,10 @@ int main(int argc, char* argv[])
   log.start();
   g_asyncLog = &log;
 
+  benchThreads(1);
+  benchThreads(8);
+  benchThreads(32);
+
   bool longLog = argc > 1;
   bench(longLog);
 }
@@ -0,0 +1,127 @@
+#include <muduo/base/AsyncLogging.h>
+#include <muduo/base/FileUtil.h>
+#include <muduo/base/Thread.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+//#define BOOST_TEST_MODULE AsyncLoggingTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using muduo::string;
+
+namespace
+{
+string readLogs(const char* dir)
+{
+  string all;
+  DIR* d = ::opendir(dir);
+  while (struct dirent* entry = ::readdir(d))
+  {
+    if (entry->d_name[0] != '.')
+    {
+      string path = string(dir) + "/" + entry->d_name;
+      string content;
+      muduo::FileUtil::readFile(path, 1 << 30, &content);
+      all += content;
+      ::unlink(path.c_str());
+    }
+  }
+  ::closedir(d);
+  return all;
+}
+}
+
+BOOST_AUTO_TEST_CASE(testAsyncLoggingManyThreads)
+{
+  char dir[] = "/tmp/asynclogging_XXXXXX";
+  BOOST_REQUIRE(::mkdtemp(dir) != NULL);
+  char cwd[1024];
+  BOOST_REQUIRE(::getcwd(cwd, sizeof cwd) != NULL);
+  BOOST_REQUIRE(::chdir(dir) == 0);
+
+  const int kThreads = 4;
+  const int kLines = 20000;
+  {
+    muduo::AsyncLogging log("unittest", 1000 * 1000 * 1000, 1);
+    log.start();
+    std::vector<std::unique_ptr<muduo::Thread>> threads;
+    for (int t = 0; t < kThreads; ++t)
+    {
+      threads.emplace_back(new muduo::Thread([&log, t] {
+        for (int n = 0; n < kLines; ++n)
+        {
+          char line[64];
+          int len = snprintf(line, sizeof line, "thread %d line %d\n", t, n);
+          log.append(line, len);
+        }
+      }));
+      threads.back()->start();
+    }
+    for (auto& thr : threads)
+    {
+      thr->join();
+    }
+    // a thread that has exited is still written out
+    log.stop();
+    BOOST_CHECK_EQUAL(log.dropped(), 0);
+  }
+  BOOST_REQUIRE(::chdir(cwd) == 0);
+
+  string logs = readLogs(dir);
+  ::rmdir(dir);
+
+  // every line once, lines of a thread in order
+  std::map<int, int> next;
+  int lines = 0;
+  bool inOrder = true;
+  size_t start = 0;
+  while (start < logs.size())
+  {
+    size_t eol = logs.find('\n', start);
+    BOOST_REQUIRE(eol != string::npos);
+    int t = -1, n = -1;
+    BOOST_REQUIRE(sscanf(logs.c_str() + start, "thread %d line %d", &t, &n) == 2);
+    inOrder = inOrder && next[t] == n;
+    next[t] = n + 1;
+    ++lines;
+    start = eol + 1;
+  }
+  BOOST_CHECK(inOrder);
+  BOOST_CHECK_EQUAL(lines, kThreads * kLines);
+}
+
+BOOST_AUTO_TEST_CASE(testAsyncLoggingChunkSize)
+{
+  char dir[] = "/tmp/asynclogging_XXXXXX";
+  BOOST_REQUIRE(::mkdtemp(dir) != NULL);
+  char cwd[1024];
+  BOOST_REQUIRE(::getcwd(cwd, sizeof cwd) != NULL);
+  BOOST_REQUIRE(::chdir(dir) == 0);
+  {
+    muduo::AsyncLogging log("unittest", 1000 * 1000 * 1000, 1);
+    log.setChunkSize(1024);
+    log.setMaxChunksPerThread(2);
+    log.start();
+    // longer than a chunk
+    string longLine(2000, 'x');
+    longLine += '\n';
+    log.append(longLine.data(), static_cast<int>(longLine.size()));
+    log.append("short\n", 6);
+    log.stop();
+    BOOST_CHECK_EQUAL(log.dropped(), 1);
+  }
+  BOOST_REQUIRE(::chdir(cwd) == 0);
+  string logs = readLogs(dir);
+  BOOST_CHECK_EQUAL(logs.substr(0, 6), "short\n");
+  BOOST_CHECK(logs.find("xxx") == string::npos);
+  ::rmdir(dir);
+}
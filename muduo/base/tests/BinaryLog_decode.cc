@@ -0,0 +1,48 @@
+#include <muduo/base/BinaryLog.h>
+
+#include <stdio.h>
+
+// Decodes files of AsyncLogging::setBinaryFile(true) to text, on stdout.
+
+bool decodeFile(FILE* fp, const char* name)
+{
+  muduo::binlog::Decoder decoder;
+  char buf[64 * 1024];
+  muduo::string text;
+  size_t n = 0;
+  while ((n = fread(buf, 1, sizeof buf, fp)) > 0)
+  {
+    text.clear();
+    decoder.decode(buf, n, &text);
+    fwrite(text.data(), 1, text.size(), stdout);
+  }
+  if (decoder.errors() > 0)
+  {
+    fprintf(stderr, "%s: %lld of %lld records not decoded\n", name,
+            static_cast<long long>(decoder.errors()),
+            static_cast<long long>(decoder.records()));
+  }
+  return decoder.errors() == 0;
+}
+
+int main(int argc, char* argv[])
+{
+  bool ok = true;
+  if (argc < 2)
+  {
+    ok = decodeFile(stdin, "stdin");
+  }
+  for (int i = 1; i < argc; ++i)
+  {
+    FILE* fp = fopen(argv[i], "rb");
+    if (fp == NULL)
+    {
+      perror(argv[i]);
+      ok = false;
+      continue;
+    }
+    ok = decodeFile(fp, argv[i]) && ok;
+    fclose(fp);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,227 @@
+#include <muduo/base/BinaryLog.h>
+#include <muduo/base/AsyncLogging.h>
+#include <muduo/base/FileUtil.h>
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+//#define BOOST_TEST_MODULE BinaryLogTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using muduo::string;
+using muduo::Logger;
+
+namespace
+{
+string g_captured;
+muduo::AsyncLogging* g_async;
+
+void captureOutput(const char* msg, int len)
+{
+  g_captured.append(msg, len);
+}
+
+void asyncOutput(const char* msg, int len)
+{
+  g_async->append(msg, len);
+}
+
+void asyncBinaryOutput(const char* record, int len)
+{
+  g_async->appendBinary(record, len);
+}
+
+void stdoutOutput(const char* msg, int len)
+{
+  fwrite(msg, 1, len, stdout);
+}
+
+string readLogs(const char* dir)
+{
+  string all;
+  DIR* d = ::opendir(dir);
+  while (struct dirent* entry = ::readdir(d))
+  {
+    if (entry->d_name[0] != '.')
+    {
+      string path = string(dir) + "/" + entry->d_name;
+      string content;
+      muduo::FileUtil::readFile(path, 1 << 30, &content);
+      all += content;
+      ::unlink(path.c_str());
+    }
+  }
+  ::closedir(d);
+  return all;
+}
+
+enum Color { kRed, kGreen };
+}
+
+BOOST_AUTO_TEST_CASE(testFormatLikeLogStream)
+{
+  Logger::setOutput(captureOutput);
+  string str("string");
+  muduo::StringPiece piece("piece");
+  const void* ptr = &str;
+  LOG_FMT(INFO, "i {} u {} d {} c {} s {} {} {} p {} e {} b {} end",
+          -42, 18446744073709551615ULL, 1.5, 'x', "literal", str, piece, ptr, kGreen, true);
+  muduo::LogStream expected;
+  expected << "INFO  i " << -42 << " u " << 18446744073709551615ULL << " d " << 1.5
+           << " c " << 'x' << " s literal string piece p " << ptr << " e " << 1
+           << " b " << true << " end - BinaryLog_unittest.cc:" << __LINE__ - 5 << '\n';
+  string line = g_captured;
+  g_captured.clear();
+  Logger::setOutput(stdoutOutput);
+
+  // time, then thread id padded to 5 digits
+  BOOST_REQUIRE(line.size() > 33);
+  BOOST_CHECK_EQUAL(line[8], ' ');
+  BOOST_CHECK_EQUAL(line[24], 'Z');
+  size_t level = line.find("INFO  ");
+  BOOST_REQUIRE(level != string::npos);
+  BOOST_CHECK_EQUAL(line.substr(level), expected.buffer().toString());
+}
+
+BOOST_AUTO_TEST_CASE(testMissingArgs)
+{
+  Logger::setOutput(captureOutput);
+  LOG_FMT(WARN, "a {} b {} c");
+  LOG_FMT(WARN, "a {} b {} c", 1);
+  LOG_FMT(TRACE, "no args");
+  string lines = g_captured;
+  g_captured.clear();
+  Logger::setOutput(stdoutOutput);
+
+  BOOST_CHECK(lines.find("WARN  a {} b {} c - ") != string::npos);
+  BOOST_CHECK(lines.find("WARN  a 1 b {} c - ") != string::npos);
+  // with the function, as LOG_TRACE
+  BOOST_CHECK(lines.find("TRACE test_method no args - ") != string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(testDecoder)
+{
+  Logger::setOutput(captureOutput);
+  Logger::setBinaryOutput([](const char* record, int len) {
+    const muduo::binlog::Site* site = muduo::binlog::site(
+        reinterpret_cast<const muduo::binlog::RecordHeader*>(record)->site);
+    muduo::binlog::encodeSite(*site, &g_captured);
+    muduo::binlog::EntryHeader header = { muduo::binlog::EntryHeader::kRecord,
+                                          static_cast<uint32_t>(len) };
+    g_captured.append(reinterpret_cast<const char*>(&header), sizeof header);
+    g_captured.append(record, len);
+  });
+  LOG_FMT(INFO, "decoded {} {}", 12345, string(10000, 'y'));
+  Logger::setBinaryOutput(NULL);
+  string entries = g_captured;
+  g_captured.clear();
+  Logger::setOutput(stdoutOutput);
+
+  // fed byte by byte
+  muduo::binlog::Decoder decoder;
+  string decoded;
+  for (size_t i = 0; i < entries.size(); ++i)
+  {
+    decoder.decode(&entries[i], 1, &decoded);
+  }
+  BOOST_CHECK_EQUAL(decoder.records(), 1);
+  BOOST_CHECK_EQUAL(decoder.errors(), 0);
+  // long string truncated, the rest kept
+  BOOST_CHECK(decoded.find("INFO  decoded 12345 yyyy") != string::npos);
+  BOOST_CHECK(decoded.size() < 4000);
+  BOOST_CHECK(decoded.find("y - BinaryLog_unittest.cc:") != string::npos);
+
+  // a record of undefined site
+  muduo::binlog::Decoder other;
+  muduo::binlog::EntryHeader site;
+  memcpy(&site, entries.data(), sizeof site);
+  size_t record = sizeof site + site.len;
+  other.decode(entries.data() + record, entries.size() - record, &decoded);
+  BOOST_CHECK_EQUAL(other.errors(), 1);
+}
+
+void testAsyncLogging(bool binaryFile)
+{
+  char dir[] = "/tmp/binarylog_XXXXXX";
+  BOOST_REQUIRE(::mkdtemp(dir) != NULL);
+  char cwd[1024];
+  BOOST_REQUIRE(::getcwd(cwd, sizeof cwd) != NULL);
+  BOOST_REQUIRE(::chdir(dir) == 0);
+
+  const int kLines = 10000;
+  {
+    muduo::AsyncLogging log("unittest", 1000 * 1000 * 1000, 1);
+    log.setBinaryFile(binaryFile);
+    g_async = &log;
+    Logger::setOutput(asyncOutput);
+    Logger::setBinaryOutput(asyncBinaryOutput);
+    log.start();
+    for (int i = 0; i < kLines; ++i)
+    {
+      LOG_FMT(INFO, "record {} of {}", i, "binary");
+      if (i % 100 == 0)
+      {
+        LOG_INFO << "text " << i;
+      }
+    }
+    log.stop();
+    Logger::setOutput(stdoutOutput);
+    Logger::setBinaryOutput(NULL);
+    g_async = NULL;
+  }
+  BOOST_REQUIRE(::chdir(cwd) == 0);
+
+  string logs = readLogs(dir);
+  ::rmdir(dir);
+  if (binaryFile)
+  {
+    muduo::binlog::Decoder decoder;
+    string text;
+    decoder.decode(logs.data(), logs.size(), &text);
+    BOOST_CHECK_EQUAL(decoder.records(), kLines);
+    BOOST_CHECK_EQUAL(decoder.errors(), 0);
+    logs.swap(text);
+  }
+
+  int records = 0;
+  int texts = 0;
+  bool inOrder = true;
+  size_t start = 0;
+  while (start < logs.size())
+  {
+    size_t eol = logs.find('\n', start);
+    BOOST_REQUIRE(eol != string::npos);
+    string line = logs.substr(start, eol - start);
+    int n = -1;
+    size_t info = line.find("INFO  ");
+    BOOST_REQUIRE(info != string::npos);
+    if (sscanf(line.c_str() + info, "INFO  record %d of binary - ", &n) == 1)
+    {
+      inOrder = inOrder && n == records;
+      ++records;
+    }
+    else if (sscanf(line.c_str() + info, "INFO  text %d - ", &n) == 1)
+    {
+      inOrder = inOrder && n == texts * 100;
+      ++texts;
+    }
+    start = eol + 1;
+  }
+  BOOST_CHECK(inOrder);
+  BOOST_CHECK_EQUAL(records, kLines);
+  BOOST_CHECK_EQUAL(texts, kLines / 100);
+}
+
+BOOST_AUTO_TEST_CASE(testAsyncLoggingDeferred)
+{
+  testAsyncLogging(false);
+}
+
+BOOST_AUTO_TEST_CASE(testAsyncLoggingBinaryFile)
+{
+  testAsyncLogging(true);
+}
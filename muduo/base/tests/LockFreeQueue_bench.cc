@@ -0,0 +1,106 @@
+#include <muduo/base/LockFreeQueue.h>
+#include <muduo/base/BlockingQueue.h>
+#include <muduo/base/BoundedBlockingQueue.h>
+#include <muduo/base/Thread.h>
+#include <muduo/base/Timestamp.h>
+
+#include <algorithm>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+using muduo::Timestamp;
+
+// same shape as BlockingQueue_bench, timestamps passed from producers
+// to consumers, measures throughput and latency of a hand-off.
+
+template<typename Queue>
+struct Adapter
+{
+  explicit Adapter(int capacity) : queue(capacity) { }
+  void put(const Timestamp& t) { queue.put(t); }
+  Timestamp take() { return queue.take(); }
+  Queue queue;
+};
+
+template<>
+struct Adapter<muduo::BlockingQueue<Timestamp>>
+{
+  explicit Adapter(int) { }
+  void put(const Timestamp& t) { queue.put(t); }
+  Timestamp take() { return queue.take(); }
+  muduo::BlockingQueue<Timestamp> queue;
+};
+
+template<typename Queue>
+void bench(const char* name, int producers, int consumers, int count)
+{
+  Adapter<Queue> queue(1024);
+  std::vector<std::vector<int>> latencies(consumers);
+  std::vector<std::unique_ptr<muduo::Thread>> threads;
+  const int total = producers * count;
+  for (int c = 0; c < consumers; ++c)
+  {
+    int share = total / consumers + (c < total % consumers ? 1 : 0);
+    std::vector<int>* latency = &latencies[c];
+    threads.emplace_back(new muduo::Thread([&queue, latency, share] {
+      latency->reserve(share);
+      for (int i = 0; i < share; ++i)
+      {
+        Timestamp t(queue.take());
+        latency->push_back(static_cast<int>(
+              timeDifference(Timestamp::now(), t) * 1000 * 1000));
+      }
+    }));
+  }
+  for (int p = 0; p < producers; ++p)
+  {
+    threads.emplace_back(new muduo::Thread([&queue, count] {
+      for (int i = 0; i < count; ++i)
+      {
+        queue.put(Timestamp::now());
+      }
+    }));
+  }
+
+  Timestamp start(Timestamp::now());
+  for (auto& thr : threads)
+  {
+    thr->start();
+  }
+  for (auto& thr : threads)
+  {
+    thr->join();
+  }
+  double seconds = timeDifference(Timestamp::now(), start);
+
+  std::vector<int> all;
+  for (const auto& latency : latencies)
+  {
+    all.insert(all.end(), latency.begin(), latency.end());
+  }
+  std::sort(all.begin(), all.end());
+  printf("%-22s %dP%dC %10.0f items/s latency us p50 %5d p99 %6d\n",
+         name, producers, consumers, total / seconds,
+         all[all.size() / 2], all[all.size() * 99 / 100]);
+}
+
+int main(int argc, char* argv[])
+{
+  int count = argc > 1 ? atoi(argv[1]) : 1000 * 1000;
+
+  bench<muduo::BlockingQueue<Timestamp>>("BlockingQueue", 1, 1, count);
+  bench<muduo::BoundedBlockingQueue<Timestamp>>("BoundedBlockingQueue", 1, 1, count);
+  bench<muduo::SpscQueue<Timestamp>>("SpscQueue", 1, 1, count);
+  bench<muduo::MpscQueue<Timestamp>>("MpscQueue", 1, 1, count);
+  bench<muduo::MpmcQueue<Timestamp>>("MpmcQueue", 1, 1, count);
+
+  bench<muduo::BlockingQueue<Timestamp>>("BlockingQueue", 4, 1, count / 4);
+  bench<muduo::BoundedBlockingQueue<Timestamp>>("BoundedBlockingQueue", 4, 1, count / 4);
+  bench<muduo::MpscQueue<Timestamp>>("MpscQueue", 4, 1, count / 4);
+  bench<muduo::MpmcQueue<Timestamp>>("MpmcQueue", 4, 1, count / 4);
+
+  bench<muduo::BlockingQueue<Timestamp>>("BlockingQueue", 4, 4, count / 4);
+  bench<muduo::BoundedBlockingQueue<Timestamp>>("BoundedBlockingQueue", 4, 4, count / 4);
+  bench<muduo::MpmcQueue<Timestamp>>("MpmcQueue", 4, 4, count / 4);
+}
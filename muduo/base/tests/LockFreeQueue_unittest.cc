@@ -0,0 +1,120 @@
+#include <muduo/base/LockFreeQueue.h>
+#include <muduo/base/Thread.h>
+
+#include <atomic>
+#include <vector>
+
+//#define BOOST_TEST_MODULE LockFreeQueueTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using muduo::string;
+
+BOOST_AUTO_TEST_CASE(testLockFreeQueueTryPutTake)
+{
+  muduo::MpmcQueue<string> queue(3);
+  BOOST_CHECK_EQUAL(queue.capacity(), 4);
+  BOOST_CHECK(queue.empty());
+
+  string x;
+  BOOST_CHECK(!queue.tryTake(&x));
+  for (int i = 0; i < 4; ++i)
+  {
+    BOOST_CHECK(queue.tryPut(string(100, static_cast<char>('a' + i))));
+  }
+  BOOST_CHECK(queue.full());
+  string extra("extra");
+  BOOST_CHECK(!queue.tryPut(std::move(extra)));
+  BOOST_CHECK_EQUAL(extra, "extra");
+
+  BOOST_CHECK(queue.tryTake(&x));
+  BOOST_CHECK_EQUAL(x, string(100, 'a'));
+  BOOST_CHECK_EQUAL(queue.size(), 3);
+  BOOST_CHECK(queue.tryPut(extra));
+  BOOST_CHECK_EQUAL(queue.take(), string(100, 'b'));
+  // the rest are freed by the destructor
+}
+
+BOOST_AUTO_TEST_CASE(testLockFreeRing)
+{
+  // tryPut() and tryTake() only, never waking
+  muduo::MpmcRing<int> ring(2);
+  BOOST_CHECK(ring.tryPut(1));
+  BOOST_CHECK(ring.tryPut(2));
+  BOOST_CHECK(!ring.tryPut(3));
+  int x = 0;
+  BOOST_CHECK(ring.tryTake(&x));
+  BOOST_CHECK_EQUAL(x, 1);
+  BOOST_CHECK(ring.tryTake(&x));
+  BOOST_CHECK_EQUAL(x, 2);
+  BOOST_CHECK(!ring.tryTake(&x));
+}
+
+BOOST_AUTO_TEST_CASE(testSpscQueueKeepsOrder)
+{
+  const int kCount = 200000;
+  muduo::SpscQueue<int> queue(16);
+  muduo::Thread producer([&] {
+    for (int i = 0; i < kCount; ++i)
+    {
+      queue.put(i);
+    }
+  });
+  producer.start();
+  bool inOrder = true;
+  for (int i = 0; i < kCount; ++i)
+  {
+    inOrder = queue.take() == i && inOrder;
+  }
+  producer.join();
+  BOOST_CHECK(inOrder);
+  BOOST_CHECK(queue.empty());
+}
+
+template<typename Queue>
+void testBlocking(int producers, int consumers)
+{
+  const int kCount = 50000;
+  // small enough for both sides to sleep
+  Queue queue(4);
+  std::atomic<int64_t> sum(0);
+  std::vector<std::unique_ptr<muduo::Thread>> threads;
+  for (int p = 0; p < producers; ++p)
+  {
+    threads.emplace_back(new muduo::Thread([&] {
+      for (int i = 1; i <= kCount; ++i)
+      {
+        queue.put(i);
+      }
+    }));
+  }
+  const int total = producers * kCount;
+  for (int c = 0; c < consumers; ++c)
+  {
+    int share = total / consumers + (c < total % consumers ? 1 : 0);
+    threads.emplace_back(new muduo::Thread([&queue, &sum, share] {
+      for (int i = 0; i < share; ++i)
+      {
+        sum.fetch_add(queue.take());
+      }
+    }));
+  }
+  for (auto& thr : threads)
+  {
+    thr->start();
+  }
+  for (auto& thr : threads)
+  {
+    thr->join();
+  }
+  BOOST_CHECK_EQUAL(sum.load(), static_cast<int64_t>(producers) * kCount * (kCount + 1) / 2);
+  BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(testLockFreeQueueBlocking)
+{
+  testBlocking<muduo::MpmcQueue<int>>(3, 3);
+  testBlocking<muduo::MpscQueue<int>>(4, 1);
+  testBlocking<muduo::SpscQueue<int>>(1, 1);
+}
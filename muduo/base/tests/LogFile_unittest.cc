@@ -0,0 +1,143 @@
+#include <muduo/base/LogFile.h>
+#include <muduo/base/LogCompressor.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//#define BOOST_TEST_MODULE LogFileTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using muduo::string;
+
+namespace
+{
+struct TempDir
+{
+  TempDir()
+  {
+    strcpy(dir, "/tmp/logfile_XXXXXX");
+    BOOST_REQUIRE(::mkdtemp(dir) != NULL);
+    BOOST_REQUIRE(::getcwd(cwd, sizeof cwd) != NULL);
+    BOOST_REQUIRE(::chdir(dir) == 0);
+  }
+
+  ~TempDir()
+  {
+    BOOST_CHECK(::chdir(cwd) == 0);
+    for (const string& name : files())
+    {
+      ::unlink((string(dir) + "/" + name).c_str());
+    }
+    ::rmdir(dir);
+  }
+
+  std::vector<string> files() const
+  {
+    std::vector<string> names;
+    DIR* d = ::opendir(dir);
+    while (struct dirent* entry = ::readdir(d))
+    {
+      if (entry->d_name[0] != '.')
+      {
+        names.push_back(entry->d_name);
+      }
+    }
+    ::closedir(d);
+    std::sort(names.begin(), names.end());
+    return names;
+  }
+
+  char dir[32];
+  char cwd[1024];
+};
+
+struct stat statOf(const string& name)
+{
+  struct stat st;
+  memset(&st, 0, sizeof st);
+  ::stat(name.c_str(), &st);
+  return st;
+}
+}
+
+BOOST_AUTO_TEST_CASE(testPreallocateKeepsSize)
+{
+  TempDir tmp;
+  const string line(100, 'x');
+  {
+    muduo::LogFile file("prealloc", 1000 * 1000 * 1000, false);
+    file.setPreallocate(4 * 1024 * 1024);
+    file.setBytesPerSync(64 * 1024);
+    for (int i = 0; i < 10000; ++i)
+    {
+      file.append(line.data(), static_cast<int>(line.size()));
+    }
+    file.flush();
+    std::vector<string> names = tmp.files();
+    BOOST_REQUIRE_EQUAL(names.size(), 1u);
+    struct stat st = statOf(names[0]);
+    // readers see what's written only
+    BOOST_CHECK_EQUAL(st.st_size, 10000 * 100);
+  }
+  std::vector<string> names = tmp.files();
+  BOOST_REQUIRE_EQUAL(names.size(), 1u);
+  struct stat st = statOf(names[0]);
+  BOOST_CHECK_EQUAL(st.st_size, 10000 * 100);
+  // released when closed
+  BOOST_CHECK_LT(st.st_blocks * 512, 2 * 1024 * 1024);
+}
+
+BOOST_AUTO_TEST_CASE(testRollCompressed)
+{
+  TempDir tmp;
+  const string line("rolled away\n");
+  {
+    muduo::LogCompressor compressor;
+    muduo::LogFile file("roll", 1000 * 1000 * 1000, true);
+    std::vector<string> rolled;
+    file.setRollCallback([&](const string& filename) {
+      rolled.push_back(filename);
+      compressor.compress(filename);
+    });
+    file.append(line.data(), static_cast<int>(line.size()));
+    // no new file in the same second
+    ::sleep(1);
+    BOOST_CHECK(file.rollFile());
+    file.append(line.data(), static_cast<int>(line.size()));
+    BOOST_CHECK_EQUAL(rolled.size(), 1u);
+  }
+
+  std::vector<string> names = tmp.files();
+  BOOST_REQUIRE_EQUAL(names.size(), 2u);
+  // roll.<time>.<host>.<pid>.log and its older sibling, gzipped
+  const string& gz = names[0];
+  BOOST_CHECK_EQUAL(gz.substr(gz.size() - 7), ".log.gz");
+  BOOST_CHECK_EQUAL(names[1].substr(names[1].size() - 4), ".log");
+
+  muduo::GzipFile in = muduo::GzipFile::openForRead(gz);
+  BOOST_REQUIRE(in.valid());
+  char buf[256];
+  int n = in.read(buf, sizeof buf);
+  BOOST_CHECK_EQUAL(string(buf, n > 0 ? n : 0), line);
+}
+
+BOOST_AUTO_TEST_CASE(testGzipCloseFails)
+{
+  // what's buffered is written when closed, to a full disk here
+  muduo::GzipFile out = muduo::GzipFile::openForWriteTruncate("/dev/full");
+  if (out.valid())
+  {
+    const string line("lost unless it fails\n");
+    BOOST_CHECK_EQUAL(out.write(line), static_cast<int>(line.size()));
+    BOOST_CHECK(!out.close());
+    BOOST_CHECK(!out.valid());
+  }
+}
@@ -1,7 +1,9 @@
 #include <muduo/base/LogStream.h>
 #include <muduo/base/Timestamp.h>
 
+#include <random>
 #include <sstream>
+#include <vector>
 #include <stdio.h>
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
@@ -55,6 +57,46 @@ void benchLogStream()
   printf("benchLogStream %f\n", timeDifference(end, start));
 }
 
+// per call, values of all lengths rather than 0..N
+template<typename T>
+void benchPerCall(const char* name, const std::vector<T>& values, const char* fmt)
+{
+  char buf[32];
+  Timestamp start(Timestamp::now());
+  for (size_t i = 0; i < values.size(); ++i)
+    snprintf(buf, sizeof buf, fmt, values[i]);
+  double printfSeconds = timeDifference(Timestamp::now(), start);
+
+  LogStream os;
+  start = Timestamp::now();
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    os << values[i];
+    os.resetBuffer();
+  }
+  double logStreamSeconds = timeDifference(Timestamp::now(), start);
+
+  printf("%-8s snprintf %6.1f ns/call  LogStream %6.1f ns/call\n", name,
+         printfSeconds * 1e9 / static_cast<double>(values.size()),
+         logStreamSeconds * 1e9 / static_cast<double>(values.size()));
+}
+
+void benchPerCall()
+{
+  std::mt19937_64 rng(1);
+  std::vector<int64_t> ints(N);
+  std::vector<double> doubles(N);
+  std::uniform_real_distribution<double> latency(0, 1000);
+  for (size_t i = 0; i < N; ++i)
+  {
+    ints[i] = static_cast<int64_t>(rng() >> (i % 64));
+    doubles[i] = latency(rng);
+  }
+  puts("per call");
+  benchPerCall("int64_t", ints, "%" PRId64);
+  benchPerCall("double", doubles, "%.12g");
+}
+
 int main()
 {
   benchPrintf<int>("%d");
@@ -79,4 +121,5 @@ int main()
   benchStringStream<void*>();
   benchLogStream<void*>();
 
+  benchPerCall();
 }
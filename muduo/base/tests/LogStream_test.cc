@@ -1,7 +1,12 @@
 #include <muduo/base/LogStream.h>
 
 #include <limits>
+#include <random>
+#include <inttypes.h>
+#include <math.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 
 //#define BOOST_TEST_MODULE LogStreamTest
 #define BOOST_TEST_MAIN
@@ -169,6 +174,76 @@ BOOST_AUTO_TEST_CASE(testLogStreamFloats)
   os.resetBuffer();
 }
 
+BOOST_AUTO_TEST_CASE(testLogStreamFloatsLikePrintf)
+{
+  muduo::LogStream os;
+  const muduo::LogStream::Buffer& buf = os.buffer();
+  std::mt19937_64 rng(20);
+  std::uniform_real_distribution<double> exponent(-8, 18);
+  std::uniform_int_distribution<int> digits(1, 17);
+  int mismatches = 0;
+  for (int i = 0; i < 1000 * 1000; ++i)
+  {
+    double v = 0;
+    if (i % 2 == 0)
+    {
+      // any bits
+      uint64_t bits = rng();
+      memcpy(&v, &bits, sizeof v);
+    }
+    else
+    {
+      // short decimals, boundaries of exponents and rounding
+      char text[64];
+      snprintf(text, sizeof text, "%.*e", digits(rng),
+               (i % 4 == 1 ? 1 : -1) * pow(10, exponent(rng)));
+      v = strtod(text, NULL);
+    }
+    char expected[64];
+    snprintf(expected, sizeof expected, "%.12g", v);
+    os.resetBuffer();
+    os << v;
+    if (buf.toString() != expected && ++mismatches < 10)
+    {
+      BOOST_CHECK_EQUAL(buf.toString(), string(expected));
+    }
+  }
+  BOOST_CHECK_EQUAL(mismatches, 0);
+
+  const double edges[] = { 1e-5, 9.99999999999e-6, 0.000099999999999951, 999999999999.5,
+                           999999999999.4, 1e15, 999999999999999.9, 123456789012.5,
+                           -0.0, 0.5, 1e12, -1e-4 };
+  for (double v : edges)
+  {
+    char expected[64];
+    snprintf(expected, sizeof expected, "%.12g", v);
+    os.resetBuffer();
+    os << v;
+    BOOST_CHECK_EQUAL(buf.toString(), string(expected));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testLogStreamIntegersLikePrintf)
+{
+  muduo::LogStream os;
+  const muduo::LogStream::Buffer& buf = os.buffer();
+  std::mt19937_64 rng(20);
+  for (int i = 0; i < 100000; ++i)
+  {
+    // all lengths, both signs
+    int64_t v = static_cast<int64_t>(rng() >> (i % 64 + 1));
+    char expected[32];
+    snprintf(expected, sizeof expected, "%" PRId64, v);
+    os.resetBuffer();
+    os << v;
+    BOOST_CHECK_EQUAL(buf.toString(), string(expected));
+    snprintf(expected, sizeof expected, "%" PRId64, -v);
+    os.resetBuffer();
+    os << -v;
+    BOOST_CHECK_EQUAL(buf.toString(), string(expected));
+  }
+}
+
 BOOST_AUTO_TEST_CASE(testLogStreamVoid)
 {
   muduo::LogStream os;
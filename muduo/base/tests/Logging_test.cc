@@ -1,3 +1,4 @@
+#include <muduo/base/BinaryLog.h>
 #include <muduo/base/Logging.h>
 #include <muduo/base/LogFile.h>
 #include <muduo/base/ThreadPool.h>
@@ -46,6 +47,30 @@ void bench(const char* type)
          type, seconds, g_total, n / seconds, g_total / seconds / (1024 * 1024));
 }
 
+void dummyBinaryOutput(const char* record, int len)
+{
+  g_total += len;
+}
+
+// same line as bench(), formatting deferred
+void benchBinary(const char* type)
+{
+  muduo::Logger::setBinaryOutput(dummyBinaryOutput);
+  muduo::Timestamp start(muduo::Timestamp::now());
+  g_total = 0;
+
+  int n = 1000*1000;
+  for (int i = 0; i < n; ++i)
+  {
+    LOG_FMT(INFO, "Hello 0123456789 abcdefghijklmnopqrstuvwxyz {}", i);
+  }
+  muduo::Timestamp end(muduo::Timestamp::now());
+  double seconds = timeDifference(end, start);
+  printf("%12s: %f seconds, %d bytes, %10.2f msg/s, %.2f MiB/s\n",
+         type, seconds, g_total, n / seconds, g_total / seconds / (1024 * 1024));
+  muduo::Logger::setBinaryOutput(NULL);
+}
+
 void logInThread()
 {
   LOG_INFO << "logInThread";
@@ -76,6 +101,7 @@ int main()
 
   sleep(1);
   bench("nop");
+  benchBinary("binary nop");
 
   char buffer[64*1024];
 
@@ -0,0 +1,193 @@
+#include <muduo/base/ThreadPool.h>
+#include <muduo/base/BlockingQueue.h>
+#include <muduo/base/BoundedBlockingQueue.h>
+#include <muduo/base/CountDownLatch.h>
+#include <muduo/base/Thread.h>
+#include <muduo/base/Timestamp.h>
+
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+
+using muduo::CountDownLatch;
+using muduo::Timestamp;
+
+typedef std::function<void ()> Task;
+
+// What ThreadPool was before work stealing, one deque under one mutex.
+class SingleQueuePool : muduo::noncopyable
+{
+ public:
+  static const char* name() { return "single queue"; }
+
+  explicit SingleQueuePool(int maxQueueSize)
+    : maxQueueSize_(maxQueueSize),
+      bounded_(maxQueueSize > 0 ? maxQueueSize : 1)
+  {
+  }
+
+  void start(int numThreads)
+  {
+    for (int i = 0; i < numThreads; ++i)
+    {
+      threads_.emplace_back(new muduo::Thread(
+            std::bind(&SingleQueuePool::runInThread, this), "SingleQueuePool"));
+      threads_.back()->start();
+    }
+  }
+
+  void stop()
+  {
+    for (size_t i = 0; i < threads_.size(); ++i)
+    {
+      run(Task());
+    }
+    for (auto& thr : threads_)
+    {
+      thr->join();
+    }
+  }
+
+  void run(Task task)
+  {
+    if (maxQueueSize_ > 0)
+      bounded_.put(std::move(task));
+    else
+      unbounded_.put(std::move(task));
+  }
+
+ private:
+  void runInThread()
+  {
+    for (;;)
+    {
+      Task task(maxQueueSize_ > 0 ? bounded_.take() : unbounded_.take());
+      if (!task)
+        break;
+      task();
+    }
+  }
+
+  int maxQueueSize_;
+  muduo::BlockingQueue<Task> unbounded_;
+  muduo::BoundedBlockingQueue<Task> bounded_;
+  std::vector<std::unique_ptr<muduo::Thread>> threads_;
+};
+
+class WorkStealingPool : public muduo::ThreadPool
+{
+ public:
+  static const char* name() { return "work stealing"; }
+
+  explicit WorkStealingPool(int maxQueueSize)
+    : muduo::ThreadPool("WorkStealingPool")
+  {
+    setMaxQueueSize(maxQueueSize);
+  }
+};
+
+std::atomic<int64_t> g_sink(0);
+
+// rounds=300 is about 1us, like a small request handler
+void burn(int64_t seed, int rounds)
+{
+  uint64_t x = seed;
+  for (int i = 0; i < rounds; ++i)
+  {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    x ^= x >> 17;
+  }
+  g_sink.fetch_add(static_cast<int64_t>(x), std::memory_order_relaxed);
+}
+
+// producers outside of the pool, like IO threads handing requests off
+template<typename Pool>
+void benchSubmit(int threads, int producers, int tasks, int rounds, int maxQueueSize)
+{
+  Pool pool(maxQueueSize);
+  pool.start(threads);
+  CountDownLatch done(tasks * producers);
+  Timestamp start(Timestamp::now());
+  std::vector<std::unique_ptr<muduo::Thread>> submitters;
+  for (int p = 0; p < producers; ++p)
+  {
+    submitters.emplace_back(new muduo::Thread([&pool, &done, tasks, rounds] {
+      for (int i = 0; i < tasks; ++i)
+      {
+        pool.run([&done, rounds, i] {
+          burn(i, rounds);
+          done.countDown();
+        });
+      }
+    }));
+    submitters.back()->start();
+  }
+  done.wait();
+  double seconds = timeDifference(Timestamp::now(), start);
+  for (auto& thr : submitters)
+  {
+    thr->join();
+  }
+  pool.stop();
+  printf("submit    %-14s threads %2d producers %d rounds %3d max %4d: %9.0f tasks/s\n",
+         Pool::name(), threads, producers, rounds, maxQueueSize,
+         tasks * producers / seconds);
+}
+
+// tasks spawning tasks, like a divide and conquer solver
+template<typename Pool>
+void forkJoin(Pool* pool, int depth, int rounds, CountDownLatch* done)
+{
+  burn(depth, rounds);
+  if (depth > 0)
+  {
+    pool->run(std::bind(forkJoin<Pool>, pool, depth - 1, rounds, done));
+    pool->run(std::bind(forkJoin<Pool>, pool, depth - 1, rounds, done));
+  }
+  done->countDown();
+}
+
+template<typename Pool>
+void benchForkJoin(int threads, int depth, int rounds)
+{
+  const int tasks = (1 << (depth + 1)) - 1;
+  Pool pool(0);
+  pool.start(threads);
+  CountDownLatch done(tasks);
+  Timestamp start(Timestamp::now());
+  pool.run(std::bind(forkJoin<Pool>, &pool, depth, rounds, &done));
+  done.wait();
+  double seconds = timeDifference(Timestamp::now(), start);
+  pool.stop();
+  printf("fork-join %-14s threads %2d depth %2d     rounds %3d:          %9.0f tasks/s\n",
+         Pool::name(), threads, depth, rounds, tasks / seconds);
+}
+
+int main(int argc, char* argv[])
+{
+  int threads = argc > 1 ? atoi(argv[1]) : 4;
+  int tasks = argc > 2 ? atoi(argv[2]) : 400 * 1000;
+
+  const int kRounds[] = { 0, 300 };
+  const int kProducers[] = { 1, 4 };
+  const int kMaxQueueSizes[] = { 0, 1024 };
+  for (int rounds : kRounds)
+  {
+    for (int producers : kProducers)
+    {
+      for (int maxQueueSize : kMaxQueueSizes)
+      {
+        benchSubmit<WorkStealingPool>(threads, producers, tasks / producers,
+                                      rounds, maxQueueSize);
+        benchSubmit<SingleQueuePool>(threads, producers, tasks / producers,
+                                     rounds, maxQueueSize);
+      }
+    }
+  }
+  for (int rounds : kRounds)
+  {
+    benchForkJoin<WorkStealingPool>(threads, 17, rounds);
+    benchForkJoin<SingleQueuePool>(threads, 17, rounds);
+  }
+  return static_cast<int>(g_sink.load() & 0);
+}
@@ -0,0 +1,122 @@
+#include <muduo/base/ThreadPool.h>
+#include <muduo/base/CountDownLatch.h>
+#include <muduo/base/Thread.h>
+
+#include <atomic>
+#include <unistd.h>
+
+//#define BOOST_TEST_MODULE ThreadPoolTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using muduo::CountDownLatch;
+using muduo::ThreadPool;
+
+namespace
+{
+void spawn(ThreadPool* pool, int depth, std::atomic<int>* count, CountDownLatch* done)
+{
+  count->fetch_add(1);
+  if (depth > 0)
+  {
+    pool->run(std::bind(spawn, pool, depth - 1, count, done));
+    pool->run(std::bind(spawn, pool, depth - 1, count, done));
+  }
+  done->countDown();
+}
+}
+
+BOOST_AUTO_TEST_CASE(testThreadPoolRunsEachTaskOnce)
+{
+  const int kProducers = 4;
+  const int kTasks = 20000;
+  ThreadPool pool("TestPool");
+  pool.start(4);
+
+  std::atomic<int> count(0);
+  CountDownLatch done(kProducers * kTasks);
+  std::vector<std::unique_ptr<muduo::Thread>> producers;
+  for (int p = 0; p < kProducers; ++p)
+  {
+    producers.emplace_back(new muduo::Thread([&] {
+      for (int i = 0; i < kTasks; ++i)
+      {
+        pool.run([&] { count.fetch_add(1); done.countDown(); });
+      }
+    }));
+    producers.back()->start();
+  }
+  done.wait();
+  for (auto& thr : producers)
+  {
+    thr->join();
+  }
+  BOOST_CHECK_EQUAL(count.load(), kProducers * kTasks);
+  BOOST_CHECK_EQUAL(pool.queueSize(), 0);
+  pool.stop();
+}
+
+BOOST_AUTO_TEST_CASE(testThreadPoolTasksSpawningTasks)
+{
+  const int kDepth = 14;
+  const int kTasks = (1 << (kDepth + 1)) - 1;
+  ThreadPool pool("TestPool");
+  pool.setMaxQueueSize(4);  // doesn't apply to workers
+  pool.start(3);
+
+  std::atomic<int> count(0);
+  CountDownLatch done(kTasks);
+  pool.run(std::bind(spawn, &pool, kDepth, &count, &done));
+  done.wait();
+  BOOST_CHECK_EQUAL(count.load(), kTasks);
+  pool.stop();
+}
+
+BOOST_AUTO_TEST_CASE(testThreadPoolMaxQueueSize)
+{
+  const size_t kMaxQueueSize = 5;
+  ThreadPool pool("TestPool");
+  pool.setMaxQueueSize(kMaxQueueSize);
+  pool.start(2);
+
+  std::atomic<int> count(0);
+  size_t maxSeen = 0;
+  for (int i = 0; i < 200; ++i)
+  {
+    pool.run([&] { ::usleep(100); count.fetch_add(1); });
+    maxSeen = std::max(maxSeen, pool.queueSize());
+  }
+  BOOST_CHECK_LE(maxSeen, kMaxQueueSize);
+
+  CountDownLatch done(1);
+  pool.run([&] { done.countDown(); });
+  done.wait();
+  pool.stop();
+  BOOST_CHECK_GE(count.load(), 200 - static_cast<int>(kMaxQueueSize));
+}
+
+BOOST_AUTO_TEST_CASE(testThreadPoolStopDropsWaitingTasks)
+{
+  ThreadPool pool("TestPool");
+  pool.start(1);
+  CountDownLatch started(1);
+  std::atomic<int> count(0);
+  pool.run([&] { started.countDown(); ::usleep(50 * 1000); });
+  started.wait();
+  for (int i = 0; i < 10; ++i)
+  {
+    pool.run([&] { count.fetch_add(1); });
+  }
+  pool.stop();
+  BOOST_CHECK_EQUAL(count.load(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testThreadPoolWithoutThreads)
+{
+  ThreadPool pool("TestPool");
+  pool.start(0);
+  int count = 0;
+  pool.run([&] { ++count; });
+  BOOST_CHECK_EQUAL(count, 1);
+}
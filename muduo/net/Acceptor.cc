@@ -13,6 +13,8 @@
 #include <muduo/net/InetAddress.h>
 #include <muduo/net/SocketsOps.h>
 
+#include <algorithm>
+
 #include <errno.h>
 #include <fcntl.h>
 //#include <sys/types.h>
@@ -22,12 +24,26 @@
 using namespace muduo;
 using namespace muduo::net;
 
+namespace
+{
+const int kDefaultMaxAcceptsPerRead = 16;
+}
+
 Acceptor::Acceptor(EventLoop* loop, const InetAddress& listenAddr, bool reuseport)
   : loop_(loop),
     acceptSocket_(sockets::createNonblockingOrDie(listenAddr.family())),
     acceptChannel_(loop, acceptSocket_.fd()),
     listenning_(false),
-    idleFd_(::open("/dev/null", O_RDONLY | O_CLOEXEC))
+    idleFd_(::open("/dev/null", O_RDONLY | O_CLOEXEC)),
+    maxAcceptsPerRead_(kDefaultMaxAcceptsPerRead),
+    ratePerSecond_(0),
+    burst_(0),
+    tokens_(0),
+    paused_(false),
+    wakeups_(0),
+    accepted_(0),
+    throttled_(0),
+    failures_(0)
 {
   assert(idleFd_ >= 0);
   acceptSocket_.setReuseAddr(true);
@@ -39,11 +55,29 @@ Acceptor::Acceptor(EventLoop* loop, const InetAddress& listenAddr, bool reusepor
 
 Acceptor::~Acceptor()
 {
+  if (paused_)
+  {
+    loop_->cancel(resumeTimer_);
+  }
   acceptChannel_.disableAll();
   acceptChannel_.remove();
   ::close(idleFd_);
 }
 
+void Acceptor::setRateLimit(double perSecond, int burst)
+{
+  assert(!listenning_);
+  ratePerSecond_ = perSecond;
+  burst_ = std::max(burst, 1);
+  tokens_ = burst_;
+  lastRefill_ = Timestamp::now();
+}
+
+InetAddress Acceptor::listenAddress() const
+{
+  return InetAddress(sockets::getLocalAddr(acceptSocket_.fd()));
+}
+
 void Acceptor::listen()
 {
   loop_->assertInLoopThread();
@@ -56,36 +90,81 @@ void Acceptor::listen()
 void Acceptor::handleRead()
 {
   loop_->assertInLoopThread();
-  //对方的地址
-  InetAddress peerAddr;
-  //FIXME loop until no more
-  int connfd = acceptSocket_.accept(&peerAddr);
-  if (connfd >= 0)
+  increase(&wakeups_);
+  Timestamp now = ratePerSecond_ > 0 ? Timestamp::now() : Timestamp();
+  // drains the backlog, saves a poll(2) for each connection
+  for (int i = 0; i < maxAcceptsPerRead_; ++i)
   {
-    // string hostport = peerAddr.toIpPort();
-    // LOG_TRACE << "Accepts of " << hostport;
-    if (newConnectionCallback_)
+    if (ratePerSecond_ > 0 && !admit(now))
     {
-      newConnectionCallback_(connfd, peerAddr);
+      pause();
+      break;
+    }
+    //对方的地址
+    InetAddress peerAddr;
+    int connfd = acceptSocket_.accept(&peerAddr);
+    if (connfd >= 0)
+    {
+      // string hostport = peerAddr.toIpPort();
+      // LOG_TRACE << "Accepts of " << hostport;
+      increase(&accepted_);
+      tokens_ -= 1;
+      if (newConnectionCallback_)
+      {
+        newConnectionCallback_(connfd, peerAddr);
+      }
+      else
+      {
+        sockets::close(connfd);
+      }
     }
     else
     {
-      sockets::close(connfd);
+      if (errno == EAGAIN)
+      {
+        break;
+      }
+      increase(&failures_);
+      LOG_SYSERR << "in Acceptor::handleRead";
+      // Read the section named "The special problem of
+      // accept()ing when you can't" in libev's doc.
+      // By Marc Lehmann, author of libev.
+      if (errno == EMFILE)
+      {
+        ::close(idleFd_);
+        idleFd_ = ::accept(acceptSocket_.fd(), NULL, NULL);
+        ::close(idleFd_);
+        idleFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+      }
+      break;
     }
   }
-  else
+}
+
+// token bucket
+bool Acceptor::admit(Timestamp now)
+{
+  double elapsed = timeDifference(now, lastRefill_);
+  if (elapsed > 0)
   {
-    LOG_SYSERR << "in Acceptor::handleRead";
-    // Read the section named "The special problem of
-    // accept()ing when you can't" in libev's doc.
-    // By Marc Lehmann, author of libev.
-    if (errno == EMFILE)
-    {
-      ::close(idleFd_);
-      idleFd_ = ::accept(acceptSocket_.fd(), NULL, NULL);
-      ::close(idleFd_);
-      idleFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
-    }
+    tokens_ = std::min(burst_, tokens_ + elapsed * ratePerSecond_);
+    lastRefill_ = now;
   }
+  return tokens_ >= 1;
 }
 
+void Acceptor::pause()
+{
+  // the listening socket stays readable, stop polling it until next token
+  increase(&throttled_);
+  paused_ = true;
+  acceptChannel_.disableReading();
+  double delay = (1 - tokens_) / ratePerSecond_;
+  resumeTimer_ = loop_->runAfter(delay, std::bind(&Acceptor::resume, this));
+}
+
+void Acceptor::resume()
+{
+  paused_ = false;
+  acceptChannel_.enableReading();
+}
@@ -11,10 +11,12 @@
 #ifndef MUDUO_NET_ACCEPTOR_H
 #define MUDUO_NET_ACCEPTOR_H
 
+#include <atomic>
 #include <functional>
 
 #include <muduo/net/Channel.h>
 #include <muduo/net/Socket.h>
+#include <muduo/net/TimerId.h>
 
 namespace muduo
 {
@@ -38,11 +40,46 @@ class Acceptor : noncopyable
   void setNewConnectionCallback(const NewConnectionCallback& cb)
   { newConnectionCallback_ = cb; }
 
+  /// Accepts up to n connections per readiness, until EAGAIN.
+  /// Must be called before listen().
+  void setMaxAcceptsPerRead(int n)
+  { maxAcceptsPerRead_ = n; }
+
+  /// Admits at most perSecond connections on average, and burst at once.
+  /// When they run out, stops accepting until the next one is due,
+  /// leaving the rest in the backlog of kernel, 0 means no limit.
+  /// Must be called before listen().
+  void setRateLimit(double perSecond, int burst);
+
+  /// See Socket::setDeferAccept().
+  void setDeferAccept(int seconds)
+  { acceptSocket_.setDeferAccept(seconds); }
+
+  /// See Socket::setIncomingCpu().
+  void setIncomingCpu(int cpu)
+  { acceptSocket_.setIncomingCpu(cpu); }
+
+  // metrics, safe to read from any thread
+  int64_t wakeups() const { return wakeups_.load(std::memory_order_relaxed); }
+  int64_t accepted() const { return accepted_.load(std::memory_order_relaxed); }
+  int64_t throttled() const { return throttled_.load(std::memory_order_relaxed); }
+  int64_t failures() const { return failures_.load(std::memory_order_relaxed); }
+
+  EventLoop* loop() const { return loop_; }
   bool listenning() const { return listenning_; }
   void listen();
 
+  /// The bound address, with the actual port if bound to port 0.
+  InetAddress listenAddress() const;
+
  private:
   void handleRead();
+  // false if out of tokens
+  bool admit(Timestamp now);
+  void pause();
+  void resume();
+  static void increase(std::atomic<int64_t>* counter)
+  { counter->store(counter->load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
 
   EventLoop* loop_;
   //监听套接字
@@ -53,6 +90,18 @@ class Acceptor : noncopyable
   NewConnectionCallback newConnectionCallback_;
   bool listenning_;
   int idleFd_;
+  int maxAcceptsPerRead_;
+  double ratePerSecond_;
+  double burst_;
+  double tokens_;
+  Timestamp lastRefill_;
+  bool paused_;
+  TimerId resumeTimer_;
+  // written in loop thread only
+  std::atomic<int64_t> wakeups_;
+  std::atomic<int64_t> accepted_;
+  std::atomic<int64_t> throttled_;
+  std::atomic<int64_t> failures_;
 };
 
 }  // namespace net
@@ -81,9 +81,7 @@ class Buffer : public muduo::copyable
   //查找"\r\n"
   const char* findCRLF() const
   {
-    // FIXME: replace with memmem()?
-    const char* crlf = std::search(peek(), beginWrite(), kCRLF, kCRLF+2);
-    return crlf == beginWrite() ? NULL : crlf;
+    return findCRLF(peek());
   }
 
   //从start起始处查找\r\n
@@ -91,9 +89,9 @@ class Buffer : public muduo::copyable
   {
     assert(peek() <= start);
     assert(start <= beginWrite());
-    // FIXME: replace with memmem()?
-    const char* crlf = std::search(start, beginWrite(), kCRLF, kCRLF+2);
-    return crlf == beginWrite() ? NULL : crlf;
+    // vectorized by libc, unlike std::search
+    const void* crlf = memmem(start, beginWrite() - start, kCRLF, 2);
+    return static_cast<const char*>(crlf);
   }
 
   const char* findEOL() const
@@ -0,0 +1,112 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+
+#include <muduo/net/BufferPool.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const size_t BufferPool::kMinPooledSize;
+const size_t BufferPool::kMaxPooledSize;
+const size_t BufferPool::kDefaultMaxBytes;
+
+namespace
+{
+// floor(log2(n)), n > 0
+int floorLog2(size_t n)
+{
+  return 63 - __builtin_clzll(n);
+}
+
+int ceilLog2(size_t n)
+{
+  return n <= 1 ? 0 : floorLog2(n - 1) + 1;
+}
+}  // namespace
+
+BufferPool::BufferPool(size_t maxBytes)
+  : maxBytes_(maxBytes),
+    pooledBytes_(0)
+{
+}
+
+BufferPool::~BufferPool() = default;
+
+size_t BufferPool::numPooled() const
+{
+  size_t n = 0;
+  for (int i = 0; i < kNumClasses; ++i)
+  {
+    n += classes_[i].size();
+  }
+  return n;
+}
+
+void BufferPool::reserve(Buffer* buf, size_t len)
+{
+  if (buf->writableBytes() >= len)
+  {
+    return;
+  }
+  size_t size = len + Buffer::kCheapPrepend;
+  if (buf->readableBytes() == 0 && size >= kMinPooledSize && size <= kMaxPooledSize)
+  {
+    // the last one of the same class might be large enough,
+    // any one of the next class is
+    int c = floorLog2(size);
+    if (classes_[c].empty() || classes_[c].back().internalCapacity() < size)
+    {
+      c = ceilLog2(size);
+    }
+    if (c < kNumClasses && !classes_[c].empty())
+    {
+      Buffer old(0);
+      old.swap(*buf);
+      buf->swap(classes_[c].back());
+      classes_[c].pop_back();
+      pooledBytes_ -= buf->internalCapacity();
+      // the old one might be worth keeping too
+      recycle(&old);
+      assert(buf->writableBytes() >= len);
+      return;
+    }
+  }
+  buf->ensureWritableBytes(len);
+}
+
+void BufferPool::shrink(Buffer* buf)
+{
+  size_t readable = buf->readableBytes();
+  if (buf->internalCapacity() < kMinPooledSize)
+  {
+    return;
+  }
+  Buffer small(std::max(readable, Buffer::kInitialSize));
+  small.append(buf->peek(), readable);
+  small.swap(*buf);
+  recycle(&small);
+}
+
+void BufferPool::recycle(Buffer* buf)
+{
+  size_t capacity = buf->internalCapacity();
+  if (capacity < kMinPooledSize
+      || capacity > kMaxPooledSize
+      || pooledBytes_ + capacity > maxBytes_)
+  {
+    Buffer(0).swap(*buf);
+    return;
+  }
+  buf->retrieveAll();
+  // make all of the capacity writable, only once for each storage
+  buf->ensureWritableBytes(capacity - Buffer::kCheapPrepend);
+  int c = floorLog2(capacity);
+  classes_[c].push_back(Buffer(0));
+  classes_[c].back().swap(*buf);
+  pooledBytes_ += capacity;
+}
@@ -0,0 +1,72 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+// This is an internal header file, you should not include this.
+
+#ifndef MUDUO_NET_BUFFERPOOL_H
+#define MUDUO_NET_BUFFERPOOL_H
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/net/Buffer.h>
+
+#include <vector>
+
+namespace muduo
+{
+namespace net
+{
+
+///
+/// Storage of large Buffers released by the connections of one EventLoop,
+/// handed out again when some connection needs a large one.
+///
+/// Storage is kept in power-of-2 size classes, and the pool never holds
+/// more than maxBytes, anything beyond is freed.  So a burst doesn't
+/// leave every connection with a large buffer, and the next burst doesn't
+/// pay for malloc and page faults again.
+///
+/// Not thread safe, used in the loop thread only.
+class BufferPool : noncopyable
+{
+ public:
+  /// smaller ones are not worth pooling
+  static const size_t kMinPooledSize = 8 * 1024;
+  /// larger ones are freed
+  static const size_t kMaxPooledSize = 4 * 1024 * 1024;
+  static const size_t kDefaultMaxBytes = 64 * 1024 * 1024;
+
+  explicit BufferPool(size_t maxBytes = kDefaultMaxBytes);
+  ~BufferPool();
+
+  /// Makes buf->writableBytes() >= len, with pooled storage if buf is empty.
+  void reserve(Buffer* buf, size_t len);
+
+  /// Moves the content of buf into storage of just enough size,
+  /// the old storage goes back to pool.
+  void shrink(Buffer* buf);
+
+  /// Takes the storage of buf, which is about to be destructed
+  /// or refilled, buf is left empty with no storage.
+  void recycle(Buffer* buf);
+
+  size_t pooledBytes() const { return pooledBytes_; }
+  size_t numPooled() const;
+
+ private:
+  static const int kNumClasses = 32;
+
+  const size_t maxBytes_;
+  size_t pooledBytes_;
+  // class i holds storage of [2^i, 2^(i+1)) bytes
+  std::vector<Buffer> classes_[kNumClasses];
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_BUFFERPOOL_H
@@ -27,6 +27,7 @@ Channel::Channel(EventLoop* loop, int fd__)
     events_(0),
     revents_(0),
     index_(-1),
+    recvBuffer_(NULL),
     logHup_(true),
     tied_(false),
     eventHandling_(false),
@@ -108,7 +109,16 @@ void Channel::handleEventWithGuard(Timestamp receiveTime)
   }
   if (revents_ & (POLLIN | POLLPRI | POLLRDHUP))
   {
-    if (readCallback_) readCallback_(receiveTime);
+    if (recvBuffer_)
+    {
+      Buffer* buf = recvBuffer_;
+      recvBuffer_ = NULL;
+      recvCallback_(buf, receiveTime);
+    }
+    else if (readCallback_)
+    {
+      readCallback_(receiveTime);
+    }
   }
   if (revents_ & POLLOUT)
   {
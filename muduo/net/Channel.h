@@ -22,6 +22,7 @@ namespace muduo
 namespace net
 {
 
+class Buffer;
 class EventLoop;
 
 ///
@@ -37,6 +38,7 @@ class Channel : noncopyable
  public:
   typedef std::function<void()> EventCallback;
   typedef std::function<void(Timestamp)> ReadEventCallback;
+  typedef std::function<void(Buffer*, Timestamp)> RecvCallback;
 
   Channel(EventLoop* loop, int fd);
   ~Channel();
@@ -51,6 +53,16 @@ class Channel : noncopyable
   void setErrorCallback(EventCallback cb)
   { errorCallback_ = std::move(cb); }
 
+  /// Completion based reading, for pollers which can receive on behalf of
+  /// the channel (IoUringPoller).  When data has been received into a
+  /// poller-owned Buffer, recvCallback_ is called with it instead of
+  /// readCallback_; the Buffer is only valid during the callback.
+  /// EOF, errors and pollers without such support still go to readCallback_.
+  /// Must be set before the channel is added to loop.
+  void setRecvCallback(RecvCallback cb)
+  { recvCallback_ = std::move(cb); }
+  bool hasRecvCallback() const { return static_cast<bool>(recvCallback_); }
+
   /// Tie this channel to the owner object managed by shared_ptr,
   /// prevent the owner object being destroyed in handleEvent.
   void tie(const std::shared_ptr<void>&);
@@ -58,6 +70,7 @@ class Channel : noncopyable
   int fd() const { return fd_; }
   int events() const { return events_; }
   void set_revents(int revt) { revents_ = revt; } // used by pollers
+  void set_recvBuffer(Buffer* buf) { recvBuffer_ = buf; } // used by pollers
   // int revents() const { return revents_; }
   bool isNoneEvent() const { return events_ == kNoneEvent; }
 
@@ -99,6 +112,7 @@ class Channel : noncopyable
   //  poll/epoll返回的事件
   int        revents_; // it's the received event types of epoll or poll
   int        index_; // used by Poller.表示在poll事件数组中的序号
+  Buffer*    recvBuffer_; // data received by poller, see setRecvCallback()
   bool       logHup_; //for POLLHUP
 
   std::weak_ptr<void> tie_;
@@ -106,6 +120,7 @@ class Channel : noncopyable
   bool eventHandling_;
   bool addedToLoop_;
   ReadEventCallback readCallback_;
+  RecvCallback recvCallback_;
   EventCallback writeCallback_;
   EventCallback closeCallback_;
   EventCallback errorCallback_;
@@ -10,10 +10,13 @@
 
 #include <muduo/base/Logging.h>
 #include <muduo/base/Mutex.h>
+#include <muduo/net/BufferPool.h>
 #include <muduo/net/Channel.h>
+#include <muduo/net/FunctorQueue.h>
 #include <muduo/net/Poller.h>
 #include <muduo/net/SocketsOps.h>
 #include <muduo/net/TimerQueue.h>
+#include <muduo/net/TrafficCounters.h>
 
 #include <algorithm>
 
@@ -69,13 +72,19 @@ EventLoop::EventLoop()
     quit_(false),
     eventHandling_(false),
     callingPendingFunctors_(false),
+    sleeping_(false),
     iteration_(0),
+    busyMicroSeconds_(0),
+    busySince_(0),
     threadId_(CurrentThread::tid()),
     poller_(Poller::newDefaultPoller(this)),
     timerQueue_(new TimerQueue(this)),
     wakeupFd_(createEventfd()),
     wakeupChannel_(new Channel(this, wakeupFd_)),
-    currentActiveChannel_(NULL)
+    trafficCounters_(new TrafficCounters),
+    bufferPool_(new BufferPool),
+    currentActiveChannel_(NULL),
+    pendingFunctors_(new FunctorQueue)
 {
   LOG_DEBUG << "EventLoop created " << this << " in thread " << threadId_;
   //判断当前线程是否存在EventLoop对象，如果存在，则LOG_FATAL终止程序
@@ -118,7 +127,13 @@ void EventLoop::loop()
   while (!quit_)
   {
     activeChannels_.clear();
-    pollReturnTime_ = poller_->poll(kPollTimeMs, &activeChannels_);
+    // wakeup() writes the eventfd only if it sees sleeping_, pairs with
+    // checking the queue after setting it, so no functor is left behind.
+    sleeping_.store(true);
+    int timeoutMs = pendingFunctors_->empty() && !quit_ ? kPollTimeMs : 0;
+    pollReturnTime_ = poller_->poll(timeoutMs, &activeChannels_);
+    sleeping_.store(false);
+    busySince_.store(pollReturnTime_.microSecondsSinceEpoch(), std::memory_order_relaxed);
     ++iteration_;
     if (Logger::logLevel() <= Logger::TRACE)
     {
@@ -135,6 +150,11 @@ void EventLoop::loop()
     currentActiveChannel_ = NULL;
     eventHandling_ = false;
     doPendingFunctors();
+    int64_t busy = Timestamp::now().microSecondsSinceEpoch()
+                   - pollReturnTime_.microSecondsSinceEpoch();
+    busyMicroSeconds_.store(busyMicroSeconds_.load(std::memory_order_relaxed) + busy,
+                            std::memory_order_relaxed);
+    busySince_.store(0, std::memory_order_relaxed);
   }
 
   LOG_TRACE << "EventLoop " << this << " stop looping";
@@ -172,10 +192,7 @@ void EventLoop::runInLoop(Functor cb)
 
 void EventLoop::queueInLoop(Functor cb)
 {
-  {
-  MutexLockGuard lock(mutex_);
-  pendingFunctors_.push_back(std::move(cb));
-  }
+  pendingFunctors_->push(std::move(cb));
 
   //如果调用queueInLoop的线程不是当前的IO线程，则需要唤醒它
   //或者调用queueInLoop的线程是当前IO线程，并且此时正在调用pending functor，
@@ -187,10 +204,21 @@ void EventLoop::queueInLoop(Functor cb)
   }
 }
 
+int64_t EventLoop::busyMicroSeconds() const
+{
+  int64_t since = busySince_.load(std::memory_order_relaxed);
+  int64_t busy = busyMicroSeconds_.load(std::memory_order_relaxed);
+  if (since > 0)
+  {
+    // stuck in a long iteration counts too
+    busy += std::max(Timestamp::now().microSecondsSinceEpoch() - since, int64_t(0));
+  }
+  return busy;
+}
+
 size_t EventLoop::queueSize() const
 {
-  MutexLockGuard lock(mutex_);
-  return pendingFunctors_.size();
+  return pendingFunctors_->size();
 }
 
 TimerId EventLoop::runAt(Timestamp time, TimerCallback cb)
@@ -250,6 +278,11 @@ void EventLoop::abortNotInLoopThread()
 
 void EventLoop::wakeup()
 {
+  // one write per sleep, the rest would only wake it up again
+  if (!sleeping_.exchange(false))
+  {
+    return;
+  }
   uint64_t one = 1;
   ssize_t n = sockets::write(wakeupFd_, &one, sizeof one);
   if (n != sizeof one)
@@ -270,19 +303,20 @@ void EventLoop::handleRead()
 
 void EventLoop::doPendingFunctors()
 {
-  std::vector<Functor> functors;
   callingPendingFunctors_ = true;
 
-  {
-  MutexLockGuard lock(mutex_);
-  //将functors里的内容和pendingFunctors_的内容交换，交换完后，pendingFunctors_的内容为空
-  functors.swap(pendingFunctors_);
-  }
+  //取出pendingFunctors_中的全部functor，无锁
+  std::vector<Functor> functors;
+  functors.swap(runningFunctors_);
+  pendingFunctors_->takeAll(&functors);
 
   for (const Functor& functor : functors)
   {
     functor();
   }
+  // keeps the capacity for next time
+  functors.clear();
+  runningFunctors_.swap(functors);
   callingPendingFunctors_ = false;
 }
 
@@ -28,9 +28,12 @@ namespace muduo
 namespace net
 {
 
+class BufferPool;
 class Channel;
+class FunctorQueue;
 class Poller;
 class TimerQueue;
+class TrafficCounters;
 
 ///
 /// Reactor, at most one per thread.
@@ -67,6 +70,11 @@ class EventLoop : noncopyable
 
   int64_t iteration() const { return iteration_; }
 
+  /// Total time spent on handling events and functors, not polling,
+  /// including the current iteration.
+  /// Safe to read from other threads.
+  int64_t busyMicroSeconds() const;
+
   /// Runs callback immediately in the loop thread.
   /// It wakes up the loop, and run the cb.
   /// If in the same loop thread, cb is run within the function.
@@ -103,6 +111,8 @@ class EventLoop : noncopyable
   void cancel(TimerId timerId);
 
   // internal usage
+  /// Wakes up the loop if it is blocked in poll(), otherwise it is
+  /// a no-op, the loop checks pending functors before next poll().
   void wakeup();
   //在Poller中添加或者更新通道
   void updateChannel(Channel* channel);
@@ -122,6 +132,13 @@ class EventLoop : noncopyable
   // bool callingPendingFunctors() const { return callingPendingFunctors_; }
   bool eventHandling() const { return eventHandling_; }
 
+  /// Sum of the connections in this loop, written in loop thread,
+  /// safe to read from other threads.
+  TrafficCounters* trafficCounters() const { return get_pointer(trafficCounters_); }
+
+  /// Internal usage, shared by the connections in this loop.
+  BufferPool* bufferPool() const { return get_pointer(bufferPool_); }
+
   void setContext(const boost::any& context)
   { context_ = context; }
 
@@ -146,7 +163,12 @@ class EventLoop : noncopyable
   std::atomic<bool> quit_;
   bool eventHandling_; /* atomic */
   bool callingPendingFunctors_; /* atomic */
+  // in poll() and not woken up yet, cleared by the first wakeup()
+  std::atomic<bool> sleeping_;
   int64_t iteration_;
+  // written in loop thread
+  std::atomic<int64_t> busyMicroSeconds_;
+  std::atomic<int64_t> busySince_;  // 0 if polling
   //当前对象所属线程ID
   const pid_t threadId_;
   Timestamp pollReturnTime_;
@@ -159,6 +181,8 @@ class EventLoop : noncopyable
   //该通道将会纳入poller_来管理
   std::unique_ptr<Channel> wakeupChannel_;
   boost::any context_;
+  std::unique_ptr<TrafficCounters> trafficCounters_;
+  std::unique_ptr<BufferPool> bufferPool_;
 
   // scratch variables
   //Poller返回的活动通道
@@ -166,8 +190,8 @@ class EventLoop : noncopyable
   //当前正在处理的活动通道
   Channel* currentActiveChannel_;
 
-  mutable MutexLock mutex_;
-  std::vector<Functor> pendingFunctors_ GUARDED_BY(mutex_);
+  std::unique_ptr<FunctorQueue> pendingFunctors_;
+  std::vector<Functor> runningFunctors_;  // scratch of doPendingFunctors()
 };
 
 }  // namespace net
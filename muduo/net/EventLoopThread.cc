@@ -8,6 +8,7 @@
 
 #include <muduo/net/EventLoopThread.h>
 
+#include <muduo/base/Logging.h>
 #include <muduo/net/EventLoop.h>
 
 using namespace muduo;
@@ -20,7 +21,8 @@ EventLoopThread::EventLoopThread(const ThreadInitCallback& cb,
     thread_(std::bind(&EventLoopThread::threadFunc, this), name),
     mutex_(),
     cond_(mutex_),
-    callback_(cb)
+    callback_(cb),
+    index_(0)
 {
 }
 
@@ -58,6 +60,11 @@ EventLoop* EventLoopThread::startLoop()
 
 void EventLoopThread::threadFunc()
 {
+  if (!affinity_.apply(index_))
+  {
+    LOG_SYSERR << "EventLoopThread " << thread_.name() << " failed to pin to cpus "
+               << affinity_.cpusOf(index_).toString();
+  }
   EventLoop loop;
 
   if (callback_)
@@ -11,6 +11,7 @@
 #ifndef MUDUO_NET_EVENTLOOPTHREAD_H
 #define MUDUO_NET_EVENTLOOPTHREAD_H
 
+#include <muduo/base/Affinity.h>
 #include <muduo/base/Condition.h>
 #include <muduo/base/Mutex.h>
 #include <muduo/base/Thread.h>
@@ -31,6 +32,16 @@ class EventLoopThread : noncopyable
   EventLoopThread(const ThreadInitCallback& cb = ThreadInitCallback(),
                   const string& name = string());
   ~EventLoopThread();
+
+  /// Must be called before startLoop(), the thread is the index-th of
+  /// its pool.  Applied before the EventLoop is constructed, so memory
+  /// owned by the loop is local to its CPU.
+  void setAffinity(const ThreadAffinity& affinity, size_t index)
+  {
+    affinity_ = affinity;
+    index_ = index;
+  }
+
   EventLoop* startLoop();    //启动线程，并且该线程成为了IO线程
 
  private:
@@ -45,6 +56,8 @@ class EventLoopThread : noncopyable
   Condition cond_ GUARDED_BY(mutex_);
   //回调函数在EventLoop::loop事件循环之前被调用
   ThreadInitCallback callback_;
+  ThreadAffinity affinity_;
+  size_t index_;
 };
 
 }  // namespace net
@@ -10,6 +10,9 @@
 
 #include <muduo/net/EventLoop.h>
 #include <muduo/net/EventLoopThread.h>
+#include <muduo/net/TrafficCounters.h>
+
+#include <algorithm>
 
 #include <stdio.h>
 
@@ -21,7 +24,8 @@ EventLoopThreadPool::EventLoopThreadPool(EventLoop* baseLoop, const string& name
     name_(nameArg),
     started_(false),
     numThreads_(0),
-    next_(0)
+    next_(0),
+    placement_(kRoundRobin)
 {
 }
 
@@ -42,10 +46,15 @@ void EventLoopThreadPool::start(const ThreadInitCallback& cb)
     char buf[name_.size() + 32];
     snprintf(buf, sizeof buf, "%s%d", name_.c_str(), i);
     EventLoopThread* t = new EventLoopThread(cb, buf);
-    threads_.push_back(std::unique_ptr<EventLoopThread>(t))
+    t->setAffinity(affinity_, i);
+    threads_.push_back(std::unique_ptr<EventLoopThread>(t));
     //启动EventLoopThread线程，在进入事件循环之前，会调用cb
     loops_.push_back(t->startLoop());
   }
+  inFlight_.resize(loops_.size());
+  lastTotal_.resize(loops_.size());
+  lastBusy_.resize(loops_.size());
+  utilization_.resize(loops_.size());
   if (numThreads_ == 0 && cb)
   {
     //只有一个EventLoop，在这个EventLoop进入事件循环之前，调用cb
@@ -61,17 +70,110 @@ EventLoop* EventLoopThreadPool::getNextLoop()
   EventLoop* loop = baseLoop_;
   //如果loops_为空，则loop指向baseLoop_
   //如果不为空，按照round-robin(RR,轮叫)的调度方式选择一个EventLoop
-  if (!loops_.empty())
+  if (loops_.empty())
+  {
+    return loop;
+  }
+  if (policy_)
+  {
+    return policy_(loops_);
+  }
+
+  switch (placement_)
+  {
+    case kLeastConnections:
+      loop = loops_[leastConnected()];
+      break;
+    case kLeastQueued:
+      loop = loops_[leastQueued()];
+      break;
+    case kLeastBusy:
+      loop = loops_[leastBusy()];
+      break;
+    default:
+      // round-robin
+      loop = loops_[next_];
+      break;
+  }
+  // also rotates the scans below, so ties are spread
+  ++next_;
+  if (implicit_cast<size_t>(next_) >= loops_.size())
   {
-    // round-robin
-    loop = loops_[next_];
-    ++next_;
-    if (implicit_cast<size_t>(next_) >= loops_.size())
+    next_ = 0;
+  }
+  return loop;
+}
+
+size_t EventLoopThreadPool::leastConnected()
+{
+  // connections are established a bit later in their loops,
+  // counts the ones placed since then, or a burst lands on one loop
+  size_t best = 0;
+  int64_t bestCount = 0;
+  for (size_t n = 0; n < loops_.size(); ++n)
+  {
+    size_t i = (next_ + n) % loops_.size();
+    const TrafficCounters* counters = loops_[i]->trafficCounters();
+    int64_t total = counters->get(TrafficCounters::kConnectionsTotal);
+    inFlight_[i] = std::max(inFlight_[i] - (total - lastTotal_[i]), int64_t(0));
+    lastTotal_[i] = total;
+    int64_t count = counters->get(TrafficCounters::kConnections) + inFlight_[i];
+    if (n == 0 || count < bestCount)
     {
-      next_ = 0;
+      best = i;
+      bestCount = count;
     }
   }
-  return loop;
+  ++inFlight_[best];
+  return best;
+}
+
+size_t EventLoopThreadPool::leastQueued()
+{
+  // connectEstablished() of a placed connection is queued too
+  size_t best = 0;
+  size_t bestSize = 0;
+  for (size_t n = 0; n < loops_.size(); ++n)
+  {
+    size_t i = (next_ + n) % loops_.size();
+    size_t size = loops_[i]->queueSize();
+    if (n == 0 || size < bestSize)
+    {
+      best = i;
+      bestSize = size;
+    }
+  }
+  return best;
+}
+
+size_t EventLoopThreadPool::leastBusy()
+{
+  sampleBusy();
+  size_t a = next_;
+  if (loops_.size() == 1)
+  {
+    return a;
+  }
+  size_t b = (a + 1 + random_() % (loops_.size() - 1)) % loops_.size();
+  return utilization_[b] < utilization_[a] ? b : a;
+}
+
+void EventLoopThreadPool::sampleBusy()
+{
+  Timestamp now = Timestamp::now();
+  double elapsed = timeDifference(now, lastSample_);
+  if (elapsed < 0.1)
+  {
+    return;
+  }
+  for (size_t i = 0; i < loops_.size(); ++i)
+  {
+    int64_t busy = loops_[i]->busyMicroSeconds();
+    utilization_[i] = static_cast<double>(busy - lastBusy_[i])
+                      / (elapsed * Timestamp::kMicroSecondsPerSecond);
+    lastBusy_[i] = busy;
+  }
+  lastSample_ = now;
 }
 
 EventLoop* EventLoopThreadPool::getLoopForHash(size_t hashCode)
@@ -88,7 +190,6 @@ EventLoop* EventLoopThreadPool::getLoopForHash(size_t hashCode)
 
 std::vector<EventLoop*> EventLoopThreadPool::getAllLoops()
 {
-  baseLoop_->assertInLoopThread();
   assert(started_);
   if (loops_.empty())
   {
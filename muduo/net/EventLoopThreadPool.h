@@ -11,11 +11,14 @@
 #ifndef MUDUO_NET_EVENTLOOPTHREADPOOL_H
 #define MUDUO_NET_EVENTLOOPTHREADPOOL_H
 
+#include <muduo/base/Affinity.h>
 #include <muduo/base/noncopyable.h>
+#include <muduo/base/Timestamp.h>
 #include <muduo/base/Types.h>
 
 #include <functional>
 #include <memory>
+#include <random>
 #include <vector>
 
 namespace muduo
@@ -31,19 +34,45 @@ class EventLoopThreadPool : noncopyable
 {
  public:
   typedef std::function<void(EventLoop*)> ThreadInitCallback;
+  /// Picks one of loops for a new connection, called in base loop.
+  typedef std::function<EventLoop* (const std::vector<EventLoop*>& loops)> PlacementPolicy;
+
+  /// How getNextLoop() picks a loop.
+  enum Placement
+  {
+    kRoundRobin,
+    /// fewest alive connections, see TrafficCounters::kConnections
+    kLeastConnections,
+    /// fewest functors waiting in queue, see EventLoop::queueSize()
+    kLeastQueued,
+    /// lowest share of time not polling, measured every 100ms,
+    /// less busy one of two candidates, which doesn't herd on stale numbers
+    kLeastBusy,
+  };
 
   EventLoopThreadPool(EventLoop* baseLoop, const string& nameArg);
   ~EventLoopThreadPool();
   void setThreadNum(int numThreads) { numThreads_ = numThreads; }
+  /// Must be called before start(), i-th thread is affinity.cpusOf(i).
+  /// The base loop is left alone, it belongs to the caller.
+  void setThreadAffinity(const ThreadAffinity& affinity)
+  { affinity_ = affinity; }
   void start(const ThreadInitCallback& cb = ThreadInitCallback());
 
+  /// Must be called before getNextLoop().
+  void setPlacement(Placement placement)
+  { placement_ = placement; }
+  void setPlacementPolicy(const PlacementPolicy& policy)
+  { policy_ = policy; }
+
   // valid after calling start()
-  /// round-robin
+  /// round-robin by default, see setPlacement()
   EventLoop* getNextLoop();
 
   /// with the same hash code, it will always return the same EventLoop
   EventLoop* getLoopForHash(size_t hashCode);
 
+  /// Thread safe after start(), loops don't change.
   std::vector<EventLoop*> getAllLoops();
 
   bool started() const
@@ -53,6 +82,10 @@ class EventLoopThreadPool : noncopyable
   { return name_; }
 
  private:
+  size_t leastConnected();
+  size_t leastQueued();
+  size_t leastBusy();
+  void sampleBusy();
 
   EventLoop* baseLoop_;  //与Acceptor所属EventLoop相同
   string name_;             
@@ -63,6 +96,17 @@ class EventLoopThreadPool : noncopyable
   //一个IO线程对应一个EventLoop对象，这些对象都是栈上对象，不需要由我们来销毁
   //所以这里不需要用unique_ptr
   std::vector<EventLoop*> loops_;                           //EventLoop列表
+  ThreadAffinity affinity_;
+  Placement placement_;
+  PlacementPolicy policy_;
+  // kLeastConnections, placed but not yet established
+  std::vector<int64_t> inFlight_;
+  std::vector<int64_t> lastTotal_;
+  // kLeastBusy
+  Timestamp lastSample_;
+  std::vector<int64_t> lastBusy_;
+  std::vector<double> utilization_;
+  std::minstd_rand random_;
 };
 
 }  // namespace net
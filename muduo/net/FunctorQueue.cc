@@ -0,0 +1,149 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+
+#include <muduo/net/FunctorQueue.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+FunctorQueue::FunctorQueue()
+  : head_(NULL),
+    size_(0),
+    pool_(new Node[kPoolNodes]),
+    free_(0)
+{
+  for (int i = 0; i < kPoolNodes; ++i)
+  {
+    pool_[i].index = i;
+    pool_[i].freeNext.store(i + 1 < kPoolNodes ? i + 2 : 0, std::memory_order_relaxed);
+  }
+  free_.store(1, std::memory_order_release);
+}
+
+FunctorQueue::~FunctorQueue()
+{
+  Node* node = head_.exchange(NULL);
+  while (node)
+  {
+    Node* next = node->next;
+    if (node->index < 0)
+    {
+      delete node;
+    }
+    node = next;
+  }
+}
+
+FunctorQueue::Node* FunctorQueue::allocate()
+{
+  uint64_t head = free_.load(std::memory_order_acquire);
+  while (static_cast<uint32_t>(head) != 0)
+  {
+    Node* node = &pool_[static_cast<uint32_t>(head) - 1];
+    // maybe stale if another producer took it first, then the tag differs
+    uint64_t next = (((head >> 32) + 1) << 32)
+        | node->freeNext.load(std::memory_order_relaxed);
+    if (free_.compare_exchange_weak(head, next,
+                                    std::memory_order_acquire,
+                                    std::memory_order_acquire))
+    {
+      return node;
+    }
+  }
+  Node* node = new Node;
+  node->index = -1;
+  return node;
+}
+
+void FunctorQueue::release(Node* first)
+{
+  // chained in free list order, pushed with one CAS
+  Node* pooledFirst = NULL;
+  Node* pooledLast = NULL;
+  while (first)
+  {
+    Node* next = first->next;
+    if (first->index < 0)
+    {
+      delete first;
+    }
+    else
+    {
+      if (pooledLast)
+      {
+        pooledLast->freeNext.store(first->index + 1, std::memory_order_relaxed);
+      }
+      else
+      {
+        pooledFirst = first;
+      }
+      pooledLast = first;
+    }
+    first = next;
+  }
+  if (pooledFirst == NULL)
+  {
+    return;
+  }
+
+  uint64_t head = free_.load(std::memory_order_relaxed);
+  uint64_t next = 0;
+  do
+  {
+    pooledLast->freeNext.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+    next = (((head >> 32) + 1) << 32) | static_cast<uint32_t>(pooledFirst->index + 1);
+  } while (!free_.compare_exchange_weak(head, next,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed));
+}
+
+void FunctorQueue::push(Functor functor)
+{
+  Node* node = allocate();
+  node->functor = std::move(functor);
+  // before linking, so takeAll() never makes it negative
+  size_.fetch_add(1, std::memory_order_relaxed);
+  node->next = head_.load(std::memory_order_relaxed);
+  // on failure node->next is reloaded with the current head
+  while (!head_.compare_exchange_weak(node->next, node,
+                                      std::memory_order_release,
+                                      std::memory_order_relaxed))
+  {
+  }
+}
+
+void FunctorQueue::takeAll(std::vector<Functor>* functors)
+{
+  Node* node = head_.exchange(NULL, std::memory_order_acquire);
+  if (node == NULL)
+  {
+    return;
+  }
+
+  // reverse LIFO into FIFO
+  Node* first = NULL;
+  size_t count = 0;
+  while (node)
+  {
+    Node* next = node->next;
+    node->next = first;
+    first = node;
+    node = next;
+    ++count;
+  }
+  size_.fetch_sub(count, std::memory_order_relaxed);
+
+  functors->reserve(functors->size() + count);
+  for (node = first; node; node = node->next)
+  {
+    functors->push_back(std::move(node->functor));
+    // nothing captured stays alive in the pool
+    node->functor = nullptr;
+  }
+  release(first);
+}
@@ -0,0 +1,84 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+// This is an internal header file, you should not include this.
+
+#ifndef MUDUO_NET_FUNCTORQUEUE_H
+#define MUDUO_NET_FUNCTORQUEUE_H
+
+#include <muduo/base/noncopyable.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace muduo
+{
+namespace net
+{
+
+///
+/// Lock-free multi-producer single-consumer queue of functors,
+/// the pending functors of EventLoop.
+///
+/// Producers push a node onto an intrusive stack with one CAS, the
+/// consumer takes the whole stack with one exchange and reverses it,
+/// so neither side ever blocks and there is no ABA problem.
+/// The functor lives in the node, small callables are stored inside
+/// std::function.  Nodes come from a pool and go back to it once taken,
+/// through a free list whose head carries a tag against ABA, so a push
+/// allocates nothing unless a burst drains the pool.
+class FunctorQueue : noncopyable
+{
+ public:
+  typedef std::function<void()> Functor;
+
+  /// nodes in the pool, those of a larger burst are allocated
+  static const int kPoolNodes = 256;
+
+  FunctorQueue();
+  ~FunctorQueue();  // drops functors not taken
+
+  /// Thread safe.
+  void push(Functor functor);
+
+  /// Thread safe, maybe stale.
+  bool empty() const { return head_.load() == NULL; }
+  size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+  /// Moves all queued functors to the end of functors, in FIFO order.
+  /// Must be called by the consumer only.
+  void takeAll(std::vector<Functor>* functors);
+
+ private:
+  struct Node
+  {
+    Node* next;
+    Functor functor;
+    int index;                          // in pool_, -1 if allocated
+    std::atomic<uint32_t> freeNext;     // index+1 in the free list, 0 ends
+  };
+
+  Node* allocate();
+  // returns first..last, linked with next, to the pool, deletes others
+  void release(Node* first);
+
+  std::atomic<Node*> head_;  // the latest pushed
+  std::atomic<size_t> size_;
+  std::unique_ptr<Node[]> pool_;
+  std::atomic<uint64_t> free_;  // tag << 32 | index+1 of the first free
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_FUNCTORQUEUE_H
@@ -0,0 +1,126 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+
+#include <muduo/net/IdleConnectionList.h>
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/TcpConnection.h>
+
+#include <algorithm>
+
+using namespace muduo;
+using namespace muduo::net;
+
+IdleConnectionList::IdleConnectionList(EventLoop* loop, double idleSeconds)
+  : loop_(loop),
+    idleMicroSeconds_(static_cast<int64_t>(idleSeconds * Timestamp::kMicroSecondsPerSecond)),
+    head_(NULL),
+    tail_(NULL),
+    size_(0)
+{
+  assert(idleMicroSeconds_ > 0);
+}
+
+IdleConnectionList::~IdleConnectionList() = default;
+
+void IdleConnectionList::start()
+{
+  // a connection is closed at most one interval late
+  double interval = std::min(1.0, static_cast<double>(idleMicroSeconds_)
+                                  / Timestamp::kMicroSecondsPerSecond);
+  std::shared_ptr<IdleConnectionList> self(shared_from_this());
+  timer_ = loop_->runEvery(interval, [self] { self->closeIdle(); });
+}
+
+void IdleConnectionList::stop()
+{
+  loop_->cancel(timer_);
+}
+
+void IdleConnectionList::add(TcpConnection* conn, Timestamp now)
+{
+  loop_->assertInLoopThread();
+  assert(conn->idlePrev_ == NULL && conn->idleNext_ == NULL && head_ != conn);
+  conn->lastActiveTime_ = now;
+  pushBack(conn);
+  ++size_;
+}
+
+void IdleConnectionList::touch(TcpConnection* conn, Timestamp now)
+{
+  conn->lastActiveTime_ = now;
+  if (conn != tail_ && (conn->idlePrev_ || conn == head_))
+  {
+    unlink(conn);
+    pushBack(conn);
+  }
+}
+
+void IdleConnectionList::remove(TcpConnection* conn)
+{
+  loop_->assertInLoopThread();
+  if (conn->idlePrev_ || conn == head_)
+  {
+    unlink(conn);
+    --size_;
+  }
+}
+
+void IdleConnectionList::pushBack(TcpConnection* conn)
+{
+  conn->idlePrev_ = tail_;
+  conn->idleNext_ = NULL;
+  if (tail_)
+  {
+    tail_->idleNext_ = conn;
+  }
+  else
+  {
+    head_ = conn;
+  }
+  tail_ = conn;
+}
+
+void IdleConnectionList::unlink(TcpConnection* conn)
+{
+  if (conn->idlePrev_)
+  {
+    conn->idlePrev_->idleNext_ = conn->idleNext_;
+  }
+  else
+  {
+    head_ = conn->idleNext_;
+  }
+  if (conn->idleNext_)
+  {
+    conn->idleNext_->idlePrev_ = conn->idlePrev_;
+  }
+  else
+  {
+    tail_ = conn->idlePrev_;
+  }
+  conn->idlePrev_ = NULL;
+  conn->idleNext_ = NULL;
+}
+
+void IdleConnectionList::closeIdle()
+{
+  loop_->assertInLoopThread();
+  Timestamp now(Timestamp::now());
+  while (head_ && head_->lastActiveTime_.microSecondsSinceEpoch() + idleMicroSeconds_
+                  <= now.microSecondsSinceEpoch())
+  {
+    TcpConnection* conn = head_;
+    // removed now, so it is closed only once
+    remove(conn);
+    LOG_INFO << "IdleConnectionList - " << conn->name() << " is idle since "
+             << conn->lastActiveTime_.toFormattedString() << ", closing";
+    conn->forceClose();
+  }
+}
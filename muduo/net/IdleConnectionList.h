@@ -0,0 +1,73 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+// This is an internal header file, you should not include this.
+
+#ifndef MUDUO_NET_IDLECONNECTIONLIST_H
+#define MUDUO_NET_IDLECONNECTIONLIST_H
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/TimerId.h>
+
+#include <memory>
+
+namespace muduo
+{
+namespace net
+{
+
+class EventLoop;
+class TcpConnection;
+
+///
+/// Connections of one loop ordered by last activity, idle ones are
+/// force closed.
+///
+/// An intrusive list through TcpConnection, the least recently active
+/// at front.  Activity moves a connection to the back in O(1) without
+/// allocation, a periodic timer closes from the front until it meets
+/// an active one, so there is no per-message timer.
+///
+/// Must be used in the loop thread, except start() and stop().
+class IdleConnectionList : noncopyable,
+                           public std::enable_shared_from_this<IdleConnectionList>
+{
+ public:
+  IdleConnectionList(EventLoop* loop, double idleSeconds);
+  ~IdleConnectionList();
+
+  EventLoop* getLoop() const { return loop_; }
+  size_t size() const { return size_; }
+
+  /// Starts checking periodically, thread safe.
+  void start();
+  /// Thread safe.
+  void stop();
+
+  void add(TcpConnection* conn, Timestamp now);
+  void touch(TcpConnection* conn, Timestamp now);
+  void remove(TcpConnection* conn);
+
+ private:
+  void pushBack(TcpConnection* conn);
+  void unlink(TcpConnection* conn);
+  void closeIdle();
+
+  EventLoop* loop_;
+  const int64_t idleMicroSeconds_;
+  TcpConnection* head_;  // least recently active
+  TcpConnection* tail_;
+  size_t size_;
+  TimerId timer_;
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_IDLECONNECTIONLIST_H
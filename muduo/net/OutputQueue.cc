@@ -0,0 +1,259 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+
+#include <muduo/net/OutputQueue.h>
+
+#include <muduo/net/BufferPool.h>
+#include <muduo/net/SocketsOps.h>
+
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const size_t OutputQueue::kMaxCoalesceBytes;
+const int OutputQueue::kMaxIovecs;
+
+namespace
+{
+// taking a Buffer smaller than this costs more than copying it
+const size_t kMinTakeBytes = 1024;
+}
+
+OutputQueue::OutputQueue(BufferPool* pool)
+  : pool_(pool),
+    bytes_(0)
+{
+}
+
+OutputQueue::~OutputQueue() = default;
+
+void OutputQueue::append(const void* data, size_t len)
+{
+  if (len == 0)
+  {
+    return;
+  }
+  if (segments_.empty()
+      || !segments_.back().buffer
+      || segments_.back().buffer->readableBytes() + len > kMaxCoalesceBytes)
+  {
+    // start a new one instead of growing a large buffer
+    Segment seg;
+    size_t size = std::max(len, Buffer::kInitialSize);
+    if (pool_)
+    {
+      seg.buffer.reset(new Buffer(0));
+      pool_->reserve(seg.buffer.get(), size);
+    }
+    else
+    {
+      seg.buffer.reset(new Buffer(size));
+    }
+    segments_.push_back(std::move(seg));
+  }
+  segments_.back().buffer->append(data, len);
+  bytes_ += len;
+}
+
+void OutputQueue::appendBuffer(Buffer* buf)
+{
+  size_t len = buf->readableBytes();
+  if (len < kMinTakeBytes)
+  {
+    append(buf->peek(), len);
+    buf->retrieveAll();
+    return;
+  }
+  Segment seg;
+  seg.buffer.reset(new Buffer(0));
+  seg.buffer->swap(*buf);
+  segments_.push_back(std::move(seg));
+  bytes_ += len;
+}
+
+void OutputQueue::appendSlice(const void* data, size_t len,
+                              const std::shared_ptr<const void>& owner)
+{
+  if (len == 0)
+  {
+    return;
+  }
+  Segment seg;
+  seg.owner = owner;
+  seg.data = static_cast<const char*>(data);
+  seg.len = len;
+  segments_.push_back(std::move(seg));
+  bytes_ += len;
+}
+
+void OutputQueue::appendFile(int fd, off_t offset, size_t len,
+                             const std::shared_ptr<const void>& owner)
+{
+  assert(fd >= 0 && offset >= 0);
+  if (len == 0)
+  {
+    return;
+  }
+  Segment seg;
+  seg.owner = owner;
+  seg.fd = fd;
+  seg.offset = offset;
+  seg.len = len;
+  segments_.push_back(std::move(seg));
+  bytes_ += len;
+}
+
+void OutputQueue::appendPipe(int fd, size_t len)
+{
+  assert(fd >= 0);
+  if (len == 0)
+  {
+    return;
+  }
+  Segment seg;
+  seg.fd = fd;
+  seg.offset = -1;
+  seg.len = len;
+  segments_.push_back(std::move(seg));
+  bytes_ += len;
+}
+
+ssize_t OutputQueue::writeFd(int fd, int* savedErrno)
+{
+  if (segments_.empty())
+  {
+    return 0;
+  }
+  if (segments_.front().fd >= 0)
+  {
+    return writeFromFd(fd, savedErrno);
+  }
+
+  struct iovec vec[kMaxIovecs];
+  int iovcnt = 0;
+  // stops at a file or pipe, it is sent by next call
+  for (std::deque<Segment>::const_iterator it = segments_.begin();
+       it != segments_.end() && it->fd < 0 && iovcnt < kMaxIovecs; ++it)
+  {
+    const Segment& seg = *it;
+    vec[iovcnt].iov_base = const_cast<char*>(seg.buffer ? seg.buffer->peek() : seg.data);
+    vec[iovcnt].iov_len = seg.readableBytes();
+    ++iovcnt;
+  }
+  ssize_t n = iovcnt == 1
+      ? sockets::write(fd, vec[0].iov_base, vec[0].iov_len)
+      : sockets::writev(fd, vec, iovcnt);
+  if (n < 0)
+  {
+    *savedErrno = errno;
+  }
+  else
+  {
+    retrieve(n);
+  }
+  return n;
+}
+
+ssize_t OutputQueue::writeFromFd(int fd, int* savedErrno)
+{
+  Segment& seg = segments_.front();
+  ssize_t n = 0;
+  if (seg.offset >= 0)
+  {
+    off_t offset = seg.offset;
+    n = sockets::sendfile(fd, seg.fd, &offset, seg.len);
+  }
+  else
+  {
+    n = sockets::splice(seg.fd, fd, seg.len);
+  }
+
+  int err = errno;
+  // file truncated or pipe closed, the rest will never come
+  bool ended = n == 0;
+  if (n < 0 && err == EAGAIN && seg.offset < 0)
+  {
+    // an empty pipe, not the socket, would keep a writable socket spinning
+    int pending = 0;
+    ended = ::ioctl(seg.fd, FIONREAD, &pending) == 0 && pending == 0;
+  }
+
+  if (n > 0)
+  {
+    retrieve(n);
+  }
+  else if (ended)
+  {
+    bytes_ -= seg.len;
+    popFront();
+    *savedErrno = EIO;
+    n = -1;
+  }
+  else
+  {
+    *savedErrno = err;
+  }
+  return n;
+}
+
+void OutputQueue::retrieve(size_t len)
+{
+  assert(len <= bytes_);
+  bytes_ -= len;
+  while (len > 0)
+  {
+    assert(!segments_.empty());
+    Segment& seg = segments_.front();
+    size_t readable = seg.readableBytes();
+    if (len < readable)
+    {
+      if (seg.buffer)
+      {
+        seg.buffer->retrieve(len);
+      }
+      else if (seg.fd >= 0)
+      {
+        if (seg.offset >= 0)
+        {
+          seg.offset += static_cast<off_t>(len);
+        }
+        seg.len -= len;
+      }
+      else
+      {
+        seg.data += len;
+        seg.len -= len;
+      }
+      break;
+    }
+    len -= readable;
+    popFront();
+  }
+}
+
+void OutputQueue::retrieveAll()
+{
+  while (!segments_.empty())
+  {
+    popFront();
+  }
+  bytes_ = 0;
+}
+
+void OutputQueue::popFront()
+{
+  Segment& seg = segments_.front();
+  if (pool_ && seg.buffer)
+  {
+    pool_->recycle(seg.buffer.get());
+  }
+  segments_.pop_front();
+}
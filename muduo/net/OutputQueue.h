@@ -0,0 +1,116 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+// This is an internal header file, you should not include this.
+
+#ifndef MUDUO_NET_OUTPUTQUEUE_H
+#define MUDUO_NET_OUTPUTQUEUE_H
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/net/Buffer.h>
+
+#include <deque>
+#include <memory>
+
+namespace muduo
+{
+namespace net
+{
+
+class BufferPool;
+
+///
+/// Output queue of TcpConnection, a chain of segments written with writev(2).
+///
+/// A segment is either
+///  - an owned Buffer, small sends are copied into the last one,
+///  - a shared immutable block, kept alive by a shared_ptr, or
+///  - a caller provided slice, kept alive by an optional owner, or
+///  - a range of a file or a pipe, sent with sendfile(2) or splice(2),
+///    never entering user space.
+/// Queued bytes are never moved, and drained segments are freed,
+/// or recycled into pool if given, so a large queue doesn't leave a
+/// large buffer behind.
+class OutputQueue : noncopyable
+{
+ public:
+  /// small sends are coalesced into the last owned Buffer up to this size
+  static const size_t kMaxCoalesceBytes = 64 * 1024;
+  /// at most this many segments per writev(2)
+  static const int kMaxIovecs = 64;
+
+  explicit OutputQueue(BufferPool* pool = NULL);
+  ~OutputQueue();
+
+  size_t readableBytes() const { return bytes_; }
+  bool empty() const { return bytes_ == 0; }
+  size_t numSegments() const { return segments_.size(); }
+
+  /// Copies data into the queue.
+  void append(const void* data, size_t len);
+
+  /// Takes the content of buf without copying, buf is left empty.
+  void appendBuffer(Buffer* buf);
+
+  /// Queues [data, data+len) without copying,
+  /// owner keeps it alive until written, it can be empty if caller
+  /// guarantees the lifetime some other way.
+  void appendSlice(const void* data, size_t len,
+                   const std::shared_ptr<const void>& owner);
+
+  /// Queues [offset, offset+len) of file fd, which must remain open
+  /// until the range is written or the queue is cleared, owner can
+  /// keep it open, eg. a file shared by a cache.
+  void appendFile(int fd, off_t offset, size_t len,
+                  const std::shared_ptr<const void>& owner = std::shared_ptr<const void>());
+
+  /// Queues len bytes to be read from pipe fd, which must remain open
+  /// until they are written or the queue is cleared.
+  void appendPipe(int fd, size_t len);
+
+  /// Writes as much as possible to fd with one writev(2), or one
+  /// sendfile(2)/splice(2) if a file or pipe segment is at the front.
+  /// @return result of the syscall, @c errno is saved, 0 without one if
+  /// empty.  A file or pipe that ends before the queued range is dropped
+  /// with @c EIO, the peer won't get what it was told to expect.  So is a
+  /// pipe found empty, it was to hold the whole range when queued.
+  ssize_t writeFd(int fd, int* savedErrno);
+
+  /// Discards len bytes from the front, after they have been written.
+  void retrieve(size_t len);
+
+  void retrieveAll();
+
+ private:
+  struct Segment
+  {
+    Segment() : data(NULL), len(0), fd(-1), offset(0) { }
+
+    std::unique_ptr<Buffer> buffer;      // owned bytes, or
+    std::shared_ptr<const void> owner;   // keeps [data, data+len) or fd alive, or
+    const char* data;
+    size_t len;
+    int fd;                              // file or pipe to send len bytes from
+    off_t offset;                        // of file, -1 for pipe
+
+    size_t readableBytes() const
+    { return buffer ? buffer->readableBytes() : len; }
+  };
+
+  ssize_t writeFromFd(int fd, int* savedErrno);
+  void popFront();
+
+  BufferPool* pool_;
+  std::deque<Segment> segments_;
+  size_t bytes_;
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_OUTPUTQUEUE_H
@@ -122,6 +122,30 @@ void Socket::setReusePort(bool on)
 #endif
 }
 
+void Socket::setDeferAccept(int seconds)
+{
+  int ret = ::setsockopt(sockfd_, IPPROTO_TCP, TCP_DEFER_ACCEPT,
+                         &seconds, static_cast<socklen_t>(sizeof seconds));
+  if (ret < 0)
+  {
+    LOG_SYSERR << "TCP_DEFER_ACCEPT failed.";
+  }
+}
+
+void Socket::setIncomingCpu(int cpu)
+{
+#ifdef SO_INCOMING_CPU
+  int ret = ::setsockopt(sockfd_, SOL_SOCKET, SO_INCOMING_CPU,
+                         &cpu, static_cast<socklen_t>(sizeof cpu));
+  if (ret < 0)
+  {
+    LOG_SYSERR << "SO_INCOMING_CPU failed.";
+  }
+#else
+  LOG_ERROR << "SO_INCOMING_CPU is not supported.";
+#endif
+}
+
 //Tcp keepalive是指定期探测连接是否存在，如果应用层有心跳的话，这个选项不是必须要设置的
 void Socket::setKeepAlive(bool on)
 {
@@ -80,6 +80,18 @@ class Socket : noncopyable
   ///
   void setKeepAlive(bool on);
 
+  ///
+  /// Set TCP_DEFER_ACCEPT, a listening socket wakes up only after data
+  /// arrives or seconds passed, 0 to disable.
+  ///
+  void setDeferAccept(int seconds);
+
+  ///
+  /// Set SO_INCOMING_CPU, among SO_REUSEPORT listening sockets, prefers
+  /// this one for connections handled by cpu.
+  ///
+  void setIncomingCpu(int cpu);
+
  private:
   const int sockfd_;
 };
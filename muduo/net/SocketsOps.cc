@@ -16,7 +16,8 @@
 #include <fcntl.h>
 #include <stdio.h>  // snprintf
 #include <sys/socket.h>
-#include <sys/uio.h>  // readv
+#include <sys/sendfile.h>
+#include <sys/uio.h>  // readv, writev
 #include <unistd.h>
 
 using namespace muduo;
@@ -128,7 +129,10 @@ int sockets::accept(int sockfd, struct sockaddr_in6* addr)
   if (connfd < 0)
   {
     int savedErrno = errno;
-    LOG_SYSERR << "Socket::accept";
+    if (savedErrno != EAGAIN)  // the end of a batch, not an error
+    {
+      LOG_SYSERR << "Socket::accept";
+    }
     switch (savedErrno)
     {
       case EAGAIN:
@@ -180,6 +184,22 @@ ssize_t sockets::write(int sockfd, const void *buf, size_t count)
   return ::write(sockfd, buf, count);
 }
 
+ssize_t sockets::writev(int sockfd, const struct iovec *iov, int iovcnt)
+{
+  return ::writev(sockfd, iov, iovcnt);
+}
+
+ssize_t sockets::sendfile(int sockfd, int fd, off_t* offset, size_t count)
+{
+  return ::sendfile(sockfd, fd, offset, count);
+}
+
+ssize_t sockets::splice(int pipefd, int sockfd, size_t count)
+{
+  return ::splice(pipefd, NULL, sockfd, NULL, count,
+                  SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+}
+
 void sockets::close(int sockfd)
 {
   if (::close(sockfd) < 0)
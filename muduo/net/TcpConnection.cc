@@ -10,8 +10,11 @@
 
 #include <muduo/base/Logging.h>
 #include <muduo/base/WeakCallback.h>
+#include <muduo/net/BufferPool.h>
 #include <muduo/net/Channel.h>
 #include <muduo/net/EventLoop.h>
+#include <muduo/net/IdleConnectionList.h>
+#include <muduo/net/OutputQueue.h>
 #include <muduo/net/Socket.h>
 #include <muduo/net/SocketsOps.h>
 
@@ -20,6 +23,8 @@
 using namespace muduo;
 using namespace muduo::net;
 
+const int TcpConnection::kDefaultBufferShrinkReads;
+
 void muduo::net::defaultConnectionCallback(const TcpConnectionPtr& conn)
 {
   LOG_TRACE << conn->localAddress().toIpPort() << " -> "
@@ -48,7 +53,14 @@ TcpConnection::TcpConnection(EventLoop* loop,
     channel_(new Channel(loop, sockfd)),
     localAddr_(localAddr),
     peerAddr_(peerAddr),
-    highWaterMark_(64*1024*1024)
+    highWaterMark_(64*1024*1024),
+    readSizeHint_(0),
+    bufferShrinkReads_(kDefaultBufferShrinkReads),
+    idleReads_(0),
+    outputQueue_(new OutputQueue(loop->bufferPool())),
+    creationTime_(Timestamp::now()),
+    idlePrev_(NULL),
+    idleNext_(NULL)
 {
   //通道可读事件到来的时候，回调TcpConnection::handleRead, _1是事件发生时间
   channel_->setReadCallback(
@@ -80,6 +92,11 @@ bool TcpConnection::getTcpInfo(struct tcp_info* tcpi) const
   return socket_->getTcpInfo(tcpi);
 }
 
+size_t TcpConnection::outputBytes() const
+{
+  return outputQueue_->readableBytes();
+}
+
 string TcpConnection::getTcpInfoString() const
 {
   char buf[1024];
@@ -116,25 +133,97 @@ void TcpConnection::send(const StringPiece& message)
   }
 }
 
-// FIXME efficiency!!!
+void TcpConnection::send(string&& message)
+{
+  if (state_ == kConnected)
+  {
+    // steals the string, no copying of the payload
+    send(std::make_shared<const string>(std::move(message)));
+  }
+}
+
+void TcpConnection::send(const std::shared_ptr<const string>& message)
+{
+  if (state_ == kConnected)
+  {
+    if (loop_->isInLoopThread())
+    {
+      sendSharedInLoop(message);
+    }
+    else
+    {
+      loop_->runInLoop(
+          std::bind(&TcpConnection::sendSharedInLoop,
+                    this,     // FIXME
+                    message));
+    }
+  }
+}
+
 void TcpConnection::send(Buffer* buf)
 {
   if (state_ == kConnected)
   {
     if (loop_->isInLoopThread())
     {
-      sendInLoop(buf->peek(), buf->readableBytes());
-      //把缓冲区里的数据移除
-      buf->retrieveAll();
+      sendBufferInLoop(buf);
     }
     else
     {
-      void (TcpConnection::*fp)(const StringPiece& message) = &TcpConnection::sendInLoop;
+      std::shared_ptr<Buffer> message(new Buffer(0));
+      message->swap(*buf);
       loop_->runInLoop(
-          std::bind(fp,
+          std::bind(&TcpConnection::sendOwnedBufferInLoop,
                     this,     // FIXME
-                    buf->retrieveAllAsString()));
-                    //std::forward<string>(message)));
+                    message));
+    }
+  }
+}
+
+void TcpConnection::send(Buffer&& message)
+{
+  send(&message);
+}
+
+void TcpConnection::sendFile(int fd, off_t offset, size_t length)
+{
+  sendFile(fd, offset, length, std::shared_ptr<const void>());
+}
+
+void TcpConnection::sendFile(int fd, off_t offset, size_t length,
+                             const std::shared_ptr<const void>& owner)
+{
+  if (state_ == kConnected)
+  {
+    if (loop_->isInLoopThread())
+    {
+      sendFromFdInLoop(fd, offset, length, owner);
+    }
+    else
+    {
+      loop_->runInLoop(
+          std::bind(&TcpConnection::sendFromFdInLoop,
+                    this,     // FIXME
+                    fd, offset, length, owner));
+    }
+  }
+}
+
+void TcpConnection::sendFromPipe(int pipefd, size_t length)
+{
+  if (state_ == kConnected)
+  {
+    if (loop_->isInLoopThread())
+    {
+      sendFromFdInLoop(pipefd, -1, length, std::shared_ptr<const void>());
+    }
+    else
+    {
+      loop_->runInLoop(
+          std::bind(&TcpConnection::sendFromFdInLoop,
+                    this,     // FIXME
+                    pipefd, static_cast<off_t>(-1), length,
+                    std::shared_ptr<const void>()));
     }
   }
 }
@@ -148,25 +237,178 @@ void TcpConnection::sendInLoop(const void* data, size_t len)
 {
   //断言在IO线程当中
   loop_->assertInLoopThread();
-  ssize_t nwrote = 0;
-  size_t remaining = len;
+  if (state_ == kDisconnected)
+  {
+    LOG_WARN << "disconnected, give up writing";
+    return;
+  }
   bool faultError = false;
+  size_t nwrote = writeDirectly(data, len, &faultError);
+  size_t remaining = len - nwrote;
+  //没有错误，并且还要未写完的数据(说明内核发送缓冲区满，要将未写完的数据添加到output buffer)
+  if (!faultError && remaining > 0)
+  {
+    size_t oldLen = outputQueue_->readableBytes();
+    //加nwrote是因为我们已经发送了nwrote个字节，所以只需要把还没有发送的字节添加的output queue中
+    outputQueue_->append(static_cast<const char*>(data)+nwrote, remaining);
+    checkHighWaterMark(oldLen);
+    //如果还没有关注POLLOUT事件，那么就关注它
+    if (!channel_->isWriting())
+    {
+      channel_->enableWriting();
+    }
+  }
+}
+
+void TcpConnection::sendSharedInLoop(const std::shared_ptr<const string>& message)
+{
+  loop_->assertInLoopThread();
   if (state_ == kDisconnected)
   {
     LOG_WARN << "disconnected, give up writing";
     return;
   }
+  bool faultError = false;
+  size_t nwrote = writeDirectly(message->data(), message->size(), &faultError);
+  size_t remaining = message->size() - nwrote;
+  if (!faultError && remaining > 0)
+  {
+    size_t oldLen = outputQueue_->readableBytes();
+    // queue a reference to the rest, not a copy
+    outputQueue_->appendSlice(message->data()+nwrote, remaining, message);
+    checkHighWaterMark(oldLen);
+    if (!channel_->isWriting())
+    {
+      channel_->enableWriting();
+    }
+  }
+}
+
+void TcpConnection::sendOwnedBufferInLoop(const std::shared_ptr<Buffer>& buf)
+{
+  sendBufferInLoop(get_pointer(buf));
+}
+
+void TcpConnection::sendBufferInLoop(Buffer* buf)
+{
+  loop_->assertInLoopThread();
+  if (state_ == kDisconnected)
+  {
+    LOG_WARN << "disconnected, give up writing";
+    buf->retrieveAll();
+    return;
+  }
+  bool faultError = false;
+  size_t nwrote = writeDirectly(buf->peek(), buf->readableBytes(), &faultError);
+  buf->retrieve(nwrote);
+  if (!faultError && buf->readableBytes() > 0)
+  {
+    size_t oldLen = outputQueue_->readableBytes();
+    // take the storage of buf, not a copy
+    outputQueue_->appendBuffer(buf);
+    checkHighWaterMark(oldLen);
+    if (!channel_->isWriting())
+    {
+      channel_->enableWriting();
+    }
+  }
+  buf->retrieveAll();
+}
+
+// offset < 0 for a pipe
+void TcpConnection::sendFromFdInLoop(int fd, off_t offset, size_t length,
+                                     const std::shared_ptr<const void>& owner)
+{
+  loop_->assertInLoopThread();
+  if (state_ == kDisconnected)
+  {
+    LOG_WARN << "disconnected, give up writing";
+    return;
+  }
+  if (length == 0)
+  {
+    return;
+  }
+  count(TrafficCounters::kMessagesSent, 1);
+  // queued first, OutputQueue knows how to send from fd
+  bool writeNow = !channel_->isWriting() && outputQueue_->empty();
+  size_t oldLen = outputQueue_->readableBytes();
+  if (offset >= 0)
+  {
+    outputQueue_->appendFile(fd, offset, length, owner);
+  }
+  else
+  {
+    outputQueue_->appendPipe(fd, length);
+  }
+
+  if (writeNow)
+  {
+    int savedErrno = 0;
+    ssize_t n = outputQueue_->writeFd(channel_->fd(), &savedErrno);
+    count(TrafficCounters::kWriteCalls, 1);
+    if (n > 0)
+    {
+      if (idleList_)
+      {
+        idleList_->touch(this, loop_->pollReturnTime());
+      }
+      count(TrafficCounters::kBytesSent, n);
+    }
+    if (n < 0 && savedErrno != EWOULDBLOCK)
+    {
+      errno = savedErrno;
+      LOG_SYSERR << "TcpConnection::sendFromFdInLoop";
+      if (savedErrno == EPIPE || savedErrno == ECONNRESET)
+      {
+        outputQueue_->retrieveAll();
+        return;
+      }
+      if (savedErrno == EIO)
+      {
+        // ended short, the write is never complete
+        handleClose();
+        return;
+      }
+    }
+    if (outputQueue_->empty())
+    {
+      if (writeCompleteCallback_)
+      {
+        loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+      }
+      return;
+    }
+    oldLen = 0;
+  }
+  checkHighWaterMark(oldLen);
+  if (!channel_->isWriting())
+  {
+    channel_->enableWriting();
+  }
+}
+
+size_t TcpConnection::writeDirectly(const void* data, size_t len, bool* faultError)
+{
+  count(TrafficCounters::kMessagesSent, 1);
+  ssize_t nwrote = 0;
   // if no thing in output queue, try writing directly
-  //通道没有关注可写事件并且outputBuffer发送缓冲区没有数据，直接write
-  if (!channel_->isWriting() && outputBuffer_.readableBytes() == 0)
+  //通道没有关注可写事件并且outputQueue发送队列没有数据，直接write
+  if (!channel_->isWriting() && outputQueue_->empty())
   {
     nwrote = sockets::write(channel_->fd(), data, len);
+    count(TrafficCounters::kWriteCalls, 1);
     if (nwrote >= 0)
     {
-      remaining = len - nwrote;
+      // sent is not idle, eg. a stream pushed by the server
+      if (nwrote > 0 && idleList_)
+      {
+        idleList_->touch(this, loop_->pollReturnTime());
+      }
+      count(TrafficCounters::kBytesSent, nwrote);
       //写完了，回调writeCompleteCallback_
-      //如果remaining大于0，那么会把剩下的数据添加到output buffer中
-      if (remaining == 0 && writeCompleteCallback_)
+      //如果没写完，那么调用者会把剩下的数据添加到output queue中
+      if (implicit_cast<size_t>(nwrote) == len && writeCompleteCallback_)
       {
         loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
       }
@@ -179,30 +421,26 @@ void TcpConnection::sendInLoop(const void* data, size_t len)
         LOG_SYSERR << "TcpConnection::sendInLoop";
         if (errno == EPIPE || errno == ECONNRESET) // FIXME: any others?
         {
-          faultError = true;
+          *faultError = true;
         }
       }
     }
   }
+  assert(implicit_cast<size_t>(nwrote) <= len);
+  return nwrote;
+}
 
-  assert(remaining <= len);
-  //没有错误，并且还要未写完的数据(说明内核发送缓冲区满，要将未写完的数据添加到output buffer)
-  if (!faultError && remaining > 0)
+void TcpConnection::checkHighWaterMark(size_t oldLen)
+{
+  size_t newLen = outputQueue_->readableBytes();
+  countMax(TrafficCounters::kOutputBytesPeak, static_cast<int64_t>(newLen));
+  //如果超过highWaterMark_(高水位标)，回调highWaterMarkCallback_
+  if (newLen >= highWaterMark_ && oldLen < highWaterMark_)
   {
-    size_t oldLen = outputBuffer_.readableBytes();
-    //如果超过highWaterMark_(高水位标)，回调highWaterMarkCallback_
-    if (oldLen + remaining >= highWaterMark_
-        && oldLen < highWaterMark_
-        && highWaterMarkCallback_)
+    count(TrafficCounters::kHighWaterMarkHits, 1);
+    if (highWaterMarkCallback_)
     {
-      loop_->queueInLoop(std::bind(highWaterMarkCallback_, shared_from_this(), oldLen + remaining));
-    }
-    //加nwrote是因为我们已经发送了nwrote个字节，所以只需要把还没有发送的字节添加的output buffer中
-    outputBuffer_.append(static_cast<const char*>(data)+nwrote, remaining);
-    //如果还没有关注POLLOUT事件，那么就关注它
-    if (!channel_->isWriting())
-    {
-      channel_->enableWriting();
+      loop_->queueInLoop(std::bind(highWaterMarkCallback_, shared_from_this(), newLen));
     }
   }
 }
@@ -338,6 +576,32 @@ void TcpConnection::stopReadInLoop()
   }
 }
 
+void TcpConnection::setZeroCopyRecv(bool on)
+{
+  assert(state_ == kConnecting);
+  if (on)
+  {
+    channel_->setRecvCallback(
+        std::bind(&TcpConnection::handleRecv, this, _1, _2));
+  }
+  else
+  {
+    channel_->setRecvCallback(Channel::RecvCallback());
+  }
+}
+
+void TcpConnection::setIdleList(const std::shared_ptr<IdleConnectionList>& list)
+{
+  assert(state_ == kConnecting);
+  idleList_ = list;
+}
+
+void TcpConnection::setServerCounters(const std::shared_ptr<TrafficCounters>& counters)
+{
+  assert(state_ == kConnecting);
+  serverCounters_ = counters;
+}
+
 void TcpConnection::connectEstablished()
 {
   loop_->assertInLoopThread();
@@ -348,6 +612,12 @@ void TcpConnection::connectEstablished()
   channel_->tie(shared_from_this()); //2
   //TcpConnection所对应的通道加入到Poller关注
   channel_->enableReading();
+  if (idleList_)
+  {
+    idleList_->add(this, Timestamp::now());
+  }
+  count(TrafficCounters::kConnections, 1);
+  count(TrafficCounters::kConnectionsTotal, 1);
 
   connectionCallback_(shared_from_this());
 }
@@ -355,7 +625,13 @@ void TcpConnection::connectEstablished()
 void TcpConnection::connectDestroyed()
 {
   loop_->assertInLoopThread();
-  if (state_ == kConnected)
+  if (idleList_)
+  {
+    idleList_->remove(this);
+  }
+  count(TrafficCounters::kConnections, -1);
+  // destroyed by ~TcpServer, maybe while shutting down
+  if (state_ == kConnected || state_ == kDisconnecting)
   {
     setState(kDisconnected);
     channel_->disableAll();
@@ -363,17 +639,41 @@ void TcpConnection::connectDestroyed()
     connectionCallback_(shared_from_this());
   }
   channel_->remove();
+  if (inputBuffer_.readableBytes() == 0)
+  {
+    loop_->bufferPool()->recycle(&inputBuffer_);
+  }
 }  //0
 
 void TcpConnection::handleRead(Timestamp receiveTime)
 {
   loop_->assertInLoopThread();
+  if (readSizeHint_ > inputBuffer_.writableBytes())
+  {
+    loop_->bufferPool()->reserve(&inputBuffer_, readSizeHint_);
+  }
+  const size_t writable = inputBuffer_.writableBytes();
   int savedErrno = 0;
   ssize_t n = inputBuffer_.readFd(channel_->fd(), &savedErrno);
+  count(TrafficCounters::kReadCalls, 1);
   if (n > 0)
   {
+    if (implicit_cast<size_t>(n) > writable)
+    {
+      // overflowed into the stack buffer, read more at once next time
+      readSizeHint_ = std::min(2 * implicit_cast<size_t>(n), BufferPool::kMaxPooledSize);
+    }
+    const size_t occupied = inputBuffer_.readableBytes();
+    if (idleList_)
+    {
+      idleList_->touch(this, receiveTime);
+    }
+    count(TrafficCounters::kBytesReceived, n);
+    count(TrafficCounters::kMessagesReceived, 1);
+    countMax(TrafficCounters::kLastReceiveTime, receiveTime.microSecondsSinceEpoch());
     //把当前这个TcpConnection对象的裸指针转换成shared_ptr
     messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
+    adaptInputBuffer(occupied);
   }
   else if (n == 0)
   {
@@ -387,6 +687,65 @@ void TcpConnection::handleRead(Timestamp receiveTime)
   }
 }
 
+// buf is owned by the poller and only valid in this call
+void TcpConnection::handleRecv(Buffer* buf, Timestamp receiveTime)
+{
+  loop_->assertInLoopThread();
+  if (idleList_)
+  {
+    idleList_->touch(this, receiveTime);
+  }
+  // received by the kernel, no read(2)
+  count(TrafficCounters::kBytesReceived, static_cast<int64_t>(buf->readableBytes()));
+  count(TrafficCounters::kMessagesReceived, 1);
+  countMax(TrafficCounters::kLastReceiveTime, receiveTime.microSecondsSinceEpoch());
+  // what the input buffer holds right after receiving, as in handleRead()
+  const size_t occupied = inputBuffer_.readableBytes() + buf->readableBytes();
+  if (inputBuffer_.readableBytes() == 0)
+  {
+    messageCallback_(shared_from_this(), buf, receiveTime);
+    if (buf->readableBytes() > 0)
+    {
+      // keep the partial message, without copying, and lend the ring
+      // storage as large as its own, pooled, or it'd grow it again
+      if (inputBuffer_.internalCapacity() < buf->internalCapacity())
+      {
+        loop_->bufferPool()->reserve(&inputBuffer_,
+                                     buf->internalCapacity() - Buffer::kCheapPrepend);
+      }
+      inputBuffer_.swap(*buf);
+    }
+  }
+  else
+  {
+    inputBuffer_.append(buf->peek(), buf->readableBytes());
+    buf->retrieveAll();
+    messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
+  }
+  adaptInputBuffer(occupied);
+}
+
+void TcpConnection::adaptInputBuffer(size_t occupied)
+{
+  if (bufferShrinkReads_ <= 0
+      || inputBuffer_.internalCapacity() < BufferPool::kMinPooledSize)
+  {
+    idleReads_ = 0;
+    return;
+  }
+  // mostly empty: less than 1/8 used
+  if (occupied * 8 >= inputBuffer_.internalCapacity())
+  {
+    idleReads_ = 0;
+  }
+  else if (++idleReads_ >= bufferShrinkReads_)
+  {
+    loop_->bufferPool()->shrink(&inputBuffer_);
+    readSizeHint_ = 0;
+    idleReads_ = 0;
+  }
+}
+
 //内核缓冲区有空间了，回调该函数
 void TcpConnection::handleWrite()
 {
@@ -394,13 +753,18 @@ void TcpConnection::handleWrite()
   //如果正处于关注POLLOUT事件
   if (channel_->isWriting())
   {
-    ssize_t n = sockets::write(channel_->fd(),
-                               outputBuffer_.peek(),
-                               outputBuffer_.readableBytes());
+    int savedErrno = 0;
+    // one writev(2) for many queued segments
+    ssize_t n = outputQueue_->writeFd(channel_->fd(), &savedErrno);
+    count(TrafficCounters::kWriteCalls, 1);
     if (n > 0)
     {
-      outputBuffer_.retrieve(n);
-      if (outputBuffer_.readableBytes() == 0)
+      if (idleList_)
+      {
+        idleList_->touch(this, loop_->pollReturnTime());
+      }
+      count(TrafficCounters::kBytesSent, n);
+      if (outputQueue_->empty())
       {
         //停止关注可写事件，以免出现busy loop
         channel_->disableWriting();
@@ -415,9 +779,20 @@ void TcpConnection::handleWrite()
         }
       }
     }
+    else if (n == 0 && outputQueue_->empty())
+    {
+      channel_->disableWriting();
+    }
     else
     {
+      errno = savedErrno;
       LOG_SYSERR << "TcpConnection::handleWrite";
+      if (savedErrno == EIO)
+      {
+        // a file or pipe ended short, the peer would wait for the rest
+        // forever, nor can anything after it be sent
+        handleClose();
+      }
       // if (state_ == kDisconnecting)
       // {
       //   shutdownInLoop();
@@ -439,6 +814,10 @@ void TcpConnection::handleClose()
   // we don't close fd, leave it to dtor, so we can find leaks easily.
   setState(kDisconnected);
   channel_->disableAll();
+  if (idleList_)
+  {
+    idleList_->remove(this);
+  }
 
   TcpConnectionPtr guardThis(shared_from_this());  //3
   connectionCallback_(guardThis);   
@@ -453,3 +832,22 @@ void TcpConnection::handleError()
             << "] - SO_ERROR = " << err << " " << strerror_tl(err);
 }
 
+void TcpConnection::count(TrafficCounters::Counter c, int64_t n)
+{
+  counters_.add(c, n);
+  loop_->trafficCounters()->add(c, n);
+  if (serverCounters_)
+  {
+    serverCounters_->add(c, n);
+  }
+}
+
+void TcpConnection::countMax(TrafficCounters::Counter c, int64_t n)
+{
+  counters_.setMax(c, n);
+  loop_->trafficCounters()->setMax(c, n);
+  if (serverCounters_)
+  {
+    serverCounters_->setMax(c, n);
+  }
+}
@@ -17,6 +17,7 @@
 #include <muduo/net/Callbacks.h>
 #include <muduo/net/Buffer.h>
 #include <muduo/net/InetAddress.h>
+#include <muduo/net/TrafficCounters.h>
 
 #include <memory>
 
@@ -32,6 +33,8 @@ namespace net
 
 class Channel;
 class EventLoop;
+class IdleConnectionList;
+class OutputQueue;
 class Socket;
 
 ///
@@ -62,11 +65,28 @@ class TcpConnection : noncopyable,
   bool getTcpInfo(struct tcp_info*) const;
   string getTcpInfoString() const;
 
-  // void send(string&& message); // C++11
   void send(const void* message, int len);
   void send(const StringPiece& message);
-  // void send(Buffer&& message); // C++11
+  void send(const char* message) { send(StringPiece(message)); }
+  /// Takes the string, its payload is not copied.
+  void send(string&& message);
+  /// Shares message with other connections, the payload is never copied,
+  /// eg. broadcasting one message to many connections.
+  void send(const std::shared_ptr<const string>& message);
   void send(Buffer* message);  // this one will swap data
+  void send(Buffer&& message);  // this one will swap data
+  /// Sends [offset, offset+length) of file fd with sendfile(2), the data
+  /// never enters user space.  fd must remain open until
+  /// WriteCompleteCallback or the connection goes down.
+  void sendFile(int fd, off_t offset, size_t length);
+  /// Same as above, owner keeps fd open till then, eg. a file shared
+  /// by a cache of open files and closed when the last is released.
+  void sendFile(int fd, off_t offset, size_t length,
+                const std::shared_ptr<const void>& owner);
+  /// Moves length bytes out of pipe pipefd with splice(2), the pipe must
+  /// already hold them, eg. spliced in from another socket.  Closes the
+  /// connection if it runs dry before length bytes are sent.
+  void sendFromPipe(int pipefd, size_t length);
   void shutdown(); // NOT thread safe, no simultaneous calling
   // void shutdownAndForceCloseAfter(double seconds); // NOT thread safe, no simultaneous calling
   void forceClose();
@@ -76,6 +96,19 @@ class TcpConnection : noncopyable,
   void startRead();
   void stopRead();
   bool isReading() const { return reading_; }; // NOT thread safe, may race with start/stopReadInLoop
+  /// Lets the poller receive into its own buffers and pass them to
+  /// MessageCallback without copying, see Channel::setRecvCallback().
+  /// Only IoUringPoller (MUDUO_USE_URING) supports it, others read as usual.
+  /// Must be called before connectEstablished().
+  void setZeroCopyRecv(bool on);
+
+  /// Input buffer grows geometrically while reads keep filling it up,
+  /// and is shrunk, giving the storage to the pool of its loop, after
+  /// it has been mostly empty for this many reads in a row.
+  /// 0 means never shrink.  Not thread safe, call it in loop thread.
+  static const int kDefaultBufferShrinkReads = 16;
+  void setBufferShrinkReads(int reads)
+  { bufferShrinkReads_ = reads; }
 
   void setContext(const boost::any& context)
   { context_ = context; }
@@ -103,28 +136,55 @@ class TcpConnection : noncopyable,
   Buffer* inputBuffer()
   { return &inputBuffer_; }
 
-  Buffer* outputBuffer()
-  { return &outputBuffer_; }
+  /// Bytes queued for sending but not written to kernel yet.
+  /// Not thread safe, call it in loop thread.
+  size_t outputBytes() const;
+
+  /// Safe to read from any thread.
+  const TrafficCounters& trafficCounters() const
+  { return counters_; }
+
+  Timestamp creationTime() const
+  { return creationTime_; }
 
   /// Internal use only.
   void setCloseCallback(const CloseCallback& cb)
   { closeCallback_ = cb; }
 
+  /// Internal use only, closes it after being idle for a while.
+  /// Must be called before connectEstablished().
+  void setIdleList(const std::shared_ptr<IdleConnectionList>& list);
+
+  /// Internal use only, also counts into the counters of server.
+  /// Must be called before connectEstablished().
+  void setServerCounters(const std::shared_ptr<TrafficCounters>& counters);
+
   // called when TcpServer accepts a new connection
   void connectEstablished();   // should be called only once
   // called when TcpServer has removed me from its map
   void connectDestroyed();  // should be called only once
 
  private:
+  friend class IdleConnectionList;
   //连接的状态
   enum StateE { kDisconnected, kConnecting, kConnected, kDisconnecting };
   void handleRead(Timestamp receiveTime);
+  void handleRecv(Buffer* buf, Timestamp receiveTime);
   void handleWrite();
   void handleClose();
   void handleError();
-  // void sendInLoop(string&& message);
   void sendInLoop(const StringPiece& message);
   void sendInLoop(const void* message, size_t len);
+  void sendSharedInLoop(const std::shared_ptr<const string>& message);
+  void sendOwnedBufferInLoop(const std::shared_ptr<Buffer>& buf);
+  void sendBufferInLoop(Buffer* buf);
+  void sendFromFdInLoop(int fd, off_t offset, size_t length,
+                        const std::shared_ptr<const void>& owner);
+  // returns bytes written if output queue is empty, 0 otherwise.
+  size_t writeDirectly(const void* data, size_t len, bool* faultError);
+  void checkHighWaterMark(size_t oldLen);
+  // occupied: bytes in input buffer right after receiving
+  void adaptInputBuffer(size_t occupied);
   void shutdownInLoop();
   // void shutdownAndForceCloseInLoop(double seconds);
   void forceCloseInLoop();
@@ -132,6 +192,9 @@ class TcpConnection : noncopyable,
   const char* stateToString() const;
   void startReadInLoop();
   void stopReadInLoop();
+  // into counters of this, the loop and the server
+  void count(TrafficCounters::Counter c, int64_t n);
+  void countMax(TrafficCounters::Counter c, int64_t n);
 
   EventLoop* loop_;   //所属的EventLoop
   const string name_; //连接名
@@ -175,7 +238,10 @@ class TcpConnection : noncopyable,
   CloseCallback closeCallback_;
   size_t highWaterMark_;  //高水位标
   Buffer inputBuffer_;   //应用层接收缓冲区
-  Buffer outputBuffer_; // 应用层发送缓冲区    FIXME: use list<Buffer> as output buffer.
+  size_t readSizeHint_;  // writable bytes to have before next read
+  int bufferShrinkReads_;
+  int idleReads_;        // mostly empty reads in a row
+  std::unique_ptr<OutputQueue> outputQueue_; // 应用层发送缓冲区，分段链表，writev发送
   //可变类型解决方案有2种：
   //   1. void* 这种方法不是类型安全的
   //   2. boost::any
@@ -183,8 +249,14 @@ class TcpConnection : noncopyable,
   //   1.任意类型的类型安全存储以及安全的取回
   //   2.在标准库容器中存放不同类型的方法，比如说vector<boost::any>
   boost::any context_;  //绑定一个未知类型的上下文对象
-  // FIXME: creationTime_, lastReceiveTime_
-  //        bytesReceived_, bytesSent_
+  const Timestamp creationTime_;
+  TrafficCounters counters_;
+  std::shared_ptr<TrafficCounters> serverCounters_;
+  // links of IdleConnectionList, in loop thread
+  std::shared_ptr<IdleConnectionList> idleList_;
+  TcpConnection* idlePrev_;
+  TcpConnection* idleNext_;
+  Timestamp lastActiveTime_;
 };
 
 typedef std::shared_ptr<TcpConnection> TcpConnectionPtr;
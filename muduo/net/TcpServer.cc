@@ -8,12 +8,15 @@
 
 #include <muduo/net/TcpServer.h>
 
+#include <muduo/base/CountDownLatch.h>
 #include <muduo/base/Logging.h>
 #include <muduo/net/Acceptor.h>
 #include <muduo/net/EventLoop.h>
 #include <muduo/net/EventLoopThreadPool.h>
+#include <muduo/net/IdleConnectionList.h>
 #include <muduo/net/SocketsOps.h>
 
+#include <sched.h>
 #include <stdio.h>  // snprintf
 
 using namespace muduo;
@@ -26,10 +29,19 @@ TcpServer::TcpServer(EventLoop* loop,
   : loop_(CHECK_NOTNULL(loop)),
     ipPort_(listenAddr.toIpPort()),
     name_(nameArg),
-    acceptor_(new Acceptor(loop, listenAddr, option == kReusePort)),
+    option_(option),
+    acceptor_(new Acceptor(loop, listenAddr, option != kNoReusePort)),
     threadPool_(new EventLoopThreadPool(loop, name_)),
     connectionCallback_(defaultConnectionCallback),
     messageCallback_(defaultMessageCallback),
+    zeroCopyRecv_(false),
+    idleTimeout_(0),
+    bufferShrinkReads_(TcpConnection::kDefaultBufferShrinkReads),
+    maxAcceptsPerRead_(16),
+    acceptRate_(0),
+    acceptBurst_(0),
+    deferAcceptSeconds_(0),
+    incomingCpu_(false),
     nextConnId_(1)
 {
   //Acceptor::handleRead函数中会回调TcpServer::newConnection
@@ -43,7 +55,33 @@ TcpServer::~TcpServer()
   loop_->assertInLoopThread();
   LOG_TRACE << "TcpServer::~TcpServer [" << name_ << "] destructing";
 
-  for (auto& item : connections_)
+  for (auto& item : idleLists_)
+  {
+    item.second->stop();
+  }
+
+  if (!loopAcceptors_.empty())
+  {
+    // stops accepting before this is gone
+    CountDownLatch latch(static_cast<int>(loopAcceptors_.size()));
+    for (auto& acceptor : loopAcceptors_)
+    {
+      Acceptor* a = get_pointer(acceptor);
+      a->loop()->runInLoop([&acceptor, &latch]
+                           {
+                             acceptor.reset();
+                             latch.countDown();
+                           });
+    }
+    latch.wait();
+  }
+
+  ConnectionMap connections;
+  {
+  MutexLockGuard lock(mutex_);
+  connections.swap(connections_);
+  }
+  for (auto& item : connections)
   {
     TcpConnectionPtr conn(item.second);
     item.second.reset();
@@ -65,13 +103,118 @@ void TcpServer::start()
   if (started_.getAndSet(1) == 0)
   {
     threadPool_->start(threadInitCallback_);
+    for (EventLoop* ioLoop : threadPool_->getAllLoops())
+    {
+      counters_[ioLoop].reset(new TrafficCounters);
+    }
+    if (idleTimeout_ > 0)
+    {
+      for (EventLoop* ioLoop : threadPool_->getAllLoops())
+      {
+        std::shared_ptr<IdleConnectionList> list(new IdleConnectionList(ioLoop, idleTimeout_));
+        list->start();
+        idleLists_[ioLoop] = list;
+      }
+    }
+
+    bool acceptInLoop = true;
+    if (option_ == kReusePortEachLoop)
+    {
+      // with port 0 resolved
+      InetAddress listenAddr(acceptor_->listenAddress());
+      for (EventLoop* ioLoop : threadPool_->getAllLoops())
+      {
+        if (ioLoop == loop_)
+        {
+          // no thread, accepts with acceptor_ as usual
+          continue;
+        }
+        std::unique_ptr<Acceptor> acceptor(new Acceptor(ioLoop, listenAddr, true));
+        acceptor->setNewConnectionCallback(
+            std::bind(&TcpServer::newConnectionInLoop, this, ioLoop, _1, _2));
+        loopAcceptors_.push_back(std::move(acceptor));
+      }
+      for (auto& acceptor : loopAcceptors_)
+      {
+        Acceptor* a = get_pointer(acceptor);
+        configureAcceptor(a, loopAcceptors_.size());
+        bool incomingCpu = incomingCpu_;
+        a->loop()->runInLoop([a, incomingCpu]
+                             {
+                               if (incomingCpu)
+                               {
+                                 a->setIncomingCpu(::sched_getcpu());
+                               }
+                               a->listen();
+                             });
+      }
+      // acceptor_ stays bound but not listening, gets no connections
+      acceptInLoop = loopAcceptors_.empty();
+    }
+
+    if (acceptInLoop)
+    {
+      configureAcceptor(get_pointer(acceptor_), 1);
+      //断言是否处于监听状态
+      assert(!acceptor_->listenning());
+      //get_pointer()可以返回智能指针的原生指针
+      loop_->runInLoop(
+          std::bind(&Acceptor::listen, get_pointer(acceptor_)));
+    }
+  }
+}
+
+// limits are shared evenly by numAcceptors
+void TcpServer::configureAcceptor(Acceptor* acceptor, size_t numAcceptors)
+{
+  acceptor->setMaxAcceptsPerRead(maxAcceptsPerRead_);
+  if (acceptRate_ > 0)
+  {
+    acceptor->setRateLimit(acceptRate_ / static_cast<double>(numAcceptors),
+                           acceptBurst_ / static_cast<int>(numAcceptors));
+  }
+  if (deferAcceptSeconds_ > 0)
+  {
+    acceptor->setDeferAccept(deferAcceptSeconds_);
+  }
+}
+
+TcpServer::AcceptStats TcpServer::acceptStats() const
+{
+  AcceptStats stats = { 0, 0, 0, 0 };
+  std::vector<const Acceptor*> acceptors(1, get_pointer(acceptor_));
+  for (const auto& acceptor : loopAcceptors_)
+  {
+    acceptors.push_back(get_pointer(acceptor));
+  }
+  for (const Acceptor* acceptor : acceptors)
+  {
+    stats.wakeups += acceptor->wakeups();
+    stats.accepted += acceptor->accepted();
+    stats.throttled += acceptor->throttled();
+    stats.failures += acceptor->failures();
+  }
+  return stats;
+}
+
+void TcpServer::getTrafficCounters(TrafficCounters* total) const
+{
+  for (const auto& item : counters_)
+  {
+    total->accumulate(*item.second);
+  }
+}
 
-    //断言是否处于监听状态
-    assert(!acceptor_->listenning());
-    //get_pointer()可以返回智能指针的原生指针
-    loop_->runInLoop(
-        std::bind(&Acceptor::listen, get_pointer(acceptor_)));
+std::vector<TcpConnectionPtr> TcpServer::connections() const
+{
+  std::vector<TcpConnectionPtr> result;
+  MutexLockGuard lock(mutex_);
+  result.reserve(connections_.size());
+  for (const auto& item : connections_)
+  {
+    result.push_back(item.second);
   }
+  return result;
 }
 
 void TcpServer::newConnection(int sockfd, const InetAddress& peerAddr)
@@ -80,9 +223,25 @@ void TcpServer::newConnection(int sockfd, const InetAddress& peerAddr)
   loop_->assertInLoopThread();
   //按照轮叫的方式给新连接选择一个EventLoop
   EventLoop* ioLoop = threadPool_->getNextLoop();
+  createConnection(ioLoop, sockfd, peerAddr);
+}
+
+void TcpServer::newConnectionInLoop(EventLoop* ioLoop, int sockfd, const InetAddress& peerAddr)
+{
+  // accepted by the acceptor of ioLoop, no hand-off
+  ioLoop->assertInLoopThread();
+  createConnection(ioLoop, sockfd, peerAddr);
+}
+
+void TcpServer::createConnection(EventLoop* ioLoop, int sockfd, const InetAddress& peerAddr)
+{
+  int connId = 0;
+  {
+  MutexLockGuard lock(mutex_);
+  connId = nextConnId_++;
+  }
   char buf[64];
-  snprintf(buf, sizeof buf, "-%s#%d", ipPort_.c_str(), nextConnId_);
-  ++nextConnId_;
+  snprintf(buf, sizeof buf, "-%s#%d", ipPort_.c_str(), connId);
   string connName = name_ + buf;
 
   LOG_INFO << "TcpServer::newConnection [" << name_
@@ -98,10 +257,20 @@ void TcpServer::newConnection(int sockfd, const InetAddress& peerAddr)
                                           sockfd,
                                           localAddr,
                                           peerAddr));    //1
+  {
+  MutexLockGuard lock(mutex_);
   connections_[connName] = conn;     //2
+  }
   conn->setConnectionCallback(connectionCallback_);
   conn->setMessageCallback(messageCallback_);
   conn->setWriteCompleteCallback(writeCompleteCallback_);
+  conn->setZeroCopyRecv(zeroCopyRecv_);
+  conn->setBufferShrinkReads(bufferShrinkReads_);
+  conn->setServerCounters(counters_[ioLoop]);
+  if (!idleLists_.empty())
+  {
+    conn->setIdleList(idleLists_[ioLoop]);
+  }
   conn->setCloseCallback(
       std::bind(&TcpServer::removeConnection, this, _1)); // FIXME: unsafe
   //让ioLoop所属的线程调用connectEstablished.
@@ -111,17 +280,32 @@ void TcpServer::newConnection(int sockfd, const InetAddress& peerAddr)
 void TcpServer::removeConnection(const TcpConnectionPtr& conn)
 {
   // FIXME: unsafe
-  loop_->runInLoop(std::bind(&TcpServer::removeConnectionInLoop, this, conn));
+  if (option_ == kReusePortEachLoop)
+  {
+    // connections_ is locked, no need to go to loop_
+    removeConnectionInLoop(conn);
+  }
+  else
+  {
+    loop_->runInLoop(std::bind(&TcpServer::removeConnectionInLoop, this, conn));
+  }
 }
 
 void TcpServer::removeConnectionInLoop(const TcpConnectionPtr& conn)
 {
-  loop_->assertInLoopThread();
   LOG_INFO << "TcpServer::removeConnectionInLoop [" << name_
            << "] - connection " << conn->name();
-  size_t n = connections_.erase(conn->name());  //2
-  (void)n;
-  assert(n == 1);
+  size_t n = 0;
+  {
+  MutexLockGuard lock(mutex_);
+  n = connections_.erase(conn->name());  //2
+  }
+  if (n == 0)
+  {
+    // taken by ~TcpServer in the meantime
+    assert(option_ == kReusePortEachLoop);
+    return;
+  }
   EventLoop* ioLoop = conn->getLoop();
   ioLoop->queueInLoop(
       std::bind(&TcpConnection::connectDestroyed, conn));  //3
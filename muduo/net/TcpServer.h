@@ -12,10 +12,13 @@
 #define MUDUO_NET_TCPSERVER_H
 
 #include <muduo/base/Atomic.h>
+#include <muduo/base/Mutex.h>
 #include <muduo/base/Types.h>
+#include <muduo/net/EventLoopThreadPool.h>
 #include <muduo/net/TcpConnection.h>
 
 #include <map>
+#include <vector>
 
 namespace muduo
 {
@@ -24,7 +27,7 @@ namespace net
 
 class Acceptor;
 class EventLoop;
-class EventLoopThreadPool;
+class IdleConnectionList;
 
 ///
 /// TCP server, supports single-threaded and thread-pool models.
@@ -34,10 +37,22 @@ class TcpServer : noncopyable
 {
  public:
   typedef std::function<void(EventLoop*)> ThreadInitCallback;
+  struct AcceptStats
+  {
+    int64_t wakeups;    // readiness of listening sockets
+    int64_t accepted;
+    int64_t throttled;  // times stopped accepting by rate limit
+    int64_t failures;   // accept(2) errors, EMFILE for example
+  };
+
   enum Option
   {
     kNoReusePort,
     kReusePort,
+    /// Each IO loop accepts on its own SO_REUSEPORT socket and creates
+    /// its connections locally, instead of one acceptor in loop handing
+    /// them out.  The kernel spreads new connections among the loops.
+    kReusePortEachLoop,
   };
 
   //TcpServer(EventLoop* loop, const InetAddress& listenAddr);
@@ -64,6 +79,21 @@ class TcpServer : noncopyable
   void setThreadNum(int numThreads);
   void setThreadInitCallback(const ThreadInitCallback& cb)
   { threadInitCallback_ = cb; }
+  /// Pins the IO threads, before thread init callback runs, e.g.
+  /// ThreadAffinity(ThreadAffinity::kEachOne, CpuSet::ofDevice("eth0"))
+  /// puts loop i on the CPU of receive queue i, together with
+  /// kReusePortEachLoop and setIncomingCpu() a connection stays on one CPU.
+  /// Must be called before @c start
+  void setThreadAffinity(const ThreadAffinity& affinity)
+  { threadPool_->setThreadAffinity(affinity); }
+
+  /// How a new connection picks its loop, default round-robin.
+  /// Not used with kReusePortEachLoop, where the kernel picks.
+  /// Must be called before @c start
+  void setLoopPlacement(EventLoopThreadPool::Placement placement)
+  { threadPool_->setPlacement(placement); }
+  void setLoopPlacementPolicy(const EventLoopThreadPool::PlacementPolicy& policy)
+  { threadPool_->setPlacementPolicy(policy); }
   /// valid after calling start()
   std::shared_ptr<EventLoopThreadPool> threadPool()
   { return threadPool_; }
@@ -91,29 +121,106 @@ class TcpServer : noncopyable
   void setWriteCompleteCallback(const WriteCompleteCallback& cb)
   { writeCompleteCallback_ = cb; }
 
+  /// Receive without copying into input buffer, when supported by the poller.
+  /// See TcpConnection::setZeroCopyRecv().
+  /// Not thread safe.
+  void setZeroCopyRecv(bool on)
+  { zeroCopyRecv_ = on; }
+
+  /// Force closes connections that have neither received nor sent
+  /// anything for @c seconds, 0 means never, which is the default.
+  /// Checked in each loop at most once per second, so they are closed
+  /// a bit later than that.
+  /// Must be called before @c start
+  void setIdleTimeout(double seconds)
+  { idleTimeout_ = seconds; }
+
+  /// Accepts up to n connections each time a listening socket is
+  /// readable, default 16.
+  /// Must be called before @c start
+  void setMaxAcceptsPerRead(int n)
+  { maxAcceptsPerRead_ = n; }
+
+  /// Admits at most perSecond new connections on average and burst at
+  /// once, for all loops.  Beyond that they wait in the backlog,
+  /// then the kernel drops SYNs, so reconnect storms back off.
+  /// 0 means no limit, which is the default.
+  /// Must be called before @c start
+  void setAcceptRateLimit(double perSecond, int burst)
+  { acceptRate_ = perSecond; acceptBurst_ = burst; }
+
+  /// Sets TCP_DEFER_ACCEPT, connections are accepted only after some
+  /// data arrived, or seconds passed.
+  /// Must be called before @c start
+  void setDeferAccept(int seconds)
+  { deferAcceptSeconds_ = seconds; }
+
+  /// With kReusePortEachLoop, sets SO_INCOMING_CPU of the socket of each
+  /// loop to the CPU the loop runs on, so a connection is accepted by
+  /// the loop on the CPU that handled its packets.
+  /// Only makes sense with loop threads pinned, see setThreadAffinity().
+  /// Must be called before @c start
+  void setIncomingCpu(bool on)
+  { incomingCpu_ = on; }
+
+  /// Sum of all acceptors.  Thread safe.
+  AcceptStats acceptStats() const;
+
+  /// See TcpConnection::setBufferShrinkReads().
+  /// Not thread safe.
+  void setBufferShrinkReads(int reads)
+  { bufferShrinkReads_ = reads; }
+
+  /// Sums up the traffic of all connections, alive or closed, into total.
+  /// Thread safe, valid after calling start().
+  void getTrafficCounters(TrafficCounters* total) const;
+
+  /// Alive connections.
+  /// Thread safe.
+  std::vector<TcpConnectionPtr> connections() const;
+
  private:
   /// Not thread safe, but in loop
   void newConnection(int sockfd, const InetAddress& peerAddr);
+  /// Not thread safe, but in ioLoop, for kReusePortEachLoop
+  void newConnectionInLoop(EventLoop* ioLoop, int sockfd, const InetAddress& peerAddr);
+  void createConnection(EventLoop* ioLoop, int sockfd, const InetAddress& peerAddr);
+  void configureAcceptor(Acceptor* acceptor, size_t numAcceptors);
   /// Thread safe.
   void removeConnection(const TcpConnectionPtr& conn);
-  /// Not thread safe, but in loop
+  /// Thread safe, in loop unless kReusePortEachLoop
   void removeConnectionInLoop(const TcpConnectionPtr& conn);
 
   typedef std::map<string, TcpConnectionPtr> ConnectionMap;
+  typedef std::map<EventLoop*, std::shared_ptr<IdleConnectionList> > IdleListMap;
+  typedef std::map<EventLoop*, std::shared_ptr<TrafficCounters> > CountersMap;
 
   EventLoop* loop_;  // the acceptor loop
   const string ipPort_;    //服务器端口
   const string name_;      //服务名
+  const Option option_;
   std::unique_ptr<Acceptor> acceptor_; // avoid revealing Acceptor
+  // kReusePortEachLoop, one for each IO loop except loop_, written in start()
+  std::vector<std::unique_ptr<Acceptor> > loopAcceptors_;
   std::shared_ptr<EventLoopThreadPool> threadPool_;
   ConnectionCallback connectionCallback_;
   MessageCallback messageCallback_;
   WriteCompleteCallback writeCompleteCallback_;
   ThreadInitCallback threadInitCallback_;
+  bool zeroCopyRecv_;
+  double idleTimeout_;
+  int bufferShrinkReads_;
+  int maxAcceptsPerRead_;
+  double acceptRate_;
+  int acceptBurst_;
+  int deferAcceptSeconds_;
+  bool incomingCpu_;
+  IdleListMap idleLists_;  // one for each loop, written in start()
+  CountersMap counters_;   // one for each loop, single writer, written in start()
   AtomicInt32 started_;
-  // always in loop thread
-  int nextConnId_;             //下一个连接ID
-  ConnectionMap connections_;  //连接列表
+  mutable MutexLock mutex_;
+  int nextConnId_ GUARDED_BY(mutex_);             //下一个连接ID
+  ConnectionMap connections_ GUARDED_BY(mutex_);  //连接列表
 };
 
 }  // namespace net
@@ -32,9 +32,29 @@ class Timer : noncopyable
       expiration_(when),
       interval_(interval),
       repeat_(interval > 0.0),   //大于0就不是一次性定时器
-      sequence_(s_numCreated_.incrementAndGet())   //先加后获取
+      sequence_(s_numCreated_.incrementAndGet()),   //先加后获取
+      next_(NULL),
+      pprev_(NULL),
+      level_(0),
+      expireTick_(0)
   { }
 
+  /// Reuses a pooled timer as a new one, with a new sequence.
+  void reset(TimerCallback cb, Timestamp when, double interval)
+  {
+    callback_ = std::move(cb);
+    expiration_ = when;
+    interval_ = interval;
+    repeat_ = interval > 0.0;
+    sequence_ = s_numCreated_.incrementAndGet();
+  }
+
+  /// Drops the callback, and whatever it holds, before pooling.
+  void release()
+  {
+    callback_ = TimerCallback();
+  }
+
   void run() const
   {
     callback_();
@@ -49,11 +69,19 @@ class Timer : noncopyable
   static int64_t numCreated() { return s_numCreated_.get(); }
 
  private:
-  const TimerCallback callback_;  //定时器回调函数
+  friend class TimerWheel;
+
+  TimerCallback callback_;        //定时器回调函数
   Timestamp expiration_;          //下一次的超时时刻
-  const double interval_;         //超时时间间隔，如果是一次性定时器，该值为0
-  const bool repeat_;             //是否重复,如果false表示一次性定时器
-  const int64_t sequence_;        //定时器序号
+  double interval_;               //超时时间间隔，如果是一次性定时器，该值为0
+  bool repeat_;                   //是否重复,如果false表示一次性定时器
+  int64_t sequence_;              //定时器序号
+
+  // intrusive slot list of TimerWheel
+  Timer* next_;
+  Timer** pprev_;                 // NULL if not in a slot
+  int level_;
+  int64_t expireTick_;
 
   static AtomicInt64 s_numCreated_;  //定时器计数，当前已经创建的定时器数量，原子int64_t类型，初始值为0
 };
@@ -16,7 +16,9 @@
 #include <muduo/net/EventLoop.h>
 #include <muduo/net/Timer.h>
 #include <muduo/net/TimerId.h>
+#include <muduo/net/TimerWheel.h>
 
+#include <stdlib.h>
 #include <sys/timerfd.h>
 #include <unistd.h>
 
@@ -27,6 +29,8 @@ namespace net
 namespace detail
 {
 
+const double kDefaultWheelTickMs = 1.0;
+
 int createTimerfd()
 {
   int timerfd = ::timerfd_create(CLOCK_MONOTONIC,
@@ -102,6 +106,18 @@ TimerQueue::TimerQueue(EventLoop* loop)
       std::bind(&TimerQueue::handleRead, this));
   // we are always reading the timerfd, we disarm it with timerfd_settime.
   timerfdChannel_.enableReading();
+
+  const char* wheel = ::getenv("MUDUO_TIMER_WHEEL");
+  if (wheel)
+  {
+    double tickMs = ::atof(wheel);
+    if (!(tickMs > 0))
+    {
+      tickMs = kDefaultWheelTickMs;
+    }
+    int64_t tickUs = std::max(static_cast<int64_t>(tickMs * 1000), static_cast<int64_t>(1));
+    wheel_.reset(new TimerWheel(Timestamp::now(), tickUs));
+  }
 }
 
 TimerQueue::~TimerQueue()
@@ -120,7 +136,10 @@ TimerId TimerQueue::addTimer(TimerCallback cb,
                              Timestamp when,
                              double interval)
 {
-  Timer* timer = new Timer(std::move(cb), when, interval);
+  // pooled timers of the wheel can only be taken in loop thread
+  Timer* timer = wheel_ && loop_->isInLoopThread()
+      ? wheel_->newTimer(std::move(cb), when, interval)
+      : new Timer(std::move(cb), when, interval);
   loop_->runInLoop(
       std::bind(&TimerQueue::addTimerInLoop, this, timer));
   return TimerId(timer, timer->sequence());
@@ -135,6 +154,15 @@ void TimerQueue::cancel(TimerId timerId)
 void TimerQueue::addTimerInLoop(Timer* timer)
 {
   loop_->assertInLoopThread();
+  if (wheel_)
+  {
+    Timestamp wakeup = wheel_->insert(timer);
+    if (!wheelWakeup_.valid() || wakeup < wheelWakeup_)
+    {
+      resetWheelTimerfd(wakeup);
+    }
+    return;
+  }
   //插入一个定时器，有可能会使得最早到期的定时器发生改变
   bool earliestChanged = insert(timer);
 
@@ -148,6 +176,12 @@ void TimerQueue::addTimerInLoop(Timer* timer)
 void TimerQueue::cancelInLoop(TimerId timerId)
 {
   loop_->assertInLoopThread();
+  if (wheel_)
+  {
+    // leaves timerfd armed, one spurious wakeup at most
+    wheel_->cancel(timerId.timer_, timerId.sequence_);
+    return;
+  }
   assert(timers_.size() == activeTimers_.size());
   ActiveTimer timer(timerId.timer_, timerId.sequence_);
   ActiveTimerSet::iterator it = activeTimers_.find(timer);
@@ -172,6 +206,19 @@ void TimerQueue::handleRead()
   Timestamp now(Timestamp::now());
   readTimerfd(timerfd_, now);    //清除该事件，避免一直触发
 
+  if (wheel_)
+  {
+    // timers added by callbacks re-arm timerfd if earlier
+    wheelWakeup_ = Timestamp::invalid();
+    wheel_->expire(now);
+    Timestamp wakeup = wheel_->nextWakeup();
+    if (wakeup.valid() && (!wheelWakeup_.valid() || wakeup < wheelWakeup_))
+    {
+      resetWheelTimerfd(wakeup);
+    }
+    return;
+  }
+
   //获取该时刻之前所有的定时器列表(即超时定时器列表)
   std::vector<Entry> expired = getExpired(now);
 
@@ -280,3 +327,8 @@ bool TimerQueue::insert(Timer* timer)
   return earliestChanged;
 }
 
+void TimerQueue::resetWheelTimerfd(Timestamp wakeup)
+{
+  wheelWakeup_ = wakeup;
+  resetTimerfd(timerfd_, wakeup);
+}
@@ -11,6 +11,7 @@
 #ifndef MUDUO_NET_TIMERQUEUE_H
 #define MUDUO_NET_TIMERQUEUE_H
 
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -27,11 +28,17 @@ namespace net
 class EventLoop;
 class Timer;
 class TimerId;
+class TimerWheel;
 
 ///
 /// A best efforts timer queue.
 /// No guarantee that the callback will be on time.
 ///
+/// Timers are kept in a balanced tree by default.  If environment
+/// variable MUDUO_TIMER_WHEEL is set, they are kept in a TimerWheel,
+/// whose tick is its value in milliseconds (1 if not a positive number),
+/// for many timers that are mostly cancelled, eg. per connection timeouts.
+///
 class TimerQueue : noncopyable
 {
  public:
@@ -81,6 +88,7 @@ class TimerQueue : noncopyable
   void reset(const std::vector<Entry>& expired, Timestamp now);
 
   bool insert(Timer* timer);
+  void resetWheelTimerfd(Timestamp wakeup);
 
   EventLoop* loop_;   //所属EventLoop
   const int timerfd_;
@@ -96,6 +104,10 @@ class TimerQueue : noncopyable
   bool callingExpiredTimers_; /* atomic */
   //保存的是被取消的定时器
   ActiveTimerSet cancelingTimers_;
+
+  // replaces the sets above if not null
+  std::unique_ptr<TimerWheel> wheel_;
+  Timestamp wheelWakeup_;  // timerfd is armed for
 };
 
 }  // namespace net
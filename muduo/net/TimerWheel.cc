@@ -0,0 +1,324 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+
+#ifndef __STDC_LIMIT_MACROS
+#define __STDC_LIMIT_MACROS
+#endif
+
+#include <muduo/net/TimerWheel.h>
+
+#include <muduo/net/Timer.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+const int TimerWheel::kLevels;
+const int TimerWheel::kRootBits;
+const int TimerWheel::kLevelBits;
+const int TimerWheel::kRootSize;
+const int TimerWheel::kLevelSize;
+
+namespace
+{
+// ticks the top level can hold, farther timers are cascaded again
+const int64_t kMaxDelta = (static_cast<int64_t>(1) << 32) - 1;
+}
+
+TimerWheel::TimerWheel(Timestamp now, int64_t tickMicroSeconds)
+  : origin_(now),
+    tick_(tickMicroSeconds),
+    nextTick_(0),
+    size_(0),
+    running_(NULL),
+    runningCancelled_(false)
+{
+  assert(tick_ > 0);
+  memset(counts_, 0, sizeof counts_);
+  memset(root_, 0, sizeof root_);
+  memset(levels_, 0, sizeof levels_);
+}
+
+TimerWheel::~TimerWheel()
+{
+  for (int level = 0; level < kLevels; ++level)
+  {
+    int n = level == 0 ? kRootSize : kLevelSize;
+    for (int i = 0; i < n; ++i)
+    {
+      Timer* timer = *slot(level, i);
+      while (timer)
+      {
+        Timer* next = timer->next_;
+        delete timer;
+        timer = next;
+      }
+    }
+  }
+  for (Timer* timer : pool_)
+  {
+    delete timer;
+  }
+}
+
+Timer* TimerWheel::newTimer(TimerCallback cb, Timestamp when, double interval)
+{
+  if (pool_.empty())
+  {
+    return new Timer(std::move(cb), when, interval);
+  }
+  Timer* timer = pool_.back();
+  pool_.pop_back();
+  timer->reset(std::move(cb), when, interval);
+  return timer;
+}
+
+Timestamp TimerWheel::insert(Timer* timer)
+{
+  assert(timer->pprev_ == NULL);
+  timer->expireTick_ = tickOf(timer->expiration());
+  return timeOf(link(timer));
+}
+
+void TimerWheel::cancel(Timer* timer, int64_t sequence)
+{
+  // timer is never freed before the wheel, but could have been reused
+  if (timer->sequence() != sequence)
+  {
+    return;
+  }
+  if (timer == running_)
+  {
+    runningCancelled_ = true;
+  }
+  else if (timer->pprev_)
+  {
+    unlink(timer);
+    release(timer);
+  }
+}
+
+void TimerWheel::expire(Timestamp now)
+{
+  int64_t us = now.microSecondsSinceEpoch() - origin_.microSecondsSinceEpoch();
+  int64_t nowTick = us < 0 ? -1 : us / tick_;
+  while (nextTick_ <= nowTick)
+  {
+    if (size_ == 0)
+    {
+      nextTick_ = nowTick + 1;
+      break;
+    }
+    int index = static_cast<int>(nextTick_ & (kRootSize-1));
+    if (index == 0)
+    {
+      // level 1 cascades every round of level 0, and so on
+      for (int level = 1; level < kLevels; ++level)
+      {
+        int i = static_cast<int>((nextTick_ >> shiftOf(level)) & (kLevelSize-1));
+        cascade(level, i);
+        if (i != 0)
+        {
+          break;
+        }
+      }
+    }
+    if (counts_[0] == 0)
+    {
+      // nothing until next round
+      nextTick_ = std::min((nextTick_ | (kRootSize-1)) + 1, nowTick + 1);
+      continue;
+    }
+    ++nextTick_;
+    runSlot(index, now);
+  }
+}
+
+Timestamp TimerWheel::nextWakeup() const
+{
+  if (size_ == 0)
+  {
+    return Timestamp::invalid();
+  }
+  int64_t best = INT64_MAX;
+  if (counts_[0] > 0)
+  {
+    for (int64_t tick = nextTick_; tick < nextTick_ + kRootSize; ++tick)
+    {
+      if (*slot(0, static_cast<int>(tick & (kRootSize-1))))
+      {
+        best = tick;
+        break;
+      }
+    }
+  }
+  for (int level = 1; level < kLevels; ++level)
+  {
+    if (counts_[level] == 0)
+    {
+      continue;
+    }
+    // slots of this level are cascaded one by one at multiples of span
+    int shift = shiftOf(level);
+    int64_t span = static_cast<int64_t>(1) << shift;
+    int64_t tick = ((nextTick_ + span - 1) >> shift) << shift;
+    for (int k = 0; k < kLevelSize && tick < best; ++k, tick += span)
+    {
+      if (*slot(level, static_cast<int>((tick >> shift) & (kLevelSize-1))))
+      {
+        best = tick;
+        break;
+      }
+    }
+  }
+  assert(best != INT64_MAX);
+  return timeOf(best);
+}
+
+int64_t TimerWheel::tickOf(Timestamp when) const
+{
+  int64_t us = when.microSecondsSinceEpoch() - origin_.microSecondsSinceEpoch();
+  // never earlier than expiration
+  return us <= 0 ? 0 : (us + tick_ - 1) / tick_;
+}
+
+Timestamp TimerWheel::timeOf(int64_t tick) const
+{
+  return Timestamp(origin_.microSecondsSinceEpoch() + tick * tick_);
+}
+
+// returns the tick it fires or cascades
+int64_t TimerWheel::link(Timer* timer)
+{
+  int64_t expires = timer->expireTick_;
+  int64_t delta = expires - nextTick_;
+  int level = 0;
+  int index = 0;
+  int64_t wakeup = expires;
+  if (delta < 0)
+  {
+    // already expired, runs with the next tick
+    index = static_cast<int>(nextTick_ & (kRootSize-1));
+    wakeup = nextTick_;
+  }
+  else if (delta < kRootSize)
+  {
+    index = static_cast<int>(expires & (kRootSize-1));
+  }
+  else
+  {
+    if (delta > kMaxDelta)
+    {
+      expires = nextTick_ + kMaxDelta;
+      delta = kMaxDelta;
+    }
+    level = 1;
+    while (delta >= static_cast<int64_t>(1) << shiftOf(level+1))
+    {
+      ++level;
+    }
+    assert(level < kLevels);
+    int shift = shiftOf(level);
+    index = static_cast<int>((expires >> shift) & (kLevelSize-1));
+    wakeup = (expires >> shift) << shift;
+  }
+
+  Timer** head = slot(level, index);
+  timer->next_ = *head;
+  if (*head)
+  {
+    (*head)->pprev_ = &timer->next_;
+  }
+  *head = timer;
+  timer->pprev_ = head;
+  timer->level_ = level;
+  ++counts_[level];
+  ++size_;
+  return wakeup;
+}
+
+void TimerWheel::unlink(Timer* timer)
+{
+  assert(timer->pprev_);
+  *timer->pprev_ = timer->next_;
+  if (timer->next_)
+  {
+    timer->next_->pprev_ = timer->pprev_;
+  }
+  timer->next_ = NULL;
+  timer->pprev_ = NULL;
+  if (timer->level_ >= 0)
+  {
+    --counts_[timer->level_];
+  }
+  --size_;
+}
+
+void TimerWheel::cascade(int level, int index)
+{
+  Timer** head = slot(level, index);
+  Timer* timer = *head;
+  *head = NULL;
+  while (timer)
+  {
+    Timer* next = timer->next_;
+    --counts_[level];
+    --size_;
+    timer->next_ = NULL;
+    timer->pprev_ = NULL;
+    link(timer);
+    timer = next;
+  }
+}
+
+void TimerWheel::runSlot(int index, Timestamp now)
+{
+  // detached first, callbacks may add timers to the same slot,
+  // or cancel the ones not run yet
+  Timer* expired = *slot(0, index);
+  *slot(0, index) = NULL;
+  if (expired)
+  {
+    expired->pprev_ = &expired;
+  }
+  for (Timer* timer = expired; timer; timer = timer->next_)
+  {
+    timer->level_ = -1;
+    --counts_[0];
+  }
+
+  while (expired)
+  {
+    Timer* timer = expired;
+    unlink(timer);
+    running_ = timer;
+    runningCancelled_ = false;
+    timer->run();
+    running_ = NULL;
+    if (timer->repeat() && !runningCancelled_)
+    {
+      timer->restart(now);
+      insert(timer);
+    }
+    else
+    {
+      release(timer);
+    }
+  }
+}
+
+void TimerWheel::release(Timer* timer)
+{
+  timer->release();
+  pool_.push_back(timer);
+}
@@ -0,0 +1,104 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+// This is an internal header file, you should not include this.
+
+#ifndef MUDUO_NET_TIMERWHEEL_H
+#define MUDUO_NET_TIMERWHEEL_H
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/Callbacks.h>
+
+#include <vector>
+
+namespace muduo
+{
+namespace net
+{
+
+class Timer;
+
+///
+/// Hierarchical timing wheel, an alternative backend of TimerQueue.
+///
+/// Time is cut into ticks, a timer fires at the first tick not earlier
+/// than its expiration.  Level 0 has 256 slots of one tick, each of the
+/// four upper levels has 64 slots covering a whole lower level, timers
+/// are cascaded down as the wheel turns, like the classic Linux timer.
+/// Insert and cancel are O(1), and Timer objects are pooled, so a
+/// TimerId stays safe to cancel after its timer is gone, the sequence
+/// tells a reused one apart.
+///
+/// All member functions must be called in the loop thread.
+class TimerWheel : noncopyable
+{
+ public:
+  TimerWheel(Timestamp now, int64_t tickMicroSeconds);
+  ~TimerWheel();
+
+  int64_t tickMicroSeconds() const { return tick_; }
+  size_t size() const { return size_; }
+
+  /// Takes a Timer from the pool, or allocates one.
+  Timer* newTimer(TimerCallback cb, Timestamp when, double interval);
+
+  /// Adds a timer, it is pooled after it fires or is cancelled.
+  /// @return the time loop must wake up for it, it might be earlier
+  /// than its expiration if it needs cascading.
+  Timestamp insert(Timer* timer);
+
+  void cancel(Timer* timer, int64_t sequence);
+
+  /// Runs timers expired by now, repeating ones are restarted.
+  void expire(Timestamp now);
+
+  /// Earliest time any timer fires or needs cascading,
+  /// invalid if there is no timer.
+  Timestamp nextWakeup() const;
+
+ private:
+  static const int kLevels = 5;
+  static const int kRootBits = 8;
+  static const int kLevelBits = 6;
+  static const int kRootSize = 1 << kRootBits;
+  static const int kLevelSize = 1 << kLevelBits;
+
+  static int shiftOf(int level)
+  { return level == 0 ? 0 : kRootBits + (level-1) * kLevelBits; }
+
+  Timer** slot(int level, int index)
+  { return level == 0 ? &root_[index] : &levels_[level-1][index]; }
+  Timer* const* slot(int level, int index) const
+  { return level == 0 ? &root_[index] : &levels_[level-1][index]; }
+
+  int64_t tickOf(Timestamp when) const;
+  Timestamp timeOf(int64_t tick) const;
+  int64_t link(Timer* timer);
+  void unlink(Timer* timer);
+  void cascade(int level, int index);
+  void runSlot(int index, Timestamp now);
+  void release(Timer* timer);
+
+  const Timestamp origin_;
+  const int64_t tick_;
+  int64_t nextTick_;  // ticks before it have been run
+  size_t size_;
+  size_t counts_[kLevels];
+  Timer* root_[kRootSize];
+  Timer* levels_[kLevels-1][kLevelSize];
+
+  Timer* running_;
+  bool runningCancelled_;
+  std::vector<Timer*> pool_;
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_TIMERWHEEL_H
@@ -0,0 +1,78 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+
+#include <muduo/net/TrafficCounters.h>
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+namespace
+{
+const char* const kNames[TrafficCounters::kNumCounters] =
+{
+  "bytesReceived",
+  "bytesSent",
+  "messagesReceived",
+  "messagesSent",
+  "readCalls",
+  "writeCalls",
+  "highWaterMarkHits",
+  "outputBytesPeak",
+  "lastReceiveTime",
+  "connections",
+  "connectionsTotal",
+};
+}  // namespace
+
+TrafficCounters::TrafficCounters()
+{
+  for (int i = 0; i < kNumCounters; ++i)
+  {
+    values_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void TrafficCounters::accumulate(const TrafficCounters& other)
+{
+  for (int i = 0; i < kNumCounters; ++i)
+  {
+    Counter c = static_cast<Counter>(i);
+    if (c == kOutputBytesPeak || c == kLastReceiveTime)
+    {
+      setMax(c, other.get(c));
+    }
+    else
+    {
+      add(c, other.get(c));
+    }
+  }
+}
+
+string TrafficCounters::toString() const
+{
+  string result;
+  char buf[64];
+  for (int i = 0; i < kNumCounters; ++i)
+  {
+    snprintf(buf, sizeof buf, "%-18s %" PRId64 "\n", kNames[i], get(static_cast<Counter>(i)));
+    result += buf;
+  }
+  return result;
+}
+
+const char* TrafficCounters::name(Counter c)
+{
+  return kNames[c];
+}
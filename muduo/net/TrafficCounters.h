@@ -0,0 +1,89 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef MUDUO_NET_TRAFFICCOUNTERS_H
+#define MUDUO_NET_TRAFFICCOUNTERS_H
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/Types.h>
+
+#include <atomic>
+
+namespace muduo
+{
+namespace net
+{
+
+///
+/// Traffic counters of a TcpConnection, or the sum of the connections
+/// of an EventLoop or a TcpServer.
+///
+/// Each set has a single writer, the loop thread of the connections,
+/// so updating is a plain load and store, no locked instruction.
+/// Reading is safe from any thread.
+class TrafficCounters : noncopyable
+{
+ public:
+  enum Counter
+  {
+    kBytesReceived,
+    kBytesSent,
+    kMessagesReceived,   // times of MessageCallback
+    kMessagesSent,       // calls of send()
+    kReadCalls,          // read(2) syscalls
+    kWriteCalls,         // write(2), writev(2), sendfile(2) and splice(2)
+    kHighWaterMarkHits,
+    kOutputBytesPeak,    // max bytes in output queue
+    kLastReceiveTime,    // microseconds since epoch
+    kConnections,        // alive, for a loop or a server
+    kConnectionsTotal,   // ever established, for a loop or a server
+    kNumCounters
+  };
+
+  TrafficCounters();
+
+  /// Single writer only.
+  void add(Counter c, int64_t n)
+  { values_[c].store(values_[c].load(std::memory_order_relaxed) + n,
+                     std::memory_order_relaxed); }
+
+  /// Single writer only.
+  void set(Counter c, int64_t n)
+  { values_[c].store(n, std::memory_order_relaxed); }
+
+  /// Single writer only.
+  void setMax(Counter c, int64_t n)
+  {
+    if (n > values_[c].load(std::memory_order_relaxed))
+    {
+      values_[c].store(n, std::memory_order_relaxed);
+    }
+  }
+
+  int64_t get(Counter c) const
+  { return values_[c].load(std::memory_order_relaxed); }
+
+  /// Adds other into this, peak and time take the max.
+  /// For summing up into a local object.
+  void accumulate(const TrafficCounters& other);
+
+  /// One "name value" per line.
+  string toString() const;
+
+  static const char* name(Counter c);
+
+ private:
+  std::atomic<int64_t> values_[kNumCounters];
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_TRAFFICCOUNTERS_H
@@ -8,112 +8,326 @@
 //
 
 #include <muduo/net/Buffer.h>
+#include <muduo/net/TcpConnection.h>
 #include <muduo/net/http/HttpContext.h>
 
+#include <ctype.h>
+#include <stdint.h>
+#include <strings.h>
+
 using namespace muduo;
 using namespace muduo::net;
 
-bool HttpContext::processRequestLine(const char* begin, const char* end)
+bool HttpContext::fillRequest(const char* begin)
+{
+  StringPiece method = HttpParser::view(begin, parser_.method());
+  if (!request_.setMethod(method.begin(), method.end()))
+  {
+    return false;
+  }
+  StringPiece path = HttpParser::view(begin, parser_.path());
+  request_.setPath(path.begin(), path.end());
+  StringPiece query = HttpParser::view(begin, parser_.query());
+  request_.setQuery(query.begin(), query.end());
+  request_.setVersion(parser_.minorVersion() == 1 ? HttpRequest::kHttp11 : HttpRequest::kHttp10);
+  for (const HttpParser::Header& header : parser_.headers())
+  {
+    request_.addHeader(HttpParser::view(begin, header.name),
+                       HttpParser::view(begin, header.value));
+  }
+  return true;
+}
+
+bool HttpContext::parseHead(Buffer* buf, Timestamp receiveTime)
 {
-  bool succeed = false;
-  const char* start = begin;
-  const char* space = std::find(start, end, ' ');
-  if (space != end && request_.setMethod(start, space))   //解析请求方法
-  {
-    start = space+1;
-    space = std::find(start, end, ' ');
-    if (space != end)
+  bool gotRequestLine = parser_.gotRequestLine();
+  HttpParser::Result result = parser_.parse(buf->peek(), buf->beginWrite());
+  if (result == HttpParser::kError)
+  {
+    return fail(HttpResponse::k400BadRequest);
+  }
+  if (!gotRequestLine && parser_.gotRequestLine())
+  {
+    request_.setReceiveTime(receiveTime);  //设置请求时间
+    state_ = kExpectHeaders;
+  }
+  if (result == HttpParser::kComplete)
+  {
+    if (!fillRequest(buf->peek()))
     {
-      const char* question = std::find(start, space, '?');
-      if (question != space)
-      {
-        request_.setPath(start, question);   //解析path
-        request_.setQuery(question, space);
-      }
-      else
+      return fail(HttpResponse::k400BadRequest);
+    }
+    //请求行和header都从buf中取回，包括空行
+    buf->retrieve(parser_.headLength());
+    return startBody();
+  }
+  return true;
+}
+
+// RFC 7230 3.3.3, a message with both Transfer-Encoding and
+// Content-Length, or two different Content-Length, is rejected,
+// they're how requests are smuggled through proxies.
+bool HttpContext::startBody()
+{
+  const HttpHeaders& headers = request_.headers();
+  StringPiece transferEncoding = headers.get(HttpHeaders::kTransferEncoding);
+  StringPiece contentLength = headers.get(HttpHeaders::kContentLength);
+  if (!transferEncoding.empty())
+  {
+    if (!contentLength.empty())
+    {
+      return fail(HttpResponse::k400BadRequest);
+    }
+    if (transferEncoding.size() != 7
+        || ::strncasecmp(transferEncoding.data(), "chunked", 7) != 0)
+    {
+      return fail(HttpResponse::k501NotImplemented);
+    }
+    state_ = kExpectChunkSize;
+  }
+  else if (!contentLength.empty())
+  {
+    for (int i = 0; i < headers.size(); ++i)
+    {
+      if (headers.field(i) == HttpHeaders::kContentLength && headers.value(i) != contentLength)
       {
-        request_.setPath(start, space);
+        return fail(HttpResponse::k400BadRequest);
       }
-      start = space+1;
-      succeed = end-start == 8 && std::equal(start, end-1, "HTTP/1.");
-      if (succeed)
+    }
+    size_t length = 0;
+    for (char c : contentLength)
+    {
+      if (c < '0' || c > '9' || length > (SIZE_MAX - 9) / 10)
       {
-        if (*(end-1) == '1')
-        {
-          request_.setVersion(HttpRequest::kHttp11);
-        }
-        else if (*(end-1) == '0')
-        {
-          request_.setVersion(HttpRequest::kHttp10);
-        }
-        else
-        {
-          succeed = false;
-        }
+        return fail(HttpResponse::k400BadRequest);
       }
+      length = length * 10 + (c - '0');
+    }
+    if (!bodyCallback_ && length > maxBodySize_)
+    {
+      return fail(HttpResponse::k413PayloadTooLarge);
+    }
+    bodyRemaining_ = length;
+    state_ = length > 0 ? kExpectBody : kGotAll;
+  }
+  else
+  {
+    state_ = kGotAll;
+  }
+
+  StringPiece expect = headers.get(HttpHeaders::kExpect);
+  expectContinue_ = state_ != kGotAll && request_.getVersion() == HttpRequest::kHttp11
+      && expect.size() == 12 && ::strncasecmp(expect.data(), "100-continue", 12) == 0;
+  return true;
+}
+
+// of Content-Length, or of a chunk
+bool HttpContext::readBody(Buffer* buf)
+{
+  size_t n = std::min(buf->readableBytes(), bodyRemaining_);
+  if (n > 0)
+  {
+    if (bodyCallback_)
+    {
+      bodyCallback_(request_, StringPiece(buf->peek(), static_cast<int>(n)));
+    }
+    else if (request_.body().size() + n > maxBodySize_)
+    {
+      return fail(HttpResponse::k413PayloadTooLarge);
+    }
+    else
+    {
+      request_.appendBody(buf->peek(), n);
+    }
+    buf->retrieve(n);
+    bodyRemaining_ -= n;
+  }
+  if (bodyRemaining_ == 0)
+  {
+    state_ = state_ == kExpectBody ? kGotAll : kExpectChunkEnd;
+  }
+  return true;
+}
+
+// chunk-size [; chunk-ext] CRLF, chunk-size in hex
+bool HttpContext::parseChunkSize(Buffer* buf)
+{
+  const char* crlf = buf->findCRLF();
+  if (crlf == NULL)
+  {
+    // extensions aside, it's a few hex digits
+    return buf->readableBytes() <= 1024 || fail(HttpResponse::k400BadRequest);
+  }
+  const char* p = buf->peek();
+  size_t size = 0;
+  int digits = 0;
+  for (; p < crlf && isxdigit(*p); ++p, ++digits)
+  {
+    int x = *p <= '9' ? *p - '0' : (*p | 0x20) - 'a' + 10;
+    size = size * 16 + x;
+  }
+  if (digits == 0 || digits > 15 || (p < crlf && *p != ';' && *p != ' ' && *p != '\t'))
+  {
+    return fail(HttpResponse::k400BadRequest);
+  }
+  buf->retrieveUntil(crlf + 2);
+  bodyRemaining_ = size;
+  state_ = size > 0 ? kExpectChunkData : kExpectTrailers;
+  return true;
+}
+
+bool HttpContext::parseChunkEnd(Buffer* buf)
+{
+  if (buf->readableBytes() < 2)
+  {
+    return true;
+  }
+  if (buf->peek()[0] != '\r' || buf->peek()[1] != '\n')
+  {
+    return fail(HttpResponse::k400BadRequest);
+  }
+  buf->retrieve(2);
+  state_ = kExpectChunkSize;
+  return true;
+}
+
+// trailer fields are skipped, none that we know of matters
+bool HttpContext::parseTrailers(Buffer* buf)
+{
+  const char* crlf = NULL;
+  while ((crlf = buf->findCRLF()) != NULL)
+  {
+    bool empty = crlf == buf->peek();
+    buf->retrieveUntil(crlf + 2);
+    if (empty)
+    {
+      state_ = kGotAll;
+      return true;
     }
   }
-  return succeed;
+  return buf->readableBytes() <= 8192 || fail(HttpResponse::k400BadRequest);
 }
 
 // return false if any error
 bool HttpContext::parseRequest(Buffer* buf, Timestamp receiveTime)
 {
-  bool ok = true;
-  bool hasMore = true;
-  while (hasMore)
+  // one state after another while there's something to go on with
+  while (state_ != kGotAll)
   {
-    if (state_ == kExpectRequestLine)   //处于解析请求行状态
+    HttpRequestParseState state = state_;
+    size_t readable = buf->readableBytes();
+    bool ok = true;
+    switch (state_)
     {
-      const char* crlf = buf->findCRLF();
-      if (crlf)
-      {
-        ok = processRequestLine(buf->peek(), crlf);  //解析请求行
-        if (ok)
-        {
-          request_.setReceiveTime(receiveTime);  //设置请求时间
-          buf->retrieveUntil(crlf + 2);          //将请求行从buf中取回，包括\r\n
-          state_ = kExpectHeaders;            //httpContext将状态改为kExpectHeaders
-        }
-        else
-        {
-          hasMore = false;
-        }
-      }
-      else
-      {
-        hasMore = false;
-      }
+      case kExpectRequestLine:
+      case kExpectHeaders:
+        ok = parseHead(buf, receiveTime);
+        break;
+      case kExpectBody:
+      case kExpectChunkData:
+        ok = readBody(buf);
+        break;
+      case kExpectChunkSize:
+        ok = parseChunkSize(buf);
+        break;
+      case kExpectChunkEnd:
+        ok = parseChunkEnd(buf);
+        break;
+      case kExpectTrailers:
+        ok = parseTrailers(buf);
+        break;
+      case kGotAll:
+        break;
     }
-    else if (state_ == kExpectHeaders)   //解析header
+    if (!ok)
     {
-      const char* crlf = buf->findCRLF();
-      if (crlf)
-      {
-        //冒号所在的位置
-        const char* colon = std::find(buf->peek(), crlf, ':');
-        if (colon != crlf)
-        {
-          request_.addHeader(buf->peek(), colon, crlf);
-        }
-        else
-        {
-          // empty line, end of header
-          // FIXME:
-          state_ = kGotAll;
-          hasMore = false;
-        }
-        buf->retrieveUntil(crlf + 2);
-      }
-      else
-      {
-        hasMore = false;
-      }
+      return false;
     }
-    else if (state_ == kExpectBody) //当前还不支持请求中带body
+    if (state_ == state && buf->readableBytes() == readable)
+    {
+      break;  // waits for more
+    }
+  }
+  return true;
+}
+
+bool HttpContext::appendResponse(const TcpConnectionPtr& conn,
+                                 const HttpRequest& request,
+                                 HttpResponse* response)
+{
+  if (request.getVersion() == HttpRequest::kHttp10)
+  {
+    response->setChunked(false);
+  }
+  if (request.method() == HttpRequest::kHead)
+  {
+    response->appendHeadToBuffer(&output_);
+  }
+  else if (response->hasFileBody())
+  {
+    response->appendHeadToBuffer(&output_);
+    // queued in order, the file goes with sendfile(2) after the head
+    conn->send(&output_);
+    conn->sendFile(response->fileFd(), response->fileOffset(),
+                   response->fileLength(), response->fileOwner());
+  }
+  else
+  {
+    response->appendToBuffer(&output_);
+  }
+  return response->closeConnection();
+}
+
+bool HttpContext::stopReadIfFull(const TcpConnectionPtr& conn)
+{
+  if (deferred_.size() < maxPending_)
+  {
+    return false;
+  }
+  if (!readStopped_)
+  {
+    // the rest waits in the input buffer, and then the kernel's
+    conn->stopRead();
+    readStopped_ = true;
+  }
+  return true;
+}
+
+void HttpContext::sendDeferred(const TcpConnectionPtr& conn)
+{
+  bool close = false;
+  while (!close && !deferred_.empty() && deferred_.front()->isDone())
+  {
+    HttpDeferredResponse* front = deferred_.front().get();
+    close = appendResponse(conn, front->request(), front->response());
+    deferred_.pop_front();
+  }
+  if (close)
+  {
+    // none after it is to be answered
+    deferred_.clear();
+  }
+  else if (deferred_.empty() && expectContinue_)
+  {
+    // held back till the responses before it are sent
+    output_.append("HTTP/1.1 100 Continue\r\n\r\n");
+    continueSent();
+  }
+  if (output_.readableBytes() > 0)
+  {
+    conn->send(&output_);
+  }
+  if (close)
+  {
+    conn->shutdown();
+  }
+  else if (readStopped_ && deferred_.size() <= maxPending_ / 2)
+  {
+    readStopped_ = false;
+    conn->startRead();
+    if (resumeCallback_)
     {
-      // FIXME:
+      resumeCallback_(conn);
     }
   }
-  return ok;
 }
@@ -13,15 +13,21 @@
 
 #include <muduo/base/copyable.h>
 
+#include <muduo/net/Buffer.h>
+#include <muduo/net/Callbacks.h>
+#include <muduo/net/http/HttpDeferredResponse.h>
+#include <muduo/net/http/HttpParser.h>
 #include <muduo/net/http/HttpRequest.h>
+#include <muduo/net/http/HttpResponse.h>
+
+#include <deque>
+#include <functional>
 
 namespace muduo
 {
 namespace net
 {
 
-class Buffer;
-
 //协议解析类
 class HttpContext : public muduo::copyable
 {
@@ -31,29 +37,77 @@ class HttpContext : public muduo::copyable
     kExpectRequestLine,  //当前正处于解析请求行的状态
     kExpectHeaders,      //正处于解析头部信息的状态
     kExpectBody,         //当前正处于解析实体的状态
+    kExpectChunkSize,    // chunk-size [; ext] CRLF
+    kExpectChunkData,
+    kExpectChunkEnd,     // CRLF after chunk-data
+    kExpectTrailers,     // after the last chunk, till an empty line
     kGotAll,             //全部解析完毕的状态
   };
 
+  /// Gets the body piece by piece, instead of HttpRequest::body().
+  typedef std::function<void (const HttpRequest&, StringPiece)> BodyCallback;
+  /// Parses what's left in the input buffer, once reading resumes.
+  typedef std::function<void (const TcpConnectionPtr&)> ResumeCallback;
+
+  static const size_t kDefaultMaxBodySize = 64 * 1024 * 1024;
+  static const size_t kDefaultMaxPending = 64;
+
   HttpContext()
-    : state_(kExpectRequestLine)
+    : state_(kExpectRequestLine),
+      bodyRemaining_(0),
+      maxBodySize_(kDefaultMaxBodySize),
+      maxPending_(kDefaultMaxPending),
+      readStopped_(false),
+      error_(HttpResponse::kUnknown),
+      expectContinue_(false),
+      response_(false)
   {
   }
 
   // default copy-ctor, dtor and assignment are fine
 
-  // return false if any error
+  void setBodyCallback(const BodyCallback& cb)
+  { bodyCallback_ = cb; }
+
+  /// Of a body kept in HttpRequest, larger ones get 413.
+  void setMaxBodySize(size_t bytes)
+  { maxBodySize_ = bytes; }
+
+  /// Of deferred(), reading stops at that many, till half are sent.
+  void setMaxPending(size_t n)
+  { maxPending_ = n; }
+
+  void setResumeCallback(const ResumeCallback& cb)
+  { resumeCallback_ = cb; }
+
+  /// Parses as far as the end of one request, what follows stays in buf.
+  /// return false if any error, error() tells the status to reply with
   bool parseRequest(Buffer* buf, Timestamp receiveTime);
 
   bool gotAll() const
   { return state_ == kGotAll; }
 
+  HttpResponse::HttpStatusCode error() const
+  { return error_; }
+
+  /// The client sent "Expect: 100-continue" and waits for the body to
+  /// be asked for.
+  bool expectContinue() const
+  { return expectContinue_; }
+
+  void continueSent()
+  { expectContinue_ = false; }
+
   //重置HttpContext状态 
   void reset()
   {
     state_ = kExpectRequestLine;
-    HttpRequest dummy;
-    //把http请求置空掉
-    request_.swap(dummy);
+    parser_.reset();
+    bodyRemaining_ = 0;
+    error_ = HttpResponse::kUnknown;
+    expectContinue_ = false;
+    //把http请求置空掉，留着分配好的空间
+    request_.reset();
   }
 
   const HttpRequest& request() const
@@ -62,11 +116,60 @@ class HttpContext : public muduo::copyable
   HttpRequest& request()
   { return request_; }
 
+  /// Reused for every request on the connection, as is output().
+  HttpResponse* response()
+  { return &response_; }
+
+  Buffer* output()
+  { return &output_; }
+
+  /// Serializes response to request into output(), a file body is
+  /// sent after what's in output() so far.
+  /// return true if the connection is to be closed after it.
+  bool appendResponse(const TcpConnectionPtr& conn,
+                      const HttpRequest& request,
+                      HttpResponse* response);
+
+  /// Waiting to be done, in the order of requests.
+  std::deque<HttpDeferredResponsePtr>& deferred()
+  { return deferred_; }
+
+  /// Stops reading the connection if deferred() is full,
+  /// return true if so, parse no more till resumed.
+  bool stopReadIfFull(const TcpConnectionPtr& conn);
+
+  /// Sends what's done at the front of deferred(), then 100 Continue if
+  /// the request being read waits for it, resumes reading if stopped.
+  void sendDeferred(const TcpConnectionPtr& conn);
+
  private:
-  bool processRequestLine(const char* begin, const char* end);
+  bool parseHead(Buffer* buf, Timestamp receiveTime);
+  bool fillRequest(const char* begin);
+  bool startBody();
+  bool readBody(Buffer* buf);
+  bool parseChunkSize(Buffer* buf);
+  bool parseChunkEnd(Buffer* buf);
+  bool parseTrailers(Buffer* buf);
+  bool fail(HttpResponse::HttpStatusCode code)
+  {
+    error_ = code;
+    return false;
+  }
 
   HttpRequestParseState state_;    //请求解析状态
+  HttpParser parser_;              // the head stays in the Buffer till parsed
+  size_t bodyRemaining_;           // of Content-Length, or of this chunk
+  size_t maxBodySize_;
+  size_t maxPending_;
+  bool readStopped_;               // by stopReadIfFull()
+  HttpResponse::HttpStatusCode error_;
+  bool expectContinue_;
+  BodyCallback bodyCallback_;
+  ResumeCallback resumeCallback_;
   HttpRequest request_;            //http请求
+  HttpResponse response_;
+  Buffer output_;                  // responses serialized, then sent
+  std::deque<HttpDeferredResponsePtr> deferred_;
 };
 
 }  // namespace net
@@ -0,0 +1,52 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+
+#include <muduo/net/http/HttpDeferredResponse.h>
+
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/TcpConnection.h>
+#include <muduo/net/http/HttpContext.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+HttpDeferredResponse::HttpDeferredResponse(const TcpConnectionPtr& conn,
+                                           HttpRequest* request,
+                                           bool close)
+  : loop_(conn->getLoop()),
+    conn_(conn),
+    response_(close),
+    done_(false)
+{
+  request_.swap(*request);
+}
+
+void HttpDeferredResponse::done()
+{
+  // not locked here, or the connection could be destroyed out of its loop.
+  // queued even in the loop, so the responses to requests of one message
+  // go out together after it
+  loop_->queueInLoop(
+      std::bind(&HttpDeferredResponse::doneInLoop, conn_, shared_from_this()));
+}
+
+void HttpDeferredResponse::doneInLoop(const std::weak_ptr<TcpConnection>& weakConn,
+                                      const HttpDeferredResponsePtr& self)
+{
+  self->done_ = true;
+  TcpConnectionPtr conn(weakConn.lock());
+  if (conn)
+  {
+    HttpContext* context = boost::any_cast<HttpContext>(conn->getMutableContext());
+    if (context)
+    {
+      context->sendDeferred(conn);
+    }
+  }
+}
@@ -0,0 +1,80 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef MUDUO_NET_HTTP_HTTPDEFERREDRESPONSE_H
+#define MUDUO_NET_HTTP_HTTPDEFERREDRESPONSE_H
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/net/Callbacks.h>
+#include <muduo/net/http/HttpRequest.h>
+#include <muduo/net/http/HttpResponse.h>
+
+#include <memory>
+
+namespace muduo
+{
+namespace net
+{
+
+class EventLoop;
+class HttpDeferredResponse;
+typedef std::shared_ptr<HttpDeferredResponse> HttpDeferredResponsePtr;
+
+///
+/// A request and its response, the response is sent when done() is
+/// called, from any thread.  Responses on a connection go out in the
+/// order of requests, one that's done waits for those before it.
+///
+///   server.setDeferredHttpCallback([&pool](const HttpDeferredResponsePtr& d) {
+///     pool.run([d] {
+///       d->response()->setStatusCode(HttpResponse::k200Ok);
+///       d->response()->setBody(compute(d->request()));
+///       d->done();
+///     });
+///   });
+///
+/// done() must be called, the connection gets nothing after it till then.
+///
+class HttpDeferredResponse : noncopyable,
+                             public std::enable_shared_from_this<HttpDeferredResponse>
+{
+ public:
+  /// Takes the content of request, not a copy.
+  HttpDeferredResponse(const TcpConnectionPtr& conn, HttpRequest* request, bool close);
+
+  const HttpRequest& request() const
+  { return request_; }
+
+  /// Not thread safe, by whoever is to call done().
+  HttpResponse* response()
+  { return &response_; }
+
+  /// Thread safe, call once, response() is not to be touched after.
+  void done();
+
+  /// In the loop of the connection only.
+  bool isDone() const
+  { return done_; }
+
+ private:
+  static void doneInLoop(const std::weak_ptr<TcpConnection>& weakConn,
+                         const HttpDeferredResponsePtr& self);
+
+  EventLoop* loop_;
+  std::weak_ptr<TcpConnection> conn_;
+  HttpRequest request_;
+  HttpResponse response_;
+  bool done_;
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_HTTP_HTTPDEFERREDRESPONSE_H
@@ -0,0 +1,211 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+
+#include <muduo/net/http/HttpFileCache.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+namespace
+{
+
+// not strftime(3), which follows the locale
+const char kDays[][4] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+const char kMonths[][4] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                            "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+}  // namespace
+
+HttpFileCache::File::File(int fd, const struct stat& st)
+  : fd_(fd),
+    device_(st.st_dev),
+    inode_(st.st_ino),
+    size_(st.st_size),
+    modifiedTime_(st.st_mtime)
+{
+  char buf[64];
+  snprintf(buf, sizeof buf, "\"%lx-%lx\"",
+           static_cast<unsigned long>(modifiedTime_),
+           static_cast<unsigned long>(size_));
+  etag_ = buf;
+  lastModified_ = formatHttpDate(modifiedTime_);
+}
+
+HttpFileCache::File::~File()
+{
+  ::close(fd_);
+}
+
+bool HttpFileCache::File::sameAs(const struct stat& st) const
+{
+  return st.st_dev == device_ && st.st_ino == inode_
+      && st.st_size == size_ && st.st_mtime == modifiedTime_;
+}
+
+HttpFileCache::HttpFileCache(int maxFiles, double revalidateSeconds)
+  : maxFiles_(maxFiles),
+    revalidateSeconds_(revalidateSeconds)
+{
+}
+
+HttpFileCache::FilePtr HttpFileCache::open(const string& path, Timestamp now)
+{
+  FilePtr cached;
+  {
+    MutexLockGuard lock(mutex_);
+    auto it = files_.find(path);
+    if (it != files_.end())
+    {
+      Entry& entry = it->second;
+      lru_.splice(lru_.begin(), lru_, entry.lru);
+      if (timeDifference(now, entry.checked) < revalidateSeconds_)
+      {
+        return entry.file;
+      }
+      cached = entry.file;
+    }
+  }
+
+  // syscalls out of the lock
+  struct stat st;
+  if (cached && ::stat(path.c_str(), &st) == 0 && cached->sameAs(st))
+  {
+    MutexLockGuard lock(mutex_);
+    auto it = files_.find(path);
+    if (it != files_.end() && it->second.file == cached)
+    {
+      it->second.checked = now;
+    }
+    return cached;
+  }
+
+  // O_NONBLOCK, or a FIFO would block the IO thread
+  int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0)
+  {
+    int savedErrno = errno;
+    remove(path);
+    errno = savedErrno;
+    return FilePtr();
+  }
+  int savedErrno = 0;
+  if (::fstat(fd, &st) != 0)
+  {
+    savedErrno = errno;
+  }
+  else if (!S_ISREG(st.st_mode))
+  {
+    savedErrno = S_ISDIR(st.st_mode) ? EISDIR : EACCES;
+  }
+  if (savedErrno != 0)
+  {
+    ::close(fd);
+    remove(path);
+    errno = savedErrno;
+    return FilePtr();
+  }
+  FilePtr file(std::make_shared<const File>(fd, st));
+  insert(path, file, now);
+  return file;
+}
+
+size_t HttpFileCache::size() const
+{
+  MutexLockGuard lock(mutex_);
+  return files_.size();
+}
+
+void HttpFileCache::insert(const string& path, const FilePtr& file, Timestamp now)
+{
+  MutexLockGuard lock(mutex_);
+  auto it = files_.find(path);
+  if (it != files_.end())
+  {
+    it->second.file = file;
+    it->second.checked = now;
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return;
+  }
+  lru_.push_front(path);
+  Entry& entry = files_[path];
+  entry.file = file;
+  entry.checked = now;
+  entry.lru = lru_.begin();
+  while (static_cast<int>(files_.size()) > maxFiles_)
+  {
+    // closed once the last sending it is done
+    files_.erase(lru_.back());
+    lru_.pop_back();
+  }
+}
+
+void HttpFileCache::remove(const string& path)
+{
+  MutexLockGuard lock(mutex_);
+  auto it = files_.find(path);
+  if (it != files_.end())
+  {
+    lru_.erase(it->second.lru);
+    files_.erase(it);
+  }
+}
+
+string HttpFileCache::formatHttpDate(time_t t)
+{
+  struct tm tm;
+  ::gmtime_r(&t, &tm);
+  // 29 bytes of a 4-digit year, room for what an int prints
+  char buf[64];
+  snprintf(buf, sizeof buf, "%s, %02d %s %04d %02d:%02d:%02d GMT",
+           kDays[tm.tm_wday], tm.tm_mday, kMonths[tm.tm_mon], tm.tm_year + 1900,
+           tm.tm_hour, tm.tm_min, tm.tm_sec);
+  return buf;
+}
+
+time_t HttpFileCache::parseHttpDate(StringPiece date)
+{
+  // "Sun, 06 Nov 1994 08:49:37 GMT"
+  if (date.size() != 29)
+  {
+    return -1;
+  }
+  char buf[30];
+  memcpy(buf, date.data(), date.size());
+  buf[date.size()] = '\0';
+  char month[4] = "";
+  struct tm tm;
+  memZero(&tm, sizeof tm);
+  if (sscanf(buf, "%*3s, %2d %3s %4d %2d:%2d:%2d GMT",
+             &tm.tm_mday, month, &tm.tm_year,
+             &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6)
+  {
+    return -1;
+  }
+  tm.tm_mon = -1;
+  for (int i = 0; i < 12; ++i)
+  {
+    if (memcmp(month, kMonths[i], 4) == 0)
+    {
+      tm.tm_mon = i;
+    }
+  }
+  if (tm.tm_mon < 0)
+  {
+    return -1;
+  }
+  tm.tm_year -= 1900;
+  return ::timegm(&tm);
+}
@@ -0,0 +1,109 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef MUDUO_NET_HTTP_HTTPFILECACHE_H
+#define MUDUO_NET_HTTP_HTTPFILECACHE_H
+
+#include <muduo/base/Mutex.h>
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/StringPiece.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/base/Types.h>
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include <sys/stat.h>
+
+namespace muduo
+{
+namespace net
+{
+
+///
+/// Open regular files by path, with their stat and validators, the least
+/// recently used ones are dropped beyond maxFiles.
+///
+/// A file is closed when the last holder releases it, not on eviction,
+/// so one being sent with TcpConnection::sendFile() stays open.  A path
+/// is stat'ed again after revalidateSeconds, a file replaced or changed
+/// is opened again, till then a hit makes no syscall.
+///
+class HttpFileCache : noncopyable
+{
+ public:
+  class File : noncopyable
+  {
+   public:
+    File(int fd, const struct stat& st);
+    ~File();
+
+    int fd() const { return fd_; }
+    off_t size() const { return size_; }
+    time_t modifiedTime() const { return modifiedTime_; }
+    /// "mtime-size" in hex, quoted, strong.
+    const string& etag() const { return etag_; }
+    /// IMF-fixdate of RFC 7231, eg. "Sun, 06 Nov 1994 08:49:37 GMT".
+    const string& lastModified() const { return lastModified_; }
+
+    /// Same file, unchanged.
+    bool sameAs(const struct stat& st) const;
+
+   private:
+    const int fd_;
+    const dev_t device_;
+    const ino_t inode_;
+    const off_t size_;
+    const time_t modifiedTime_;
+    string etag_;
+    string lastModified_;
+  };
+  typedef std::shared_ptr<const File> FilePtr;
+
+  static const int kDefaultMaxFiles = 1024;
+
+  explicit HttpFileCache(int maxFiles = kDefaultMaxFiles,
+                         double revalidateSeconds = 1.0);
+
+  /// NULL if path is not a regular file that can be read, errno tells
+  /// why, EISDIR for a directory.
+  /// Thread safe.
+  FilePtr open(const string& path, Timestamp now = Timestamp::now());
+
+  size_t size() const;
+
+  /// Formats t as an IMF-fixdate.
+  static string formatHttpDate(time_t t);
+  /// Of an IMF-fixdate, -1 if not one, the obsolete formats aren't taken.
+  static time_t parseHttpDate(StringPiece date);
+
+ private:
+  struct Entry
+  {
+    FilePtr file;
+    Timestamp checked;
+    std::list<string>::iterator lru;
+  };
+
+  void insert(const string& path, const FilePtr& file, Timestamp now);
+  void remove(const string& path);
+
+  const int maxFiles_;
+  const double revalidateSeconds_;
+  mutable MutexLock mutex_;
+  std::list<string> lru_ GUARDED_BY(mutex_);  // most recently used first
+  std::unordered_map<string, Entry> files_ GUARDED_BY(mutex_);
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_HTTP_HTTPFILECACHE_H
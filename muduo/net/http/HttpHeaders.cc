@@ -0,0 +1,210 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+
+#include <muduo/net/http/HttpHeaders.h>
+
+#include <assert.h>
+#include <strings.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+namespace
+{
+
+// in the order of HttpHeaders::Field
+const StringPiece kFieldNames[] =
+{
+  "Accept",
+  "Accept-Encoding",
+  "Authorization",
+  "Cache-Control",
+  "Connection",
+  "Content-Encoding",
+  "Content-Length",
+  "Content-Range",
+  "Content-Type",
+  "Cookie",
+  "Date",
+  "ETag",
+  "Expect",
+  "Host",
+  "If-Modified-Since",
+  "If-None-Match",
+  "If-Range",
+  "Keep-Alive",
+  "Last-Modified",
+  "Location",
+  "Range",
+  "Server",
+  "Set-Cookie",
+  "Transfer-Encoding",
+  "User-Agent",
+};
+
+static_assert(sizeof kFieldNames / sizeof kFieldNames[0] == HttpHeaders::kNumFields,
+              "kFieldNames");
+
+bool equalsIgnoreCase(StringPiece a, StringPiece b)
+{
+  return a.size() == b.size() && ::strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+}  // namespace
+
+StringPiece HttpHeaders::fieldName(Field field)
+{
+  assert(field > kOther && field < kNumFields);
+  return static_cast<unsigned>(field) < kNumFields ? kFieldNames[field] : StringPiece();
+}
+
+HttpHeaders::Field HttpHeaders::lookup(StringPiece name)
+{
+  // the length and the first letter rule out almost all
+  for (int i = 0; i < kNumFields; ++i)
+  {
+    const StringPiece& known = kFieldNames[i];
+    if (known.size() == name.size()
+        && (known[0] | 0x20) == (name[0] | 0x20)
+        && ::strncasecmp(known.data(), name.data(), name.size()) == 0)
+    {
+      return static_cast<Field>(i);
+    }
+  }
+  return kOther;
+}
+
+void HttpHeaders::add(StringPiece name, StringPiece value)
+{
+  addEntry(lookup(name), name, value);
+}
+
+void HttpHeaders::add(Field field, StringPiece value)
+{
+  addEntry(field, StringPiece(), value);
+}
+
+void HttpHeaders::addEntry(Field field, StringPiece name, StringPiece value)
+{
+  Entry e;
+  e.field = field;
+  e.name = -1;
+  e.nameLen = name.size();
+  if (name.data() != NULL)
+  {
+    e.name = arena_.size();
+    arena_.append(name.data(), name.size());
+  }
+  e.value = arena_.size();
+  e.valueLen = value.size();
+  arena_.append(value.data(), value.size());
+  entries_.push_back(e);
+}
+
+void HttpHeaders::set(StringPiece name, StringPiece value)
+{
+  remove(name);
+  add(name, value);
+}
+
+void HttpHeaders::set(Field field, StringPiece value)
+{
+  remove(field);
+  add(field, value);
+}
+
+// what they took in arena_ is freed by clear()
+void HttpHeaders::remove(StringPiece name)
+{
+  int i;
+  while ((i = find(name)) >= 0)
+  {
+    entries_.erase(i);
+  }
+}
+
+void HttpHeaders::remove(Field field)
+{
+  int i;
+  while ((i = find(field)) >= 0)
+  {
+    entries_.erase(i);
+  }
+}
+
+StringPiece HttpHeaders::get(StringPiece name) const
+{
+  int i = find(name);
+  return i >= 0 ? value(i) : StringPiece();
+}
+
+StringPiece HttpHeaders::get(Field field) const
+{
+  int i = find(field);
+  return i >= 0 ? value(i) : StringPiece();
+}
+
+int HttpHeaders::find(Field field) const
+{
+  for (int i = 0; i < entries_.size(); ++i)
+  {
+    if (entries_[i].field == field)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int HttpHeaders::find(StringPiece name) const
+{
+  Field field = lookup(name);
+  if (field != kOther)
+  {
+    return find(field);
+  }
+  for (int i = 0; i < entries_.size(); ++i)
+  {
+    if (entries_[i].field == kOther && equalsIgnoreCase(this->name(i), name))
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int HttpHeaders::serializedSize() const
+{
+  int n = 0;
+  for (int i = 0; i < entries_.size(); ++i)
+  {
+    const Entry& e = entries_[i];
+    int nameLen = e.name < 0 ? fieldName(static_cast<Field>(e.field)).size() : e.nameLen;
+    n += nameLen + 2 + e.valueLen + 2;
+  }
+  return n;
+}
+
+char* HttpHeaders::serialize(char* buf) const
+{
+  for (int i = 0; i < entries_.size(); ++i)
+  {
+    StringPiece n = name(i);
+    StringPiece v = value(i);
+    memcpy(buf, n.data(), n.size());
+    buf += n.size();
+    *buf++ = ':';
+    *buf++ = ' ';
+    memcpy(buf, v.data(), v.size());
+    buf += v.size();
+    *buf++ = '\r';
+    *buf++ = '\n';
+  }
+  return buf;
+}
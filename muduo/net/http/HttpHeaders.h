@@ -0,0 +1,225 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef MUDUO_NET_HTTP_HTTPHEADERS_H
+#define MUDUO_NET_HTTP_HTTPHEADERS_H
+
+#include <muduo/base/copyable.h>
+#include <muduo/base/StringPiece.h>
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include <string.h>
+
+namespace muduo
+{
+namespace net
+{
+
+namespace detail
+{
+
+// The first N in place, then on the heap, which is kept by clear().
+// For trivially copyable T only, elements are moved with memcpy.
+template<typename T, int N>
+class SmallVector
+{
+  static_assert(std::is_trivial<T>::value, "memcpy'ed");
+ public:
+  SmallVector()
+    : inline_(),
+      size_(0)
+  {
+  }
+
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  int capacity() const
+  { return heap_.empty() ? N : static_cast<int>(heap_.size()); }
+
+  T* data() { return heap_.empty() ? inline_ : &heap_[0]; }
+  const T* data() const { return heap_.empty() ? inline_ : &heap_[0]; }
+
+  T& operator[](int i) { return data()[i]; }
+  const T& operator[](int i) const { return data()[i]; }
+
+  void append(const T* p, int n)
+  {
+    reserve(size_ + n);
+    if (n > 0)
+    {
+      memcpy(data() + size_, p, n * sizeof(T));
+    }
+    size_ += n;
+  }
+
+  void push_back(const T& x) { append(&x, 1); }
+
+  void erase(int i)
+  {
+    T* d = data();
+    memmove(d + i, d + i + 1, (size_ - i - 1) * sizeof(T));
+    --size_;
+  }
+
+  void clear() { size_ = 0; }
+
+  void reserve(int n)
+  {
+    int cap = capacity();
+    if (n > cap)
+    {
+      std::vector<T> bigger(std::max(n, 2 * cap));
+      memcpy(&bigger[0], data(), size_ * sizeof(T));
+      heap_.swap(bigger);
+    }
+  }
+
+  void swap(SmallVector& that)
+  {
+    std::swap_ranges(inline_, inline_ + N, that.inline_);
+    heap_.swap(that.heap_);
+    std::swap(size_, that.size_);
+  }
+
+ private:
+  T inline_[N];
+  std::vector<T> heap_;
+  int size_;
+};
+
+}  // namespace detail
+
+///
+/// Headers of an HTTP message, in the order they're added.
+///
+/// Names and values are copied one after another into an arena, in
+/// place for a usual request, entries are offsets into it.  Nothing is
+/// allocated per header, and clear() keeps what has been allocated, for
+/// the next message on the connection.
+///
+/// Names compare case-insensitively, as RFC 7230 says.  Common names
+/// are recognized once when added, looking them up is an int compare.
+///
+class HttpHeaders : public muduo::copyable
+{
+ public:
+  enum Field
+  {
+    kOther = -1,
+    kAccept,
+    kAcceptEncoding,
+    kAuthorization,
+    kCacheControl,
+    kConnection,
+    kContentEncoding,
+    kContentLength,
+    kContentRange,
+    kContentType,
+    kCookie,
+    kDate,
+    kETag,
+    kExpect,
+    kHost,
+    kIfModifiedSince,
+    kIfNoneMatch,
+    kIfRange,
+    kKeepAlive,
+    kLastModified,
+    kLocation,
+    kRange,
+    kServer,
+    kSetCookie,
+    kTransferEncoding,
+    kUserAgent,
+    kNumFields
+  };
+
+  /// as spelled in RFC 7231 etc.
+  static StringPiece fieldName(Field field);
+  /// kOther if name is not a common one
+  static Field lookup(StringPiece name);
+
+  void add(StringPiece name, StringPiece value);
+  void add(Field field, StringPiece value);
+
+  /// Replaces any of the same name.
+  void set(StringPiece name, StringPiece value);
+  void set(Field field, StringPiece value);
+
+  void remove(StringPiece name);
+  void remove(Field field);
+
+  /// The first of the name, empty if none.
+  StringPiece get(StringPiece name) const;
+  StringPiece get(Field field) const;
+
+  bool contains(StringPiece name) const { return find(name) >= 0; }
+  bool contains(Field field) const { return find(field) >= 0; }
+
+  int size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+
+  StringPiece name(int i) const
+  {
+    const Entry& e = entries_[i];
+    return e.name < 0 ? fieldName(static_cast<Field>(e.field))
+                      : StringPiece(arena_.data() + e.name, e.nameLen);
+  }
+
+  StringPiece value(int i) const
+  {
+    const Entry& e = entries_[i];
+    return StringPiece(arena_.data() + e.value, e.valueLen);
+  }
+
+  Field field(int i) const { return static_cast<Field>(entries_[i].field); }
+
+  /// Bytes of name: value\r\n of all.
+  int serializedSize() const;
+  /// Writes name: value\r\n of all at buf, which has serializedSize().
+  char* serialize(char* buf) const;
+
+  void clear()
+  {
+    entries_.clear();
+    arena_.clear();
+  }
+
+  void swap(HttpHeaders& that)
+  {
+    entries_.swap(that.entries_);
+    arena_.swap(that.arena_);
+  }
+
+ private:
+  struct Entry
+  {
+    int name;       // offset in arena_, -1 for fieldName(field)
+    int nameLen;
+    int value;
+    int valueLen;
+    int field;
+  };
+
+  int find(StringPiece name) const;
+  int find(Field field) const;
+  void addEntry(Field field, StringPiece name, StringPiece value);
+
+  detail::SmallVector<Entry, 16> entries_;
+  detail::SmallVector<char, 512> arena_;
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_HTTP_HTTPHEADERS_H
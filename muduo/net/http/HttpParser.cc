@@ -0,0 +1,227 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+
+#include <muduo/net/http/HttpParser.h>
+
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace muduo;
+using namespace muduo::net;
+
+namespace
+{
+
+// tchar of RFC 7230 section 3.2.6, no whitespace, CTL or separator
+bool isTokenChar(char c)
+{
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+      || (c != '\0' && strchr("!#$%&'*+-.^_`|~", c) != NULL);
+}
+
+}  // namespace
+
+const char* detail::findEitherScalar(const char* begin, const char* end, char a, char b)
+{
+  const char* p = begin;
+  while (p < end && *p != a && *p != b)
+  {
+    ++p;
+  }
+  return p;
+}
+
+// Unaligned loads, never past end, the tail is done byte by byte.
+const char* detail::findEither(const char* begin, const char* end, char a, char b)
+{
+  const char* p = begin;
+#if defined(__AVX2__)
+  const __m256i va32 = _mm256_set1_epi8(a);
+  const __m256i vb32 = _mm256_set1_epi8(b);
+  while (end - p >= 32)
+  {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i eq = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, va32), _mm256_cmpeq_epi8(chunk, vb32));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+    if (mask != 0)
+    {
+      return p + __builtin_ctz(mask);
+    }
+    p += 32;
+  }
+#endif
+#if defined(__SSE2__)
+  const __m128i va16 = _mm_set1_epi8(a);
+  const __m128i vb16 = _mm_set1_epi8(b);
+  while (end - p >= 16)
+  {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i eq = _mm_or_si128(_mm_cmpeq_epi8(chunk, va16), _mm_cmpeq_epi8(chunk, vb16));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+    if (mask != 0)
+    {
+      return p + __builtin_ctz(mask);
+    }
+    p += 16;
+  }
+#endif
+  return findEitherScalar(p, end, a, b);
+}
+
+void HttpParser::reset()
+{
+  next_ = 0;
+  gotRequestLine_ = false;
+  method_ = Range{0, 0};
+  path_ = Range{0, 0};
+  query_ = Range{0, 0};
+  minorVersion_ = -1;
+  // keeps its capacity, for the next request on the connection
+  headers_.clear();
+}
+
+HttpParser::Result HttpParser::parse(const char* begin, const char* end)
+{
+  const char* line = begin + next_;
+  while (line < end)
+  {
+    const char* colon = NULL;
+    const char* cr = NULL;
+    if (gotRequestLine_)
+    {
+      // one pass for both, most lines have a colon
+      colon = detail::findEither(line, end, ':', '\r');
+      if (colon != end && *colon == ':')
+      {
+        cr = detail::findEither(colon + 1, end, '\r', '\n');
+      }
+      else
+      {
+        cr = colon;
+        colon = NULL;
+      }
+    }
+    else
+    {
+      cr = detail::findEither(line, end, '\r', '\n');
+    }
+
+    if (end - cr < 2)
+    {
+      // the rest of this line is yet to come
+      return kIncomplete;
+    }
+    if (cr[0] != '\r' || cr[1] != '\n')
+    {
+      return kError;
+    }
+
+    if (!gotRequestLine_)
+    {
+      if (!parseRequestLine(begin, line, cr))
+      {
+        return kError;
+      }
+      gotRequestLine_ = true;
+    }
+    else if (cr == line)
+    {
+      // empty line, end of headers
+      next_ = static_cast<int>(cr + 2 - begin);
+      return kComplete;
+    }
+    else if (colon == NULL || !parseHeader(begin, line, colon, cr))
+    {
+      return kError;
+    }
+    line = cr + 2;
+    next_ = static_cast<int>(line - begin);
+  }
+  return kIncomplete;
+}
+
+// METHOD SP path[?query] SP HTTP/1.x
+bool HttpParser::parseRequestLine(const char* begin, const char* line, const char* cr)
+{
+  const char* space = static_cast<const char*>(memchr(line, ' ', cr - line));
+  if (space == NULL || space == line)
+  {
+    return false;
+  }
+  method_ = Range{static_cast<int>(line - begin), static_cast<int>(space - line)};
+
+  const char* start = space + 1;
+  const char* question = detail::findEither(start, cr, '?', ' ');
+  space = question;
+  if (question != cr && *question == '?')
+  {
+    space = static_cast<const char*>(memchr(question, ' ', cr - question));
+  }
+  else
+  {
+    question = NULL;
+  }
+  if (space == NULL || space == cr)
+  {
+    return false;
+  }
+  const char* pathEnd = question ? question : space;
+  path_ = Range{static_cast<int>(start - begin), static_cast<int>(pathEnd - start)};
+  if (question)
+  {
+    query_ = Range{static_cast<int>(question - begin), static_cast<int>(space - question)};
+  }
+
+  start = space + 1;
+  if (cr - start != 8 || memcmp(start, "HTTP/1.", 7) != 0
+      || (start[7] != '0' && start[7] != '1'))
+  {
+    return false;
+  }
+  minorVersion_ = start[7] - '0';
+  return true;
+}
+
+bool HttpParser::parseHeader(const char* begin, const char* line,
+                             const char* colon, const char* cr)
+{
+  // no space before the colon either, a proxy might take
+  // "Transfer-Encoding : chunked" differently, nor an obs-fold
+  if (colon == line)
+  {
+    return false;
+  }
+  for (const char* p = line; p < colon; ++p)
+  {
+    if (!isTokenChar(*p))
+    {
+      return false;
+    }
+  }
+  const char* value = colon + 1;
+  while (value < cr && (*value == ' ' || *value == '\t'))
+  {
+    ++value;
+  }
+  const char* valueEnd = cr;
+  while (valueEnd > value && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t'))
+  {
+    --valueEnd;
+  }
+  Header header;
+  header.name = Range{static_cast<int>(line - begin), static_cast<int>(colon - line)};
+  header.value = Range{static_cast<int>(value - begin), static_cast<int>(valueEnd - value)};
+  headers_.push_back(header);
+  return true;
+}
@@ -0,0 +1,102 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+// This is an internal header file, you should not include this.
+
+#ifndef MUDUO_NET_HTTP_HTTPPARSER_H
+#define MUDUO_NET_HTTP_HTTPPARSER_H
+
+#include <muduo/base/copyable.h>
+#include <muduo/base/StringPiece.h>
+
+#include <vector>
+
+namespace muduo
+{
+namespace net
+{
+
+namespace detail
+{
+// first of a or b in [begin, end), or end,
+// 32 or 16 bytes at a time with AVX2 or SSE2
+const char* findEither(const char* begin, const char* end, char a, char b);
+const char* findEitherScalar(const char* begin, const char* end, char a, char b);
+}  // namespace detail
+
+///
+/// Incremental parser of the head of an HTTP/1.x request.
+///
+/// It doesn't copy anything: the request line and headers are recorded
+/// as offsets into the input, from where the request begins.  Call
+/// parse() again with the same begin when more has arrived, lines parsed
+/// are not scanned again.
+///
+class HttpParser : public muduo::copyable
+{
+ public:
+  enum Result
+  {
+    kError,
+    kIncomplete,
+    kComplete,
+  };
+
+  /// [offset, offset+len) of the request
+  struct Range
+  {
+    int offset;
+    int len;
+  };
+
+  struct Header
+  {
+    Range name;
+    Range value;   // spaces around trimmed
+  };
+
+  HttpParser() { reset(); }
+
+  void reset();
+
+  /// [begin, end) is what's received so far, begin is not to change
+  /// till kComplete or reset().
+  Result parse(const char* begin, const char* end);
+
+  bool gotRequestLine() const { return gotRequestLine_; }
+
+  Range method() const { return method_; }
+  Range path() const { return path_; }
+  /// with '?', empty if none
+  Range query() const { return query_; }
+  /// 0 or 1 for HTTP/1.0 or HTTP/1.1
+  int minorVersion() const { return minorVersion_; }
+  const std::vector<Header>& headers() const { return headers_; }
+  /// Bytes of the request line and headers, empty line included.
+  int headLength() const { return next_; }
+
+  static StringPiece view(const char* begin, Range r)
+  { return StringPiece(begin + r.offset, r.len); }
+
+ private:
+  bool parseRequestLine(const char* begin, const char* line, const char* cr);
+  bool parseHeader(const char* begin, const char* line, const char* colon, const char* cr);
+
+  int next_;            // the next line begins here
+  bool gotRequestLine_;
+  Range method_;
+  Range path_;
+  Range query_;
+  int minorVersion_;
+  std::vector<Header> headers_;
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_HTTP_HTTPPARSER_H
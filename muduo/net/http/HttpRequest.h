@@ -14,10 +14,11 @@
 #include <muduo/base/copyable.h>
 #include <muduo/base/Timestamp.h>
 #include <muduo/base/Types.h>
+#include <muduo/net/http/HttpHeaders.h>
 
-#include <map>
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 namespace muduo
 {
@@ -56,24 +57,25 @@ class HttpRequest : public muduo::copyable
   bool setMethod(const char* start, const char* end)
   {
     assert(method_ == kInvalid);
-    string m(start, end);
-    if (m == "GET")
+    // compared in place, no string of it
+    size_t len = end - start;
+    if (len == 3 && memcmp(start, "GET", 3) == 0)
     {
       method_ = kGet;
     }
-    else if (m == "POST")
+    else if (len == 4 && memcmp(start, "POST", 4) == 0)
     {
       method_ = kPost;
     }
-    else if (m == "HEAD")
+    else if (len == 4 && memcmp(start, "HEAD", 4) == 0)
     {
       method_ = kHead;
     }
-    else if (m == "PUT")
+    else if (len == 3 && memcmp(start, "PUT", 3) == 0)
     {
       method_ = kPut;
     }
-    else if (m == "DELETE")
+    else if (len == 6 && memcmp(start, "DELETE", 6) == 0)
     {
       method_ = kDelete;
     }
@@ -138,38 +140,61 @@ class HttpRequest : public muduo::copyable
   //colon 表示冒号所在的位置
   void addHeader(const char* start, const char* colon, const char* end)
   {
-    string field(start, colon);  //header域
+    const char* field = start;
+    const char* fieldEnd = colon;
     ++colon;
     //去除左边空格
     while (colon < end && isspace(*colon))
     {
       ++colon;
     }
-    string value(colon, end);    //header值
     //去除右空格
-    while (!value.empty() && isspace(value[value.size()-1]))
+    while (end > colon && isspace(end[-1]))
     {
-      value.resize(value.size()-1);
+      --end;
     }
     //然后保存到header_里面
-    headers_[field] = value;
+    headers_.add(StringPiece(field, static_cast<int>(fieldEnd - field)),
+                 StringPiece(colon, static_cast<int>(end - colon)));
   }
 
-  //根据头域，返回它的值
+  /// value trimmed already
+  void addHeader(StringPiece field, StringPiece value)
+  { headers_.add(field, value); }
+
+  //根据头域，返回它的值，不分大小写
   string getHeader(const string& field) const
-  {
-    string result;
-    std::map<string, string>::const_iterator it = headers_.find(field);
-    if (it != headers_.end())
-    {
-      result = it->second;
-    }
-    return result;
-  }
+  { return headers_.get(field).as_string(); }
+
+  /// Doesn't copy, valid till the request is reset.
+  StringPiece header(StringPiece field) const
+  { return headers_.get(field); }
 
-  const std::map<string, string>& headers() const
+  StringPiece header(HttpHeaders::Field field) const
+  { return headers_.get(field); }
+
+  const HttpHeaders& headers() const
   { return headers_; }
 
+  /// Empty if taken by a body callback of HttpServer.
+  const string& body() const
+  { return body_; }
+
+  void appendBody(const char* data, size_t len)
+  { body_.append(data, len); }
+
+  /// For the next request on the connection, keeps what's allocated.
+  void reset()
+  {
+    method_ = kInvalid;
+    version_ = kUnknown;
+    path_.clear();
+    query_.clear();
+    receiveTime_ = Timestamp();
+    headers_.clear();
+    body_.clear();
+  }
+
   //将数据成员交换就可以了
   void swap(HttpRequest& that)
   {
@@ -179,6 +204,7 @@ class HttpRequest : public muduo::copyable
     query_.swap(that.query_);
     receiveTime_.swap(that.receiveTime_);
     headers_.swap(that.headers_);
+    body_.swap(that.body_);
   }
 
  private:
@@ -187,7 +213,8 @@ class HttpRequest : public muduo::copyable
   string path_;      //请求路径
   string query_;     
   Timestamp receiveTime_;  //请求时间
-  std::map<string, string> headers_;   //header列表
+  HttpHeaders headers_;    //header列表
+  string body_;
 };
 
 }  // namespace net
@@ -10,40 +10,176 @@
 #include <muduo/net/http/HttpResponse.h>
 #include <muduo/net/Buffer.h>
 
-#include <stdio.h>
+#include <assert.h>
+#include <string.h>
 
 using namespace muduo;
 using namespace muduo::net;
 
+namespace
+{
+
+const StringPiece kConnectionClose("Connection: close\r\n");
+const StringPiece kConnectionKeepAlive("Connection: Keep-Alive\r\n");
+const StringPiece kContentLength("Content-Length: ");
+const StringPiece kTransferEncodingChunked("Transfer-Encoding: chunked\r\n");
+const StringPiece kLastChunk("0\r\n\r\n");
+
+char* append(char* p, StringPiece s)
+{
+  memcpy(p, s.data(), s.size());
+  return p + s.size();
+}
+
+// decimal digits of v at the end of buf[20], returns where they begin
+char* formatSize(size_t v, char* end)
+{
+  char* p = end;
+  do
+  {
+    *--p = static_cast<char>('0' + v % 10);
+    v /= 10;
+  } while (v != 0);
+  return p;
+}
+
+char* formatHex(size_t v, char* end)
+{
+  const char kHex[] = "0123456789abcdef";
+  char* p = end;
+  do
+  {
+    *--p = kHex[v % 16];
+    v /= 16;
+  } while (v != 0);
+  return p;
+}
+
+}  // namespace
+
+StringPiece HttpResponse::reasonPhrase(int code)
+{
+  switch (code)
+  {
+    case k200Ok: return "OK";
+    case k204NoContent: return "No Content";
+    case k206PartialContent: return "Partial Content";
+    case k301MovedPermanently: return "Moved Permanently";
+    case k302Found: return "Found";
+    case k304NotModified: return "Not Modified";
+    case k400BadRequest: return "Bad Request";
+    case k403Forbidden: return "Forbidden";
+    case k404NotFound: return "Not Found";
+    case k405MethodNotAllowed: return "Method Not Allowed";
+    case k413PayloadTooLarge: return "Payload Too Large";
+    case k416RangeNotSatisfiable: return "Range Not Satisfiable";
+    case k500InternalServerError: return "Internal Server Error";
+    case k501NotImplemented: return "Not Implemented";
+    case k503ServiceUnavailable: return "Service Unavailable";
+    default: return StringPiece();
+  }
+}
+
+void HttpResponse::appendChunk(Buffer* output, StringPiece data)
+{
+  // an empty one would be the last
+  if (data.empty())
+  {
+    return;
+  }
+  char sizeBuf[16];
+  char* sizeEnd = sizeBuf + sizeof sizeBuf;
+  char* size = formatHex(data.size(), sizeEnd);
+  size_t total = (sizeEnd - size) + 2 + data.size() + 2;
+  output->ensureWritableBytes(total);
+  char* p = append(output->beginWrite(), StringPiece(size, static_cast<int>(sizeEnd - size)));
+  p = append(p, "\r\n");
+  p = append(p, data);
+  append(p, "\r\n");
+  output->hasWritten(total);
+}
+
+void HttpResponse::appendLastChunk(Buffer* output)
+{
+  output->append(kLastChunk.data(), kLastChunk.size());
+}
+
 void HttpResponse::appendToBuffer(Buffer* output) const
 {
-  char buf[32];
-  //添加响应头
-  snprintf(buf, sizeof buf, "HTTP/1.1 %d ", statusCode_);
-  output->append(buf);
-  output->append(statusMessage_);
-  output->append("\r\n");
+  appendToBuffer(output, true);
+}
+
+void HttpResponse::appendHeadToBuffer(Buffer* output) const
+{
+  appendToBuffer(output, false);
+}
+
+void HttpResponse::appendToBuffer(Buffer* output, bool withBody) const
+{
+  StringPiece message = statusMessage_.empty() ? reasonPhrase(statusCode_)
+                                               : StringPiece(statusMessage_);
+  const bool chunked = chunked_ && !hasFileBody();
+  // no body by definition, nor Content-Length, RFC 7230 section 3.3.2
+  const bool contentLength = !closeConnection_
+      && statusCode_ != k204NoContent && statusCode_ != k304NotModified;
+  // empty with a file body, which is sent by the caller
+  StringPiece body(body_.data(), withBody ? static_cast<int>(body_.size()) : 0);
+  char lengthBuf[20];
+  char* lengthEnd = lengthBuf + sizeof lengthBuf;
+  char* length = formatSize(hasFileBody() ? fileLength_ : body_.size(), lengthEnd);
 
-  if (closeConnection_)
+  // "HTTP/1.1 200 " message "\r\n"
+  size_t total = 13 + message.size() + 2;
+  if (chunked)
   {
-    //如果是短连接，不需要告诉浏览器Content-Length，浏览器也能正确处理
-    output->append("Connection: close\r\n");
+    total += kTransferEncodingChunked.size();
   }
-  else  //如果是长连接
+  else if (contentLength)
   {
-    snprintf(buf, sizeof buf, "Content-Length: %zd\r\n", body_.size());
-    output->append(buf);
-    output->append("Connection: Keep-Alive\r\n");
+    total += kContentLength.size() + (lengthEnd - length) + 2;
   }
-  //header列表
-  for (const auto& header : headers_)
+  //如果是长连接
+  total += closeConnection_ ? kConnectionClose.size() : kConnectionKeepAlive.size();
+  total += headers_.serializedSize() + 2;
+  if (!chunked)
   {
-    output->append(header.first);
-    output->append(": ");
-    output->append(header.second);
-    output->append("\r\n");
+    total += body.size();
   }
 
-  output->append("\r\n");
-  output->append(body_);
+  output->ensureWritableBytes(total);
+  char* const begin = output->beginWrite();
+  char* p = append(begin, "HTTP/1.1 ");
+  int code = statusCode_;
+  p[0] = static_cast<char>('0' + code / 100 % 10);
+  p[1] = static_cast<char>('0' + code / 10 % 10);
+  p[2] = static_cast<char>('0' + code % 10);
+  p[3] = ' ';
+  p = append(p + 4, message);
+  p = append(p, "\r\n");
+
+  if (chunked)
+  {
+    p = append(p, kTransferEncodingChunked);
+  }
+  else if (contentLength)
+  {
+    p = append(p, kContentLength);
+    p = append(p, StringPiece(length, static_cast<int>(lengthEnd - length)));
+    p = append(p, "\r\n");
+  }
+  p = append(p, closeConnection_ ? kConnectionClose : kConnectionKeepAlive);
+  p = headers_.serialize(p);
+  p = append(p, "\r\n");
+  if (!chunked)
+  {
+    p = append(p, body);
+  }
+  assert(static_cast<size_t>(p - begin) == total);
+  output->hasWritten(total);
+
+  if (chunked && withBody)
+  {
+    appendChunk(output, body_);
+    appendLastChunk(output);
+  }
 }
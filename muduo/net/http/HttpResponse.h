@@ -13,8 +13,11 @@
 
 #include <muduo/base/copyable.h>
 #include <muduo/base/Types.h>
+#include <muduo/net/http/HttpHeaders.h>
 
-#include <map>
+#include <memory>
+
+#include <sys/types.h>
 
 namespace muduo
 {
@@ -30,22 +33,56 @@ class HttpResponse : public muduo::copyable
   {
     kUnknown,
     k200Ok = 200,   //成功
+    k204NoContent = 204,
+    k206PartialContent = 206,
     k301MovedPermanently = 301,    //301重定向，请求的页面永久性移至另一个地址
+    k302Found = 302,
+    k304NotModified = 304,
     k400BadRequest = 400,          //错误的请求，语法格式有错，服务器无法处理此请求
+    k403Forbidden = 403,
     k404NotFound = 404,            //请求的网页不存在
+    k405MethodNotAllowed = 405,
+    k413PayloadTooLarge = 413,
+    k416RangeNotSatisfiable = 416,
+    k500InternalServerError = 500,
+    k501NotImplemented = 501,
+    k503ServiceUnavailable = 503,
   };
 
   explicit HttpResponse(bool close)
     : statusCode_(kUnknown),
-      closeConnection_(close)
+      closeConnection_(close),
+      chunked_(false),
+      fileFd_(-1),
+      fileOffset_(0),
+      fileLength_(0)
+  {
+  }
+
+  /// For the next request on the connection, keeps what's allocated.
+  void reset(bool close)
   {
+    headers_.clear();
+    statusCode_ = kUnknown;
+    statusMessage_.clear();
+    closeConnection_ = close;
+    chunked_ = false;
+    body_.clear();
+    fileFd_ = -1;
+    fileOffset_ = 0;
+    fileLength_ = 0;
+    file_.reset();
   }
 
   void setStatusCode(HttpStatusCode code)
   { statusCode_ = code; }
 
-  void setStatusMessage(const string& message)
-  { statusMessage_ = message; }
+  HttpStatusCode statusCode() const
+  { return statusCode_; }
+
+  /// The usual one of the code if not set.
+  void setStatusMessage(StringPiece message)
+  { statusMessage_.assign(message.data(), message.size()); }
 
   void setCloseConnection(bool on)
   { closeConnection_ = on; }
@@ -53,27 +90,91 @@ class HttpResponse : public muduo::copyable
   bool closeConnection() const
   { return closeConnection_; }
 
+  /// Transfer-Encoding: chunked instead of Content-Length,
+  /// HTTP/1.0 clients get Content-Length anyway.
+  void setChunked(bool on)
+  { chunked_ = on; }
+
+  bool chunked() const
+  { return chunked_; }
+
   //设置文档媒体类型(MIME)
-  void setContentType(const string& contentType)
-  { addHeader("Content-Type", contentType); }
+  void setContentType(StringPiece contentType)
+  { headers_.set(HttpHeaders::kContentType, contentType); }
+
+  /// Replaces one of the same name, use headers().add() for another.
+  void addHeader(StringPiece key, StringPiece value)
+  { headers_.set(key, value); }
+
+  HttpHeaders& headers()
+  { return headers_; }
+
+  const HttpHeaders& headers() const
+  { return headers_; }
+
+  void setBody(StringPiece body)
+  { body_.assign(body.data(), body.size()); }
 
-  // FIXME: replace string with StringPiece
-  void addHeader(const string& key, const string& value)
-  { headers_[key] = value; }
+  const string& body() const
+  { return body_; }
 
-  void setBody(const string& body)
-  { body_ = body; }
+  /// The body is [offset, offset+length) of file fd, sent with sendfile(2)
+  /// after the head, never chunked.  owner keeps fd open till then.
+  void setFileBody(int fd, off_t offset, size_t length,
+                   const std::shared_ptr<const void>& owner)
+  {
+    body_.clear();
+    fileFd_ = fd;
+    fileOffset_ = offset;
+    fileLength_ = length;
+    file_ = owner;
+  }
+
+  bool hasFileBody() const
+  { return fileFd_ >= 0; }
+
+  int fileFd() const
+  { return fileFd_; }
+
+  off_t fileOffset() const
+  { return fileOffset_; }
+
+  size_t fileLength() const
+  { return fileLength_; }
+
+  const std::shared_ptr<const void>& fileOwner() const
+  { return file_; }
+
+  /// Reason phrase of RFC 7231, empty if unknown.
+  static StringPiece reasonPhrase(int code);
 
   //将HttpResponse添加到Buffer
+  /// Written in place, sized once, no temporary string.
+  /// A chunked one has its body as one chunk, then the last chunk.
+  /// A file body is not, it's for the caller to send after.
   void appendToBuffer(Buffer* output) const;
 
+  /// Without the body, for HEAD, Content-Length is as if it were there.
+  void appendHeadToBuffer(Buffer* output) const;
+
+  /// For a chunked body written piece by piece, empty data is skipped.
+  static void appendChunk(Buffer* output, StringPiece data);
+  static void appendLastChunk(Buffer* output);
+
  private:
-  std::map<string, string> headers_;   //header列表
+  void appendToBuffer(Buffer* output, bool withBody) const;
+
+  HttpHeaders headers_;                //header列表
   HttpStatusCode statusCode_;          //状态响应码
   // FIXME: add http version
   string statusMessage_;               //状态响应码对应的文本信息
   bool closeConnection_;               //是否关闭连接
+  bool chunked_;
   string body_;                        //响应的实体
+  int fileFd_;                         // or the body is in a file
+  off_t fileOffset_;
+  size_t fileLength_;
+  std::shared_ptr<const void> file_;
 };
 
 }  // namespace net
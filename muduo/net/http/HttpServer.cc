@@ -10,7 +10,9 @@
 #include <muduo/net/http/HttpServer.h>
 
 #include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
 #include <muduo/net/http/HttpContext.h>
+#include <muduo/net/http/HttpDeferredResponse.h>
 #include <muduo/net/http/HttpRequest.h>
 #include <muduo/net/http/HttpResponse.h>
 
@@ -40,7 +42,9 @@ HttpServer::HttpServer(EventLoop* loop,
                        const string& name,
                        TcpServer::Option option)
   : server_(loop, listenAddr, name, option),
-    httpCallback_(detail::defaultHttpCallback)
+    httpCallback_(detail::defaultHttpCallback),
+    maxBodySize_(HttpContext::kDefaultMaxBodySize),
+    maxPending_(HttpContext::kDefaultMaxPending)
 {
   server_.setConnectionCallback(
       std::bind(&HttpServer::onConnection, this, _1));
@@ -59,44 +63,106 @@ void HttpServer::onConnection(const TcpConnectionPtr& conn)
 {
   if (conn->connected())
   {
-    conn->setContext(HttpContext());  //TcpConnection与一个HttpContext绑定
+    HttpContext context;
+    context.setBodyCallback(bodyCallback_);
+    context.setMaxBodySize(maxBodySize_);
+    context.setMaxPending(maxPending_);
+    context.setResumeCallback(std::bind(&HttpServer::onResume, this, _1));
+    conn->setContext(context);  //TcpConnection与一个HttpContext绑定
   }
 }
 
+// Every request in buf is answered in one pass, pipelined ones included,
+// the responses go out together in one write.
 void HttpServer::onMessage(const TcpConnectionPtr& conn,
                            Buffer* buf,
                            Timestamp receiveTime)
 {
   HttpContext* context = boost::any_cast<HttpContext>(conn->getMutableContext());
+  Buffer* output = context->output();
+  bool close = false;
 
-  if (!context->parseRequest(buf, receiveTime))
+  while (!close)
   {
-    conn->send("HTTP/1.1 400 Bad Request\r\n\r\n");
-    conn->shutdown();
+    // pipelined ones past the limit wait, see HttpContext::sendDeferred()
+    if (context->stopReadIfFull(conn))
+    {
+      break;
+    }
+    if (!context->parseRequest(buf, receiveTime))
+    {
+      close = true;
+      if (context->deferred().empty())
+      {
+        HttpResponse* response = context->response();
+        response->reset(true);
+        response->setStatusCode(context->error());
+        response->appendToBuffer(output);
+      }
+      else
+      {
+        // after those still to come
+        HttpDeferredResponsePtr deferred(
+            new HttpDeferredResponse(conn, &context->request(), true));
+        deferred->response()->setStatusCode(context->error());
+        context->deferred().push_back(deferred);
+        deferred->done();
+      }
+    }
+    else if (context->gotAll())
+    {
+      close = onRequest(conn, context);
+      context->reset();    //本次请求处理完毕，重置HttpContext，适用于长连接
+    }
+    else
+    {
+      // not before the responses to earlier requests
+      if (context->expectContinue() && context->deferred().empty())
+      {
+        output->append("HTTP/1.1 100 Continue\r\n\r\n");
+        context->continueSent();
+      }
+      break;
+    }
   }
 
-  //请求消息解析完毕
-  if (context->gotAll())
+  if (output->readableBytes() > 0)
   {
-    onRequest(conn, context->request());
-    context->reset();    //本次请求处理完毕，重置HttpContext，适用于长连接
+    // sent at once most of the time, then output keeps its storage,
+    // or the output queue takes it
+    conn->send(output);
   }
+  if (close)
+  {
+    buf->retrieveAll();
+    // or once the deferred ones before it are sent
+    if (context->deferred().empty())
+    {
+      conn->shutdown();
+    }
+  }
+}
+
+void HttpServer::onResume(const TcpConnectionPtr& conn)
+{
+  onMessage(conn, conn->inputBuffer(), conn->getLoop()->pollReturnTime());
 }
 
-void HttpServer::onRequest(const TcpConnectionPtr& conn, const HttpRequest& req)
+bool HttpServer::onRequest(const TcpConnectionPtr& conn, HttpContext* context)
 {
-  const string& connection = req.getHeader("Connection");
-  //1.0版本不支持keep alive
+  HttpRequest& req = context->request();
+  StringPiece connection = req.header(HttpHeaders::kConnection);
   bool close = connection == "close" ||
     (req.getVersion() == HttpRequest::kHttp10 && connection != "Keep-Alive");
-  HttpResponse response(close);
-  httpCallback_(req, &response);
-  Buffer buf;
-  response.appendToBuffer(&buf);
-  conn->send(&buf);
-  if (response.closeConnection())
+  if (deferredCallback_)
   {
-    conn->shutdown();
+    HttpDeferredResponsePtr deferred(new HttpDeferredResponse(conn, &req, close));
+    context->deferred().push_back(deferred);
+    deferredCallback_(deferred);
+    return close;
   }
+  HttpResponse* response = context->response();
+  response->reset(close);
+  httpCallback_(req, response);
+  return context->appendResponse(conn, req, response);
 }
-
@@ -18,18 +18,26 @@ namespace muduo
 namespace net
 {
 
+class HttpContext;
+class HttpDeferredResponse;
 class HttpRequest;
 class HttpResponse;
 
 /// A simple embeddable HTTP server designed for report status of a program.
 /// It is not a fully HTTP 1.1 compliant server, but provides minimum features
 /// that can communicate with HttpClient and Web browser.
-/// It is synchronous, just like Java Servlet.
+/// It is synchronous, just like Java Servlet, unless responses are
+/// deferred with setDeferredHttpCallback().
 class HttpServer : noncopyable
 {
  public:
   typedef std::function<void (const HttpRequest&,
                               HttpResponse*)> HttpCallback;
+  typedef std::function<void (const std::shared_ptr<HttpDeferredResponse>&)>
+      DeferredHttpCallback;
+  /// Each piece of a request body as it arrives.
+  typedef std::function<void (const HttpRequest&,
+                              StringPiece)> HttpBodyCallback;
 
   HttpServer(EventLoop* loop,
              const InetAddress& listenAddr,
@@ -44,6 +52,35 @@ class HttpServer : noncopyable
     httpCallback_ = cb;
   }
 
+  /// Not thread safe, callback be registered before calling start().
+  /// Instead of HttpCallback, for responses done later, in a ThreadPool
+  /// for example, see HttpDeferredResponse.
+  void setDeferredHttpCallback(const DeferredHttpCallback& cb)
+  {
+    deferredCallback_ = cb;
+  }
+
+  /// Not thread safe, callback be registered before calling start().
+  /// Bodies go to it instead of HttpRequest::body(), however large,
+  /// HttpCallback is called after the last piece.
+  void setHttpBodyCallback(const HttpBodyCallback& cb)
+  {
+    bodyCallback_ = cb;
+  }
+
+  /// Of a body kept in HttpRequest::body(), larger ones get 413.
+  void setMaxBodySize(size_t bytes)
+  {
+    maxBodySize_ = bytes;
+  }
+
+  /// Of deferred responses not yet sent on a connection, pipelined
+  /// requests beyond are not read till half of them are sent.
+  void setMaxPendingResponses(size_t n)
+  {
+    maxPending_ = n;
+  }
+
   //http服务器还支持多线程
   void setThreadNum(int numThreads)
   {
@@ -57,11 +94,18 @@ class HttpServer : noncopyable
   void onMessage(const TcpConnectionPtr& conn,
                  Buffer* buf,
                  Timestamp receiveTime);
-  void onRequest(const TcpConnectionPtr&, const HttpRequest&);
+  // return true if the connection is to be closed
+  bool onRequest(const TcpConnectionPtr&, HttpContext*);
+  // requests left in the input buffer when reading stopped
+  void onResume(const TcpConnectionPtr& conn);
 
   TcpServer server_;
   //在处理http请求(即调用onRequest)的过程中回调此函数，对请求进行具体的处理
   HttpCallback httpCallback_;  
+  DeferredHttpCallback deferredCallback_;
+  HttpBodyCallback bodyCallback_;
+  size_t maxBodySize_;
+  size_t maxPending_;
 };
 
 }  // namespace net
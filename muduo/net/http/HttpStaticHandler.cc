@@ -0,0 +1,377 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+
+#include <muduo/net/http/HttpStaticHandler.h>
+
+#include <muduo/net/http/HttpRequest.h>
+#include <muduo/net/http/HttpResponse.h>
+
+#include <algorithm>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+namespace
+{
+
+struct ContentType
+{
+  const char* extension;
+  const char* type;
+};
+
+const ContentType kContentTypes[] =
+{
+  { "css", "text/css; charset=utf-8" },
+  { "gif", "image/gif" },
+  { "htm", "text/html; charset=utf-8" },
+  { "html", "text/html; charset=utf-8" },
+  { "ico", "image/x-icon" },
+  { "jpeg", "image/jpeg" },
+  { "jpg", "image/jpeg" },
+  { "js", "application/javascript; charset=utf-8" },
+  { "json", "application/json" },
+  { "mp4", "video/mp4" },
+  { "pdf", "application/pdf" },
+  { "png", "image/png" },
+  { "svg", "image/svg+xml" },
+  { "txt", "text/plain; charset=utf-8" },
+  { "wasm", "application/wasm" },
+  { "webp", "image/webp" },
+  { "woff", "font/woff" },
+  { "woff2", "font/woff2" },
+  { "xml", "application/xml" },
+};
+
+int hexValue(char c)
+{
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+StringPiece trim(StringPiece s)
+{
+  while (!s.empty() && (s[0] == ' ' || s[0] == '\t'))
+  {
+    s.remove_prefix(1);
+  }
+  while (!s.empty() && (s[s.size() - 1] == ' ' || s[s.size() - 1] == '\t'))
+  {
+    s.remove_suffix(1);
+  }
+  return s;
+}
+
+// 1*DIGIT, false if none or too many
+bool parseOffset(StringPiece* s, off_t* value)
+{
+  off_t v = 0;
+  int digits = 0;
+  while (!s->empty() && (*s)[0] >= '0' && (*s)[0] <= '9')
+  {
+    if (++digits > 18)
+    {
+      return false;
+    }
+    v = v * 10 + ((*s)[0] - '0');
+    s->remove_prefix(1);
+  }
+  *value = v;
+  return digits > 0;
+}
+
+enum RangeResult
+{
+  kWholeFile,         // none, several, or not understood, all are ignored
+  kSatisfiable,
+  kUnsatisfiable,
+};
+
+// "bytes=first-last", "bytes=first-" or "bytes=-suffix", RFC 7233
+RangeResult parseRange(StringPiece range, off_t size, off_t* first, off_t* last)
+{
+  const StringPiece kBytes("bytes=");
+  if (range.size() < kBytes.size()
+      || ::strncasecmp(range.data(), kBytes.data(), kBytes.size()) != 0)
+  {
+    return kWholeFile;
+  }
+  range.remove_prefix(kBytes.size());
+  range = trim(range);
+  if (memchr(range.data(), ',', range.size()) != NULL)
+  {
+    // not worth multipart/byteranges
+    return kWholeFile;
+  }
+  if (!range.empty() && range[0] == '-')
+  {
+    range.remove_prefix(1);
+    off_t suffix = 0;
+    if (!parseOffset(&range, &suffix) || !range.empty())
+    {
+      return kWholeFile;
+    }
+    if (suffix == 0 || size == 0)
+    {
+      return kUnsatisfiable;
+    }
+    *first = suffix < size ? size - suffix : 0;
+    *last = size - 1;
+    return kSatisfiable;
+  }
+
+  if (!parseOffset(&range, first) || range.empty() || range[0] != '-')
+  {
+    return kWholeFile;
+  }
+  range.remove_prefix(1);
+  *last = size - 1;
+  if (!range.empty())
+  {
+    off_t value = 0;
+    if (!parseOffset(&range, &value) || !range.empty() || value < *first)
+    {
+      return kWholeFile;
+    }
+    *last = std::min(value, size - 1);
+  }
+  return *first < size ? kSatisfiable : kUnsatisfiable;
+}
+
+// of If-None-Match, weak comparison
+bool matchesEtag(StringPiece list, const string& etag)
+{
+  list = trim(list);
+  if (list == "*")
+  {
+    return true;
+  }
+  while (!list.empty())
+  {
+    const char* comma = static_cast<const char*>(memchr(list.data(), ',', list.size()));
+    const char* end = comma ? comma : list.end();
+    StringPiece one = trim(StringPiece(list.data(), static_cast<int>(end - list.data())));
+    if (one.starts_with("W/"))
+    {
+      one.remove_prefix(2);
+    }
+    if (one == etag)
+    {
+      return true;
+    }
+    if (comma == NULL)
+    {
+      break;
+    }
+    list.remove_prefix(static_cast<int>(comma + 1 - list.data()));
+  }
+  return false;
+}
+
+bool notModified(const HttpRequest& req, const HttpFileCache::File& file)
+{
+  // If-None-Match wins, RFC 7232 section 6
+  StringPiece noneMatch = req.header(HttpHeaders::kIfNoneMatch);
+  if (!noneMatch.empty())
+  {
+    return matchesEtag(noneMatch, file.etag());
+  }
+  StringPiece modifiedSince = req.header(HttpHeaders::kIfModifiedSince);
+  if (!modifiedSince.empty())
+  {
+    time_t since = HttpFileCache::parseHttpDate(modifiedSince);
+    return since >= 0 && file.modifiedTime() <= since;
+  }
+  return false;
+}
+
+}  // namespace
+
+HttpStaticHandler::HttpStaticHandler(const string& prefix,
+                                     const string& root,
+                                     int maxOpenFiles)
+  : prefix_(prefix),
+    root_(!root.empty() && root[root.size() - 1] == '/'
+          ? root.substr(0, root.size() - 1) : root),
+    cache_(maxOpenFiles)
+{
+}
+
+StringPiece HttpStaticHandler::contentType(const string& filename)
+{
+  size_t dot = filename.rfind('.');
+  size_t slash = filename.rfind('/');
+  if (dot != string::npos && (slash == string::npos || dot > slash))
+  {
+    StringPiece extension(filename.data() + dot + 1,
+                          static_cast<int>(filename.size() - dot - 1));
+    for (const ContentType& known : kContentTypes)
+    {
+      if (extension.size() == static_cast<int>(strlen(known.extension))
+          && ::strncasecmp(extension.data(), known.extension, extension.size()) == 0)
+      {
+        return known.type;
+      }
+    }
+  }
+  return "application/octet-stream";
+}
+
+bool HttpStaticHandler::underPrefix(const string& path) const
+{
+  return path.compare(0, prefix_.size(), prefix_) == 0
+      && (prefix_.empty() || prefix_[prefix_.size() - 1] == '/'
+          || path.size() == prefix_.size() || path[prefix_.size()] == '/');
+}
+
+bool HttpStaticHandler::resolve(StringPiece path, string* filename) const
+{
+  string decoded;
+  decoded.reserve(path.size());
+  for (int i = 0; i < path.size(); ++i)
+  {
+    char c = path[i];
+    if (c == '%')
+    {
+      int high = i + 2 < path.size() ? hexValue(path[i + 1]) : -1;
+      int low = i + 2 < path.size() ? hexValue(path[i + 2]) : -1;
+      if (high < 0 || low < 0)
+      {
+        return false;
+      }
+      c = static_cast<char>(high * 16 + low);
+      i += 2;
+    }
+    if (c == '\0')
+    {
+      return false;
+    }
+    decoded += c;
+  }
+
+  // no way out of root_, "/../" decoded from "%2e%2e" neither
+  size_t begin = 0;
+  while (begin <= decoded.size())
+  {
+    size_t end = decoded.find('/', begin);
+    if (end == string::npos)
+    {
+      end = decoded.size();
+    }
+    if (decoded.compare(begin, end - begin, "..") == 0)
+    {
+      return false;
+    }
+    begin = end + 1;
+  }
+
+  if (decoded.empty() || decoded[decoded.size() - 1] == '/')
+  {
+    decoded += "index.html";
+  }
+  filename->assign(root_);
+  if (decoded[0] != '/')
+  {
+    *filename += '/';
+  }
+  *filename += decoded;
+  return true;
+}
+
+bool HttpStaticHandler::handle(const HttpRequest& req, HttpResponse* resp)
+{
+  const string& path = req.path();
+  if (!underPrefix(path))
+  {
+    return false;
+  }
+  if (req.method() != HttpRequest::kGet && req.method() != HttpRequest::kHead)
+  {
+    resp->setStatusCode(HttpResponse::k405MethodNotAllowed);
+    resp->addHeader("Allow", "GET, HEAD");
+    return true;
+  }
+
+  string filename;
+  if (!resolve(StringPiece(path.data() + prefix_.size(),
+                           static_cast<int>(path.size() - prefix_.size())),
+               &filename))
+  {
+    resp->setStatusCode(HttpResponse::k404NotFound);
+    return true;
+  }
+  HttpFileCache::FilePtr file = cache_.open(filename);
+  if (!file)
+  {
+    if (errno == EISDIR)
+    {
+      resp->setStatusCode(HttpResponse::k301MovedPermanently);
+      resp->headers().set(HttpHeaders::kLocation, path + "/");
+    }
+    else
+    {
+      resp->setStatusCode(errno == EACCES ? HttpResponse::k403Forbidden
+                                          : HttpResponse::k404NotFound);
+    }
+    return true;
+  }
+
+  HttpHeaders& headers = resp->headers();
+  headers.set(HttpHeaders::kETag, file->etag());
+  headers.set(HttpHeaders::kLastModified, file->lastModified());
+  if (notModified(req, *file))
+  {
+    resp->setStatusCode(HttpResponse::k304NotModified);
+    return true;
+  }
+  resp->addHeader("Accept-Ranges", "bytes");
+  resp->setContentType(contentType(filename));
+
+  off_t first = 0;
+  off_t last = 0;
+  RangeResult range = kWholeFile;
+  StringPiece rangeHeader = req.header(HttpHeaders::kRange);
+  StringPiece ifRange = req.header(HttpHeaders::kIfRange);
+  // If-Range of another version asks for all of this one
+  if (!rangeHeader.empty()
+      && (ifRange.empty() || ifRange == file->etag() || ifRange == file->lastModified()))
+  {
+    range = parseRange(rangeHeader, file->size(), &first, &last);
+  }
+
+  char buf[64];
+  if (range == kUnsatisfiable)
+  {
+    snprintf(buf, sizeof buf, "bytes */%lld", static_cast<long long>(file->size()));
+    resp->setStatusCode(HttpResponse::k416RangeNotSatisfiable);
+    headers.set(HttpHeaders::kContentRange, buf);
+  }
+  else if (range == kSatisfiable)
+  {
+    snprintf(buf, sizeof buf, "bytes %lld-%lld/%lld",
+             static_cast<long long>(first), static_cast<long long>(last),
+             static_cast<long long>(file->size()));
+    resp->setStatusCode(HttpResponse::k206PartialContent);
+    headers.set(HttpHeaders::kContentRange, buf);
+    resp->setFileBody(file->fd(), first, static_cast<size_t>(last - first + 1), file);
+  }
+  else
+  {
+    resp->setStatusCode(HttpResponse::k200Ok);
+    resp->setFileBody(file->fd(), 0, static_cast<size_t>(file->size()), file);
+  }
+  return true;
+}
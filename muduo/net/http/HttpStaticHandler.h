@@ -0,0 +1,64 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+// This is a public header file, it must only include public header files.
+
+#ifndef MUDUO_NET_HTTP_HTTPSTATICHANDLER_H
+#define MUDUO_NET_HTTP_HTTPSTATICHANDLER_H
+
+#include <muduo/net/http/HttpFileCache.h>
+
+namespace muduo
+{
+namespace net
+{
+
+class HttpRequest;
+class HttpResponse;
+
+///
+/// Serves files under a directory for paths under a URL prefix, from
+/// an HttpCallback of HttpServer:
+/// @code
+///   HttpStaticHandler assets("/static/", "/var/www/static");
+///   server.setHttpCallback([&assets](const HttpRequest& req, HttpResponse* resp) {
+///     if (!assets.handle(req, resp)) { ... }
+///   });
+/// @endcode
+/// A file is sent with sendfile(2) from an fd kept open in HttpFileCache.
+/// GET and HEAD, with ETag, If-None-Match, Last-Modified,
+/// If-Modified-Since, and a single Range or If-Range.
+///
+class HttpStaticHandler : noncopyable
+{
+ public:
+  HttpStaticHandler(const string& prefix,
+                    const string& root,
+                    int maxOpenFiles = HttpFileCache::kDefaultMaxFiles);
+
+  /// Answers req and returns true if its path is under the prefix.
+  /// Thread safe, eg. called in the IO threads of HttpServer.
+  bool handle(const HttpRequest& req, HttpResponse* resp);
+
+  /// By the extension, "application/octet-stream" if unknown.
+  static StringPiece contentType(const string& filename);
+
+ private:
+  bool underPrefix(const string& path) const;
+  // false if it's not a path in root_
+  bool resolve(StringPiece path, string* filename) const;
+
+  const string prefix_;
+  const string root_;
+  HttpFileCache cache_;
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_HTTP_HTTPSTATICHANDLER_H
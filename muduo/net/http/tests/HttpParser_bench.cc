@@ -0,0 +1,103 @@
+#include <muduo/net/http/HttpContext.h>
+#include <muduo/net/http/HttpParser.h>
+#include <muduo/net/Buffer.h>
+#include <muduo/base/Timestamp.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+// A request of a browser, ~700 bytes.
+const char kRequest[] =
+  "GET /wp-content/uploads/2010/03/hello-kitty-darth-vader-pink.jpg?ver=1.2 HTTP/1.1\r\n"
+  "Host: www.kittyhell.com\r\n"
+  "User-Agent: Mozilla/5.0 (Macintosh; U; Intel Mac OS X 10_6_3; ja-JP-mac; rv:1.9.2.3) "
+  "Gecko/20100401 Firefox/3.6.3 Pathtraq/0.9\r\n"
+  "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+  "Accept-Language: ja,en-us;q=0.7,en;q=0.3\r\n"
+  "Accept-Encoding: gzip,deflate\r\n"
+  "Accept-Charset: Shift_JIS,utf-8;q=0.7,*;q=0.7\r\n"
+  "Keep-Alive: 115\r\n"
+  "Connection: keep-alive\r\n"
+  "Cookie: wp_ozh_wsa_visits=2; wp_ozh_wsa_visit_lasttime=xxxxxxxxxx; "
+  "__utma=xxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.x; "
+  "__utmz=xxxxxxxxx.xxxxxxxxxx.x.x.utmccn=(referral)|utmcsr=reader.livedoor.com|utmcct=/reader/|utmcmd=referral\r\n"
+  "\r\n";
+
+// HttpContext as it was, a line at a time with std::search and std::find
+bool parseByteWise(Buffer* buf, HttpRequest* request)
+{
+  const char kCRLF[] = "\r\n";
+  const char* crlf = std::search(buf->peek(), static_cast<const char*>(buf->beginWrite()), kCRLF, kCRLF + 2);
+  const char* start = buf->peek();
+  const char* space = std::find(start, crlf, ' ');
+  if (space == crlf || !request->setMethod(start, space))
+  {
+    return false;
+  }
+  start = space + 1;
+  space = std::find(start, crlf, ' ');
+  const char* question = std::find(start, space, '?');
+  request->setPath(start, question);
+  request->setQuery(question, space);
+  buf->retrieveUntil(crlf + 2);
+  for (;;)
+  {
+    crlf = std::search(buf->peek(), static_cast<const char*>(buf->beginWrite()), kCRLF, kCRLF + 2);
+    const char* colon = std::find(buf->peek(), crlf, ':');
+    if (colon == crlf)
+    {
+      buf->retrieveUntil(crlf + 2);
+      return true;
+    }
+    request->addHeader(buf->peek(), colon, crlf);
+    buf->retrieveUntil(crlf + 2);
+  }
+}
+
+template<typename Func>
+void bench(const char* name, int n, Func func)
+{
+  Buffer buf;
+  Timestamp start(Timestamp::now());
+  for (int i = 0; i < n; ++i)
+  {
+    buf.append(kRequest, sizeof kRequest - 1);
+    if (!func(&buf))
+    {
+      printf("%s failed\n", name);
+      abort();
+    }
+  }
+  double seconds = timeDifference(Timestamp::now(), start);
+  printf("%-22s %7.1f ns/request %8.1f MiB/s\n", name, seconds * 1e9 / n,
+         n * static_cast<double>(sizeof kRequest - 1) / seconds / 1024 / 1024);
+}
+
+int main(int argc, char* argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 1000 * 1000;
+
+  bench("byte wise", n, [](Buffer* buf) {
+    HttpRequest request;
+    return parseByteWise(buf, &request);
+  });
+
+  HttpContext context;
+  bench("HttpContext", n, [&context](Buffer* buf) {
+    bool ok = context.parseRequest(buf, Timestamp()) && context.gotAll();
+    context.reset();
+    return ok;
+  });
+
+  // what headers cost once HttpRequest stops copying them
+  HttpParser parser;
+  bench("HttpParser, views", n, [&parser](Buffer* buf) {
+    bool ok = parser.parse(buf->peek(), buf->beginWrite()) == HttpParser::kComplete;
+    buf->retrieve(parser.headLength());
+    parser.reset();
+    return ok;
+  });
+}
@@ -1,6 +1,9 @@
 #include <muduo/net/http/HttpContext.h>
+#include <muduo/net/http/HttpParser.h>
 #include <muduo/net/Buffer.h>
 
+#include <random>
+
 //#define BOOST_TEST_MODULE BufferTest
 #define BOOST_TEST_MAIN
 #define BOOST_TEST_DYN_LINK
@@ -10,7 +13,10 @@ using muduo::string;
 using muduo::Timestamp;
 using muduo::net::Buffer;
 using muduo::net::HttpContext;
+using muduo::net::HttpHeaders;
+using muduo::net::HttpParser;
 using muduo::net::HttpRequest;
+using muduo::net::HttpResponse;
 
 BOOST_AUTO_TEST_CASE(testParseRequestAllInOne)
 {
@@ -77,3 +83,318 @@ BOOST_AUTO_TEST_CASE(testParseRequestEmptyHeaderValue)
   BOOST_CHECK_EQUAL(request.getHeader("User-Agent"), string(""));
   BOOST_CHECK_EQUAL(request.getHeader("Accept-Encoding"), string(""));
 }
+
+BOOST_AUTO_TEST_CASE(testFindEitherLikeScalar)
+{
+  std::mt19937 rng(1);
+  string data(300, 'x');
+  for (int i = 0; i < 20000; ++i)
+  {
+    for (char& c : data)
+    {
+      // sparse delimiters, at every offset of a 16 or 32 byte block
+      c = rng() % 97 == 0 ? ':' : (rng() % 89 == 0 ? '\r' : static_cast<char>('a' + rng() % 26));
+    }
+    size_t begin = rng() % data.size();
+    size_t end = begin + rng() % (data.size() - begin + 1);
+    const char* p = data.data();
+    BOOST_REQUIRE_EQUAL(muduo::net::detail::findEither(p + begin, p + end, ':', '\r') - p,
+                        muduo::net::detail::findEitherScalar(p + begin, p + end, ':', '\r') - p);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testParserByteByByte)
+{
+  string value(100, 'v');
+  string all("POST /api/v1/items?id=42&sort=asc HTTP/1.0\r\n"
+             "Host: www.chenshuo.com\r\n"
+             "X-Long: " + value + " \t\r\n"
+             "Content-Type:application/json\r\n"
+             "\r\n"
+             "next request");
+  HttpParser parser;
+  size_t len = 0;
+  HttpParser::Result result = HttpParser::kIncomplete;
+  while (result == HttpParser::kIncomplete && len < all.size())
+  {
+    result = parser.parse(all.data(), all.data() + ++len);
+  }
+  BOOST_REQUIRE_EQUAL(result, HttpParser::kComplete);
+  const char* begin = all.data();
+  BOOST_CHECK_EQUAL(len, all.size() - strlen("next request"));
+  BOOST_CHECK_EQUAL(parser.headLength(), static_cast<int>(len));
+  BOOST_CHECK_EQUAL(HttpParser::view(begin, parser.method()).as_string(), "POST");
+  BOOST_CHECK_EQUAL(HttpParser::view(begin, parser.path()).as_string(), "/api/v1/items");
+  BOOST_CHECK_EQUAL(HttpParser::view(begin, parser.query()).as_string(), "?id=42&sort=asc");
+  BOOST_CHECK_EQUAL(parser.minorVersion(), 0);
+  BOOST_REQUIRE_EQUAL(parser.headers().size(), 3u);
+  BOOST_CHECK_EQUAL(HttpParser::view(begin, parser.headers()[1].name).as_string(), "X-Long");
+  BOOST_CHECK_EQUAL(HttpParser::view(begin, parser.headers()[1].value).as_string(), value);
+  BOOST_CHECK_EQUAL(HttpParser::view(begin, parser.headers()[2].name).as_string(), "Content-Type");
+  BOOST_CHECK_EQUAL(HttpParser::view(begin, parser.headers()[2].value).as_string(), "application/json");
+}
+
+BOOST_AUTO_TEST_CASE(testParserErrors)
+{
+  const char* bad[] = {
+    "GET /index.html HTTP/1.1\n\r\n",
+    "GET /index.html HTTP/2.0\r\n\r\n",
+    "GET /index.html\r\n\r\n",
+    "GET /index.html HTTP/1.1\r\nHost www.chenshuo.com\r\n\r\n",
+    "GET /index.html HTTP/1.1\r\nHost: www.chenshuo.com\rX\r\n\r\n",
+    // bad names, RFC 7230 section 3.2.4
+    "GET /index.html HTTP/1.1\r\nX\nY: z\r\n\r\n",
+    "GET /index.html HTTP/1.1\r\n: empty\r\n\r\n",
+    "GET /index.html HTTP/1.1\r\nTransfer-Encoding : chunked\r\n\r\n",
+    "GET /index.html HTTP/1.1\r\n Host: www.chenshuo.com\r\n\r\n",
+    "GET /index.html HTTP/1.1\r\nHo\tst: www.chenshuo.com\r\n\r\n",
+    "GET /index.html HTTP/1.1\r\nHo\x01st: www.chenshuo.com\r\n\r\n",
+    "GET /index.html HTTP/1.1\r\nHo(st): www.chenshuo.com\r\n\r\n",
+  };
+  for (const char* request : bad)
+  {
+    HttpParser parser;
+    BOOST_CHECK_EQUAL(parser.parse(request, request + strlen(request)), HttpParser::kError);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testParseRequestLeavesTheRest)
+{
+  HttpContext context;
+  Buffer input;
+  input.append("GET /index.html?q=muduo HTTP/1.1\r\n"
+       "Host: www.chenshuo.com\r\n"
+       "\r\n"
+       "GET /next");
+
+  BOOST_CHECK(context.parseRequest(&input, Timestamp::now()));
+  BOOST_CHECK(context.gotAll());
+  BOOST_CHECK_EQUAL(context.request().path(), string("/index.html"));
+  BOOST_CHECK_EQUAL(context.request().query(), string("?q=muduo"));
+  BOOST_CHECK_EQUAL(input.retrieveAllAsString(), string("GET /next"));
+
+  context.reset();
+  input.append("BREW /pot HTTP/1.1\r\n\r\n");
+  BOOST_CHECK(!context.parseRequest(&input, Timestamp::now()));
+}
+
+BOOST_AUTO_TEST_CASE(testHeadersIgnoreCase)
+{
+  HttpContext context;
+  Buffer input;
+  input.append("GET / HTTP/1.1\r\n"
+       "host: www.chenshuo.com\r\n"
+       "X-Request-Id: 42\r\n"
+       "CONNECTION: close\r\n"
+       "\r\n");
+
+  BOOST_CHECK(context.parseRequest(&input, Timestamp::now()));
+  const HttpRequest& request = context.request();
+  BOOST_CHECK_EQUAL(request.getHeader("Host"), string("www.chenshuo.com"));
+  BOOST_CHECK_EQUAL(request.header(HttpHeaders::kHost).as_string(), "www.chenshuo.com");
+  BOOST_CHECK_EQUAL(request.header("x-request-id").as_string(), "42");
+  BOOST_CHECK_EQUAL(request.header(HttpHeaders::kConnection).as_string(), "close");
+  BOOST_CHECK(request.header(HttpHeaders::kUserAgent).empty());
+
+  // as received, in order
+  const HttpHeaders& headers = request.headers();
+  BOOST_REQUIRE_EQUAL(headers.size(), 3);
+  BOOST_CHECK_EQUAL(headers.name(0).as_string(), "host");
+  BOOST_CHECK_EQUAL(headers.field(0), HttpHeaders::kHost);
+  BOOST_CHECK_EQUAL(headers.name(1).as_string(), "X-Request-Id");
+  BOOST_CHECK_EQUAL(headers.field(1), HttpHeaders::kOther);
+}
+
+BOOST_AUTO_TEST_CASE(testHeadersGrow)
+{
+  HttpHeaders headers;
+  std::vector<string> values;
+  for (int i = 0; i < 100; ++i)
+  {
+    values.push_back(string(static_cast<size_t>(i), 'v'));
+    headers.add("X-Header-" + std::to_string(i), values.back());
+  }
+  BOOST_REQUIRE_EQUAL(headers.size(), 100);
+  for (int i = 0; i < 100; ++i)
+  {
+    BOOST_CHECK_EQUAL(headers.get("x-header-" + std::to_string(i)).as_string(), values[i]);
+  }
+
+  HttpHeaders copy(headers);
+  headers.clear();
+  BOOST_CHECK(headers.empty());
+  BOOST_CHECK_EQUAL(copy.get("X-Header-99").as_string(), values[99]);
+
+  headers.add(HttpHeaders::kContentLength, "1");
+  headers.add("Set-Cookie", "a=1");
+  headers.add("Set-Cookie", "b=2");
+  headers.set("content-length", "2");
+  BOOST_REQUIRE_EQUAL(headers.size(), 3);
+  BOOST_CHECK_EQUAL(headers.get(HttpHeaders::kContentLength).as_string(), "2");
+  BOOST_CHECK_EQUAL(headers.get(HttpHeaders::kSetCookie).as_string(), "a=1");
+  headers.remove(HttpHeaders::kSetCookie);
+  BOOST_CHECK_EQUAL(headers.size(), 1);
+  BOOST_CHECK_EQUAL(headers.name(0).as_string(), "content-length");
+}
+
+BOOST_AUTO_TEST_CASE(testFieldNames)
+{
+  for (int i = 0; i < HttpHeaders::kNumFields; ++i)
+  {
+    HttpHeaders::Field field = static_cast<HttpHeaders::Field>(i);
+    string name = HttpHeaders::fieldName(field).as_string();
+    BOOST_CHECK_EQUAL(HttpHeaders::lookup(name), field);
+    for (char& c : name)
+    {
+      c = static_cast<char>(toupper(c));
+    }
+    BOOST_CHECK_EQUAL(HttpHeaders::lookup(name), field);
+  }
+  BOOST_CHECK_EQUAL(HttpHeaders::lookup(""), HttpHeaders::kOther);
+  BOOST_CHECK_EQUAL(HttpHeaders::lookup("Hosts"), HttpHeaders::kOther);
+}
+
+BOOST_AUTO_TEST_CASE(testParsePipelined)
+{
+  HttpContext context;
+  Buffer input;
+  input.append("GET /a HTTP/1.1\r\n"
+       "Host: www.chenshuo.com\r\n"
+       "\r\n"
+       "POST /b HTTP/1.1\r\n"
+       "Content-Length: 5\r\n"
+       "\r\n"
+       "hello"
+       "POST /c HTTP/1.1\r\n"
+       "Transfer-Encoding: chunked\r\n"
+       "\r\n"
+       "5;name=value\r\n"
+       "hello\r\n"
+       "7\r\n"
+       ", world\r\n"
+       "0\r\n"
+       "X-Checksum: 42\r\n"
+       "\r\n"
+       "GET /d HTTP/1.1\r\n");
+
+  const char* paths[] = { "/a", "/b", "/c" };
+  const char* bodies[] = { "", "hello", "hello, world" };
+  for (int i = 0; i < 3; ++i)
+  {
+    BOOST_CHECK(context.parseRequest(&input, Timestamp::now()));
+    BOOST_REQUIRE(context.gotAll());
+    BOOST_CHECK_EQUAL(context.request().path(), string(paths[i]));
+    BOOST_CHECK_EQUAL(context.request().body(), string(bodies[i]));
+    context.reset();
+  }
+  BOOST_CHECK(context.parseRequest(&input, Timestamp::now()));
+  BOOST_CHECK(!context.gotAll());
+  // the head stays till it's all here
+  BOOST_CHECK_EQUAL(input.retrieveAllAsString(), string("GET /d HTTP/1.1\r\n"));
+}
+
+BOOST_AUTO_TEST_CASE(testParseBodyByteByByte)
+{
+  const char* requests[] = {
+    "PUT /upload HTTP/1.1\r\n"
+    "Content-Length: 12\r\n"
+    "\r\n"
+    "hello, world",
+    "PUT /upload HTTP/1.1\r\n"
+    "transfer-encoding: Chunked\r\n"
+    "\r\n"
+    "A\r\n"
+    "hello, wor\r\n"
+    "2 \r\n"
+    "ld\r\n"
+    "0\r\n"
+    "\r\n",
+  };
+  for (const char* request : requests)
+  {
+    HttpContext context;
+    Buffer input;
+    for (const char* p = request; *p; ++p)
+    {
+      BOOST_CHECK(!context.gotAll());
+      input.append(p, 1);
+      BOOST_REQUIRE(context.parseRequest(&input, Timestamp::now()));
+    }
+    BOOST_CHECK(context.gotAll());
+    BOOST_CHECK_EQUAL(context.request().method(), HttpRequest::kPut);
+    BOOST_CHECK_EQUAL(context.request().body(), string("hello, world"));
+    BOOST_CHECK_EQUAL(input.readableBytes(), 0u);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testParseBodyCallback)
+{
+  string received;
+  int pieces = 0;
+  HttpContext context;
+  context.setMaxBodySize(4);
+  context.setBodyCallback([&](const HttpRequest& request, muduo::StringPiece data) {
+    BOOST_CHECK_EQUAL(request.path(), string("/upload"));
+    received.append(data.data(), data.size());
+    ++pieces;
+  });
+
+  Buffer input;
+  input.append("POST /upload HTTP/1.1\r\n"
+       "Expect: 100-continue\r\n"
+       "Content-Length: 10\r\n"
+       "\r\n");
+  BOOST_CHECK(context.parseRequest(&input, Timestamp::now()));
+  BOOST_CHECK(!context.gotAll());
+  BOOST_CHECK(context.expectContinue());
+
+  input.append("01234");
+  BOOST_CHECK(context.parseRequest(&input, Timestamp::now()));
+  input.append("56789GET");
+  BOOST_CHECK(context.parseRequest(&input, Timestamp::now()));
+  BOOST_CHECK(context.gotAll());
+  BOOST_CHECK_EQUAL(received, string("0123456789"));
+  BOOST_CHECK_EQUAL(pieces, 2);
+  BOOST_CHECK(context.request().body().empty());
+  BOOST_CHECK_EQUAL(input.retrieveAllAsString(), string("GET"));
+}
+
+BOOST_AUTO_TEST_CASE(testParseBodyErrors)
+{
+  struct
+  {
+    const char* request;
+    HttpResponse::HttpStatusCode error;
+  } bad[] = {
+    { "POST / HTTP/1.1\r\nContent-Length: 5\r\nTransfer-Encoding: chunked\r\n\r\n",
+      HttpResponse::k400BadRequest },
+    { "POST / HTTP/1.1\r\nContent-Length: 5\r\nContent-Length: 6\r\n\r\n",
+      HttpResponse::k400BadRequest },
+    { "POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n",
+      HttpResponse::k400BadRequest },
+    { "POST / HTTP/1.1\r\nTransfer-Encoding: gzip, chunked\r\n\r\n",
+      HttpResponse::k501NotImplemented },
+    { "POST / HTTP/1.1\r\nContent-Length: 1025\r\n\r\n",
+      HttpResponse::k413PayloadTooLarge },
+    { "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n",
+      HttpResponse::k400BadRequest },
+    { "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nabc\r\n",
+      HttpResponse::k400BadRequest },
+    { "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n400\r\n",
+      HttpResponse::k400BadRequest },
+    { "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n401\r\n",
+      HttpResponse::k413PayloadTooLarge },
+    { "GET HTTP/1.1\r\n\r\n",
+      HttpResponse::k400BadRequest },
+  };
+  for (const auto& test : bad)
+  {
+    HttpContext context;
+    context.setMaxBodySize(1024);
+    Buffer input;
+    input.append(test.request);
+    input.append(string(1026, 'x'));
+    BOOST_CHECK_MESSAGE(!context.parseRequest(&input, Timestamp::now()), test.request);
+    BOOST_CHECK_EQUAL(context.error(), test.error);
+  }
+}
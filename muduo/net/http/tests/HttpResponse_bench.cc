@@ -0,0 +1,140 @@
+#include <muduo/net/http/HttpContext.h>
+#include <muduo/net/http/HttpResponse.h>
+#include <muduo/net/Buffer.h>
+#include <muduo/base/Timestamp.h>
+
+#include <map>
+#include <new>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+int64_t g_allocations = 0;
+
+void* operator new(size_t size)
+{
+  ++g_allocations;
+  void* p = malloc(size);
+  if (p == NULL)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept
+{
+  free(p);
+}
+
+const char kRequest[] =
+  "GET /api/status HTTP/1.1\r\n"
+  "Host: www.chenshuo.com\r\n"
+  "User-Agent: curl/7.58.0\r\n"
+  "Accept: application/json\r\n"
+  "\r\n";
+
+const char kJson[] = "{\"status\":\"ok\",\"connections\":42}";
+
+// HttpResponse as it was, a std::map and snprintf
+struct OldResponse
+{
+  std::map<string, string> headers;
+  int statusCode;
+  string statusMessage;
+  bool closeConnection;
+  string body;
+
+  void appendToBuffer(Buffer* output) const
+  {
+    char buf[32];
+    snprintf(buf, sizeof buf, "HTTP/1.1 %d ", statusCode);
+    output->append(buf);
+    output->append(statusMessage);
+    output->append("\r\n");
+    if (closeConnection)
+    {
+      output->append("Connection: close\r\n");
+    }
+    else
+    {
+      snprintf(buf, sizeof buf, "Content-Length: %zd\r\n", body.size());
+      output->append(buf);
+      output->append("Connection: Keep-Alive\r\n");
+    }
+    for (const auto& header : headers)
+    {
+      output->append(header.first);
+      output->append(": ");
+      output->append(header.second);
+      output->append("\r\n");
+    }
+    output->append("\r\n");
+    output->append(body);
+  }
+};
+
+template<typename Func>
+void bench(const char* name, int n, Func func)
+{
+  Buffer input;
+  Buffer output;
+  int64_t allocations = g_allocations;
+  Timestamp start(Timestamp::now());
+  for (int i = 0; i < n; ++i)
+  {
+    input.append(kRequest, sizeof kRequest - 1);
+    func(&input, &output);
+    output.retrieveAll();
+  }
+  double seconds = timeDifference(Timestamp::now(), start);
+  printf("%-28s %7.1f ns/request %6.2f allocations/request\n", name, seconds * 1e9 / n,
+         static_cast<double>(g_allocations - allocations) / n);
+}
+
+int main(int argc, char* argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 1000 * 1000;
+
+  // what HttpServer did per request: headers kept in a std::map,
+  // a response and a Buffer of its own
+  HttpContext oldContext;
+  bench("std::map, snprintf", n, [&oldContext](Buffer* input, Buffer* output) {
+    oldContext.parseRequest(input, Timestamp());
+    const HttpHeaders& headers = oldContext.request().headers();
+    std::map<string, string> requestHeaders;
+    for (int i = 0; i < headers.size(); ++i)
+    {
+      requestHeaders[headers.name(i).as_string()] = headers.value(i).as_string();
+    }
+    OldResponse response;
+    response.closeConnection = requestHeaders["Connection"] == "close";
+    response.statusCode = 200;
+    response.statusMessage = "OK";
+    response.headers["Content-Type"] = "application/json";
+    response.headers["Server"] = "Muduo";
+    response.body = kJson;
+    Buffer buf;
+    response.appendToBuffer(&buf);
+    output->append(buf.peek(), buf.readableBytes());
+    oldContext.reset();
+  });
+
+  // what it does now, a context per connection
+  HttpContext context;
+  bench("HttpHeaders, in place", n, [&context](Buffer* input, Buffer* output) {
+    context.parseRequest(input, Timestamp());
+    const HttpRequest& req = context.request();
+    HttpResponse* response = context.response();
+    response->reset(req.header(HttpHeaders::kConnection) == "close");
+    response->setStatusCode(HttpResponse::k200Ok);
+    response->setContentType("application/json");
+    response->addHeader("Server", "Muduo");
+    response->setBody(kJson);
+    response->appendToBuffer(output);
+    context.reset();
+  });
+}
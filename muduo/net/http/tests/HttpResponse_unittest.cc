@@ -0,0 +1,146 @@
+#include <muduo/net/http/HttpResponse.h>
+#include <muduo/net/Buffer.h>
+
+//#define BOOST_TEST_MODULE BufferTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using muduo::string;
+using muduo::net::Buffer;
+using muduo::net::HttpHeaders;
+using muduo::net::HttpResponse;
+
+BOOST_AUTO_TEST_CASE(testKeepAlive)
+{
+  HttpResponse response(false);
+  response.setStatusCode(HttpResponse::k200Ok);
+  response.setStatusMessage("OK");
+  response.setContentType("text/plain");
+  response.addHeader("Server", "Muduo");
+  response.setBody("hello, world!\n");
+
+  Buffer output;
+  response.appendToBuffer(&output);
+  BOOST_CHECK_EQUAL(output.retrieveAllAsString(),
+                    string("HTTP/1.1 200 OK\r\n"
+                           "Content-Length: 14\r\n"
+                           "Connection: Keep-Alive\r\n"
+                           "Content-Type: text/plain\r\n"
+                           "Server: Muduo\r\n"
+                           "\r\n"
+                           "hello, world!\n"));
+}
+
+BOOST_AUTO_TEST_CASE(testClose)
+{
+  HttpResponse response(true);
+  response.setStatusCode(HttpResponse::k404NotFound);
+
+  Buffer output;
+  response.appendToBuffer(&output);
+  // the usual reason phrase if none is set
+  BOOST_CHECK_EQUAL(output.retrieveAllAsString(),
+                    string("HTTP/1.1 404 Not Found\r\n"
+                           "Connection: close\r\n"
+                           "\r\n"));
+}
+
+BOOST_AUTO_TEST_CASE(testReset)
+{
+  HttpResponse response(false);
+  response.setStatusCode(HttpResponse::k301MovedPermanently);
+  response.addHeader("Location", "http://example.com/");
+  response.addHeader("location", "http://chenshuo.com/");
+  response.setContentType("text/html");
+  response.setContentType("text/plain");
+  BOOST_CHECK_EQUAL(response.headers().size(), 2);
+  BOOST_CHECK_EQUAL(response.headers().get(HttpHeaders::kLocation).as_string(),
+                    "http://chenshuo.com/");
+
+  string body(100000, 'x');
+  response.setBody(body);
+  Buffer output;
+  response.appendToBuffer(&output);
+  BOOST_CHECK_EQUAL(output.readableBytes(),
+                    strlen("HTTP/1.1 301 Moved Permanently\r\n"
+                           "Content-Length: 100000\r\n"
+                           "Connection: Keep-Alive\r\n"
+                           "location: http://chenshuo.com/\r\n"
+                           "Content-Type: text/plain\r\n"
+                           "\r\n") + body.size());
+
+  response.reset(true);
+  BOOST_CHECK(response.headers().empty());
+  BOOST_CHECK(response.body().empty());
+  BOOST_CHECK(response.closeConnection());
+}
+
+BOOST_AUTO_TEST_CASE(testChunked)
+{
+  HttpResponse response(false);
+  response.setStatusCode(HttpResponse::k200Ok);
+  response.setChunked(true);
+  response.setBody("hello, world!\n");
+
+  Buffer output;
+  response.appendToBuffer(&output);
+  BOOST_CHECK_EQUAL(output.retrieveAllAsString(),
+                    string("HTTP/1.1 200 OK\r\n"
+                           "Transfer-Encoding: chunked\r\n"
+                           "Connection: Keep-Alive\r\n"
+                           "\r\n"
+                           "e\r\n"
+                           "hello, world!\n\r\n"
+                           "0\r\n"
+                           "\r\n"));
+
+  HttpResponse::appendChunk(&output, string(300, 'x'));
+  HttpResponse::appendChunk(&output, "");
+  HttpResponse::appendLastChunk(&output);
+  BOOST_CHECK_EQUAL(output.retrieveAllAsString(),
+                    "12c\r\n" + string(300, 'x') + "\r\n0\r\n\r\n");
+}
+
+BOOST_AUTO_TEST_CASE(testFileBody)
+{
+  HttpResponse response(false);
+  response.setStatusCode(HttpResponse::k200Ok);
+  response.setBody("not sent");
+  response.setFileBody(0, 100, 1234, std::shared_ptr<const void>());
+  BOOST_CHECK(response.hasFileBody());
+  BOOST_CHECK(response.body().empty());
+
+  // the file is for the caller to send
+  Buffer output;
+  response.appendToBuffer(&output);
+  BOOST_CHECK_EQUAL(output.retrieveAllAsString(),
+                    string("HTTP/1.1 200 OK\r\n"
+                           "Content-Length: 1234\r\n"
+                           "Connection: Keep-Alive\r\n"
+                           "\r\n"));
+
+  response.reset(false);
+  BOOST_CHECK(!response.hasFileBody());
+  response.setStatusCode(HttpResponse::k304NotModified);
+  response.appendToBuffer(&output);
+  BOOST_CHECK_EQUAL(output.retrieveAllAsString(),
+                    string("HTTP/1.1 304 Not Modified\r\n"
+                           "Connection: Keep-Alive\r\n"
+                           "\r\n"));
+}
+
+BOOST_AUTO_TEST_CASE(testHead)
+{
+  HttpResponse response(false);
+  response.setStatusCode(HttpResponse::k200Ok);
+  response.setBody("hello");
+
+  Buffer output;
+  response.appendHeadToBuffer(&output);
+  BOOST_CHECK_EQUAL(output.retrieveAllAsString(),
+                    string("HTTP/1.1 200 OK\r\n"
+                           "Content-Length: 5\r\n"
+                           "Connection: Keep-Alive\r\n"
+                           "\r\n"));
+}
@@ -5,7 +5,6 @@
 #include <muduo/base/Logging.h>
 
 #include <iostream>
-#include <map>
 
 using namespace muduo;
 using namespace muduo::net;
@@ -19,10 +18,10 @@ void onRequest(const HttpRequest& req, HttpResponse* resp)
   std::cout << "Headers " << req.methodString() << " " << req.path() << std::endl;
   if (!benchmark)
   {
-    const std::map<string, string>& headers = req.headers();
-    for (const auto& header : headers)
+    const HttpHeaders& headers = req.headers();
+    for (int i = 0; i < headers.size(); ++i)
     {
-      std::cout << header.first << ": " << header.second << std::endl;
+      std::cout << headers.name(i).as_string() << ": " << headers.value(i).as_string() << std::endl;
     }
   }
 
@@ -52,6 +51,13 @@ void onRequest(const HttpRequest& req, HttpResponse* resp)
     resp->addHeader("Server", "Muduo");
     resp->setBody("hello, world!\n");
   }
+  else if (req.path() == "/echo")
+  {
+    resp->setStatusCode(HttpResponse::k200Ok);
+    resp->setContentType("application/octet-stream");
+    resp->setChunked(true);
+    resp->setBody(req.body());
+  }
   else
   {
     resp->setStatusCode(HttpResponse::k404NotFound);
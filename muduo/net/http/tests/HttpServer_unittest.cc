@@ -0,0 +1,342 @@
+#include <muduo/net/http/HttpDeferredResponse.h>
+#include <muduo/net/http/HttpRequest.h>
+#include <muduo/net/http/HttpServer.h>
+#include <muduo/net/http/HttpStaticHandler.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/base/Thread.h>
+#include <muduo/base/ThreadPool.h>
+
+//#define BOOST_TEST_MODULE HttpServerTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <vector>
+
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using muduo::string;
+using muduo::Thread;
+using muduo::ThreadPool;
+using muduo::net::EventLoop;
+using muduo::net::HttpDeferredResponsePtr;
+using muduo::net::HttpRequest;
+using muduo::net::HttpResponse;
+using muduo::net::HttpServer;
+using muduo::net::HttpStaticHandler;
+using muduo::net::InetAddress;
+
+namespace
+{
+
+int connectTo(uint16_t port)
+{
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  InetAddress addr(port, true);
+  BOOST_REQUIRE(::connect(fd, addr.getSockAddr(), sizeof(struct sockaddr_in)) == 0);
+  return fd;
+}
+
+// till the peer closes
+string readAll(int fd)
+{
+  string result;
+  char buf[4096];
+  ssize_t n = 0;
+  while ((n = ::read(fd, buf, sizeof buf)) > 0)
+  {
+    result.append(buf, n);
+  }
+  return result;
+}
+
+}  // namespace
+
+// Requests pipelined in one write, done out of order in a pool,
+// the responses go back in order.
+BOOST_AUTO_TEST_CASE(testDeferredInOrder)
+{
+  EventLoop loop;
+  const uint16_t port = 23470;
+  HttpServer server(&loop, InetAddress(port, true), "DeferredServer");
+  ThreadPool pool;
+  pool.start(4);
+  server.setDeferredHttpCallback([&pool](const HttpDeferredResponsePtr& deferred) {
+    const string& path = deferred->request().path();
+    HttpResponse* response = deferred->response();
+    response->setStatusCode(HttpResponse::k200Ok);
+    response->setBody(path);
+    if (path == "/inline")
+    {
+      // done in the loop, right away
+      deferred->done();
+      return;
+    }
+    // the earlier, the slower
+    int delayMs = 50 - atoi(path.c_str() + 1) * 5;
+    pool.run([deferred, delayMs] {
+      ::usleep(delayMs * 1000);
+      deferred->done();
+    });
+  });
+  server.start();
+
+  const int kRequests = 10;
+  string expected;
+  string requests;
+  for (int i = 0; i < kRequests; ++i)
+  {
+    string path = i == 5 ? "/inline" : "/" + std::to_string(i);
+    requests += "GET " + path + " HTTP/1.1\r\n\r\n";
+    expected += "HTTP/1.1 200 OK\r\n"
+                "Content-Length: " + std::to_string(path.size()) + "\r\n"
+                "Connection: Keep-Alive\r\n\r\n" + path;
+  }
+  requests += "GET /last HTTP/1.1\r\nConnection: close\r\n\r\n";
+  expected += "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\n/last";
+
+  string received;
+  Thread client([&] {
+    int fd = connectTo(port);
+    BOOST_CHECK_EQUAL(::write(fd, requests.data(), requests.size()),
+                      static_cast<ssize_t>(requests.size()));
+    received = readAll(fd);
+    ::close(fd);
+    loop.quit();
+  });
+  loop.runAfter(0.1, [&client] { client.start(); });
+  loop.runAfter(5.0, [&loop] { loop.quit(); });
+  loop.loop();
+  client.join();
+  pool.stop();
+
+  BOOST_CHECK_EQUAL(received, expected);
+}
+
+// A bad request is answered after the ones still to come.
+BOOST_AUTO_TEST_CASE(testDeferredThenBadRequest)
+{
+  EventLoop loop;
+  const uint16_t port = 23471;
+  HttpServer server(&loop, InetAddress(port, true), "DeferredServer");
+  ThreadPool pool;
+  pool.start(1);
+  server.setDeferredHttpCallback([&pool](const HttpDeferredResponsePtr& deferred) {
+    pool.run([deferred] {
+      ::usleep(50 * 1000);
+      deferred->response()->setStatusCode(HttpResponse::k204NoContent);
+      deferred->done();
+    });
+  });
+  server.start();
+
+  string received;
+  Thread client([&] {
+    int fd = connectTo(port);
+    const char requests[] = "GET / HTTP/1.1\r\n\r\nBREW /pot HTTP/1.1\r\n\r\n";
+    BOOST_CHECK_EQUAL(::write(fd, requests, sizeof requests - 1),
+                      static_cast<ssize_t>(sizeof requests - 1));
+    received = readAll(fd);
+    ::close(fd);
+    loop.quit();
+  });
+  loop.runAfter(0.1, [&client] { client.start(); });
+  loop.runAfter(5.0, [&loop] { loop.quit(); });
+  loop.loop();
+  client.join();
+  pool.stop();
+
+  BOOST_CHECK_EQUAL(received, string("HTTP/1.1 204 No Content\r\n"
+                                     "Connection: Keep-Alive\r\n\r\n"
+                                     "HTTP/1.1 400 Bad Request\r\n"
+                                     "Connection: close\r\n\r\n"));
+}
+
+// Files go with sendfile(2) in between the responses in memory,
+// all in the order of requests.
+BOOST_AUTO_TEST_CASE(testStaticFile)
+{
+  char dir[] = "/tmp/httpserver_XXXXXX";
+  BOOST_REQUIRE(::mkdtemp(dir) != NULL);
+  string filename = string(dir) + "/big.bin";
+  string content;
+  for (int i = 0; i < 100 * 1024; ++i)
+  {
+    content += static_cast<char>('a' + i % 26);
+  }
+  FILE* fp = ::fopen(filename.c_str(), "w");
+  BOOST_REQUIRE(fp != NULL);
+  ::fwrite(content.data(), 1, content.size(), fp);
+  ::fclose(fp);
+
+  EventLoop loop;
+  const uint16_t port = 23472;
+  HttpServer server(&loop, InetAddress(port, true), "StaticServer");
+  HttpStaticHandler handler("/static/", dir);
+  server.setHttpCallback([&handler](const HttpRequest& req, HttpResponse* resp) {
+    if (!handler.handle(req, resp))
+    {
+      resp->setStatusCode(HttpResponse::k200Ok);
+      resp->setBody(req.path());
+    }
+  });
+  server.start();
+
+  string received;
+  Thread client([&] {
+    int fd = connectTo(port);
+    const char requests[] = "GET /static/big.bin HTTP/1.1\r\n\r\n"
+                            "GET /between HTTP/1.1\r\n\r\n"
+                            "HEAD /static/big.bin HTTP/1.1\r\n\r\n"
+                            "GET /static/big.bin HTTP/1.1\r\nRange: bytes=10-19\r\n\r\n"
+                            "GET /last HTTP/1.1\r\nConnection: close\r\n\r\n";
+    BOOST_CHECK_EQUAL(::write(fd, requests, sizeof requests - 1),
+                      static_cast<ssize_t>(sizeof requests - 1));
+    received = readAll(fd);
+    ::close(fd);
+    loop.quit();
+  });
+  loop.runAfter(0.1, [&client] { client.start(); });
+  loop.runAfter(5.0, [&loop] { loop.quit(); });
+  loop.loop();
+  client.join();
+  ::unlink(filename.c_str());
+  ::rmdir(dir);
+
+  // head, then the body after it
+  auto next = [&received](const string& status, size_t bodyLength) {
+    size_t headEnd = received.find("\r\n\r\n");
+    BOOST_REQUIRE(headEnd != string::npos);
+    string head = received.substr(0, headEnd + 4);
+    BOOST_CHECK_EQUAL(head.substr(0, status.size()), status);
+    string body = received.substr(headEnd + 4, bodyLength);
+    received.erase(0, headEnd + 4 + bodyLength);
+    return head + body;
+  };
+  string response = next("HTTP/1.1 200 OK", content.size());
+  BOOST_CHECK(response.find("Content-Length: 102400\r\n") != string::npos);
+  BOOST_CHECK(response.substr(response.size() - content.size()) == content);
+  BOOST_CHECK(next("HTTP/1.1 200 OK", 8).find("\r\n\r\n/between") != string::npos);
+  response = next("HTTP/1.1 200 OK", 0);
+  BOOST_CHECK(response.find("Content-Length: 102400\r\n") != string::npos);
+  response = next("HTTP/1.1 206 Partial Content", 10);
+  BOOST_CHECK(response.find("Content-Range: bytes 10-19/102400\r\n") != string::npos);
+  BOOST_CHECK_EQUAL(response.substr(response.size() - 10), content.substr(10, 10));
+  BOOST_CHECK_EQUAL(received, "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\n/last");
+}
+
+// 100 Continue held back behind a deferred response goes out after it.
+BOOST_AUTO_TEST_CASE(testDeferredThenContinue)
+{
+  EventLoop loop;
+  const uint16_t port = 23473;
+  HttpServer server(&loop, InetAddress(port, true), "ContinueServer");
+  ThreadPool pool;
+  pool.start(1);
+  server.setDeferredHttpCallback([&pool](const HttpDeferredResponsePtr& deferred) {
+    pool.run([deferred] {
+      ::usleep(50 * 1000);
+      HttpResponse* response = deferred->response();
+      response->setStatusCode(HttpResponse::k200Ok);
+      response->setBody(deferred->request().path() + deferred->request().body());
+      deferred->done();
+    });
+  });
+  server.start();
+
+  string received;
+  Thread client([&] {
+    int fd = connectTo(port);
+    struct timeval timeout = { 2, 0 };
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+    const char requests[] = "GET /a HTTP/1.1\r\n\r\n"
+                            "POST /b HTTP/1.1\r\nContent-Length: 5\r\n"
+                            "Expect: 100-continue\r\nConnection: close\r\n\r\n";
+    BOOST_CHECK_EQUAL(::write(fd, requests, sizeof requests - 1),
+                      static_cast<ssize_t>(sizeof requests - 1));
+    // the body only once asked for
+    char buf[4096];
+    ssize_t n = 0;
+    while (received.find("100 Continue\r\n\r\n") == string::npos
+           && (n = ::read(fd, buf, sizeof buf)) > 0)
+    {
+      received.append(buf, n);
+    }
+    BOOST_CHECK_EQUAL(::write(fd, "hello", 5), 5);
+    received += readAll(fd);
+    ::close(fd);
+    loop.quit();
+  });
+  loop.runAfter(0.1, [&client] { client.start(); });
+  loop.runAfter(5.0, [&loop] { loop.quit(); });
+  loop.loop();
+  client.join();
+  pool.stop();
+
+  BOOST_CHECK_EQUAL(received, string("HTTP/1.1 200 OK\r\n"
+                                     "Content-Length: 2\r\n"
+                                     "Connection: Keep-Alive\r\n\r\n/a"
+                                     "HTTP/1.1 100 Continue\r\n\r\n"
+                                     "HTTP/1.1 200 OK\r\n"
+                                     "Connection: close\r\n\r\n/bhello"));
+}
+
+// Pipelined requests beyond the limit wait to be read, none is lost.
+BOOST_AUTO_TEST_CASE(testPendingLimit)
+{
+  EventLoop loop;
+  const uint16_t port = 23474;
+  HttpServer server(&loop, InetAddress(port, true), "LimitedServer");
+  server.setMaxPendingResponses(4);
+  std::vector<HttpDeferredResponsePtr> pending;
+  size_t maxPending = 0;
+  server.setDeferredHttpCallback([&](const HttpDeferredResponsePtr& deferred) {
+    deferred->response()->setStatusCode(HttpResponse::k200Ok);
+    deferred->response()->setBody(deferred->request().path());
+    pending.push_back(deferred);
+    maxPending = std::max(maxPending, pending.size());
+  });
+  loop.runEvery(0.02, [&pending] {
+    for (const HttpDeferredResponsePtr& deferred : pending)
+    {
+      deferred->done();
+    }
+    pending.clear();
+  });
+  server.start();
+
+  const int kRequests = 20;
+  string requests;
+  string expected;
+  for (int i = 0; i < kRequests; ++i)
+  {
+    string path = "/" + std::to_string(i);
+    requests += "GET " + path + " HTTP/1.1\r\n\r\n";
+    expected += "HTTP/1.1 200 OK\r\n"
+                "Content-Length: " + std::to_string(path.size()) + "\r\n"
+                "Connection: Keep-Alive\r\n\r\n" + path;
+  }
+  requests += "GET /last HTTP/1.1\r\nConnection: close\r\n\r\n";
+  expected += "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\n/last";
+
+  string received;
+  Thread client([&] {
+    int fd = connectTo(port);
+    BOOST_CHECK_EQUAL(::write(fd, requests.data(), requests.size()),
+                      static_cast<ssize_t>(requests.size()));
+    received = readAll(fd);
+    ::close(fd);
+    loop.quit();
+  });
+  loop.runAfter(0.1, [&client] { client.start(); });
+  loop.runAfter(5.0, [&loop] { loop.quit(); });
+  loop.loop();
+  client.join();
+
+  BOOST_CHECK_EQUAL(received, expected);
+  BOOST_CHECK_EQUAL(maxPending, 4u);
+}
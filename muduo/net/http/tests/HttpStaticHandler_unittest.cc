@@ -0,0 +1,272 @@
+#include <muduo/net/http/HttpStaticHandler.h>
+#include <muduo/net/http/HttpRequest.h>
+#include <muduo/net/http/HttpResponse.h>
+
+//#define BOOST_TEST_MODULE HttpStaticHandlerTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using muduo::string;
+using muduo::StringPiece;
+using muduo::Timestamp;
+using muduo::net::HttpFileCache;
+using muduo::net::HttpHeaders;
+using muduo::net::HttpRequest;
+using muduo::net::HttpResponse;
+using muduo::net::HttpStaticHandler;
+
+namespace
+{
+
+// files under a directory of its own, removed afterwards
+struct Root
+{
+  Root()
+  {
+    char name[] = "/tmp/httpstatic_XXXXXX";
+    BOOST_REQUIRE(::mkdtemp(name) != NULL);
+    dir = name;
+    ::mkdir((dir + "/docs").c_str(), 0755);
+    write("/hello.txt", "hello, world!\n");
+    write("/docs/index.html", "<html></html>");
+  }
+
+  ~Root()
+  {
+    ::unlink((dir + "/hello.txt").c_str());
+    ::unlink((dir + "/docs/index.html").c_str());
+    ::rmdir((dir + "/docs").c_str());
+    ::rmdir(dir.c_str());
+  }
+
+  void write(const string& path, const string& content)
+  {
+    FILE* fp = ::fopen((dir + path).c_str(), "w");
+    BOOST_REQUIRE(fp != NULL);
+    ::fwrite(content.data(), 1, content.size(), fp);
+    ::fclose(fp);
+  }
+
+  string dir;
+};
+
+HttpRequest makeRequest(const string& method, const string& path)
+{
+  HttpRequest req;
+  req.setMethod(method.data(), method.data() + method.size());
+  req.setPath(path.data(), path.data() + path.size());
+  return req;
+}
+
+// what's sent from the file
+string fileBody(const HttpResponse& resp)
+{
+  BOOST_REQUIRE(resp.hasFileBody());
+  string result(resp.fileLength(), '\0');
+  ssize_t n = ::pread(resp.fileFd(), &result[0], result.size(), resp.fileOffset());
+  BOOST_CHECK_EQUAL(n, static_cast<ssize_t>(result.size()));
+  return result;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(testGet)
+{
+  Root root;
+  HttpStaticHandler handler("/static/", root.dir);
+  HttpResponse resp(false);
+
+  BOOST_CHECK(!handler.handle(makeRequest("GET", "/api/hello.txt"), &resp));
+
+  BOOST_CHECK(handler.handle(makeRequest("GET", "/static/hello.txt"), &resp));
+  BOOST_CHECK_EQUAL(resp.statusCode(), HttpResponse::k200Ok);
+  BOOST_CHECK_EQUAL(fileBody(resp), "hello, world!\n");
+  BOOST_CHECK_EQUAL(resp.headers().get(HttpHeaders::kContentType).as_string(),
+                    "text/plain; charset=utf-8");
+  BOOST_CHECK(!resp.headers().get(HttpHeaders::kETag).empty());
+  BOOST_CHECK(!resp.headers().get(HttpHeaders::kLastModified).empty());
+  BOOST_CHECK_EQUAL(resp.headers().get("Accept-Ranges").as_string(), "bytes");
+
+  // a directory, its index.html
+  resp.reset(false);
+  BOOST_CHECK(handler.handle(makeRequest("GET", "/static/docs/"), &resp));
+  BOOST_CHECK_EQUAL(resp.statusCode(), HttpResponse::k200Ok);
+  BOOST_CHECK_EQUAL(fileBody(resp), "<html></html>");
+
+  resp.reset(false);
+  BOOST_CHECK(handler.handle(makeRequest("GET", "/static/docs"), &resp));
+  BOOST_CHECK_EQUAL(resp.statusCode(), HttpResponse::k301MovedPermanently);
+  BOOST_CHECK_EQUAL(resp.headers().get(HttpHeaders::kLocation).as_string(), "/static/docs/");
+
+  resp.reset(false);
+  BOOST_CHECK(handler.handle(makeRequest("GET", "/static/no-such-file"), &resp));
+  BOOST_CHECK_EQUAL(resp.statusCode(), HttpResponse::k404NotFound);
+
+  resp.reset(false);
+  BOOST_CHECK(handler.handle(makeRequest("POST", "/static/hello.txt"), &resp));
+  BOOST_CHECK_EQUAL(resp.statusCode(), HttpResponse::k405MethodNotAllowed);
+}
+
+BOOST_AUTO_TEST_CASE(testOutOfRoot)
+{
+  Root root;
+  string docs = root.dir + "/docs";
+  HttpStaticHandler handler("/", docs);
+  const char* paths[] = { "/../hello.txt", "/%2e%2e/hello.txt", "/x/../../hello.txt",
+                          "/..", "/hello.txt%00", "/%zz" };
+  for (const char* path : paths)
+  {
+    HttpResponse resp(false);
+    BOOST_CHECK(handler.handle(makeRequest("GET", path), &resp));
+    BOOST_CHECK_EQUAL(resp.statusCode(), HttpResponse::k404NotFound);
+    BOOST_CHECK(!resp.hasFileBody());
+  }
+  HttpResponse resp(false);
+  BOOST_CHECK(handler.handle(makeRequest("GET", "/index%2Ehtml"), &resp));
+  BOOST_CHECK_EQUAL(resp.statusCode(), HttpResponse::k200Ok);
+}
+
+BOOST_AUTO_TEST_CASE(testNotModified)
+{
+  Root root;
+  HttpStaticHandler handler("/static/", root.dir);
+  HttpResponse resp(false);
+  handler.handle(makeRequest("GET", "/static/hello.txt"), &resp);
+  string etag = resp.headers().get(HttpHeaders::kETag).as_string();
+  string lastModified = resp.headers().get(HttpHeaders::kLastModified).as_string();
+
+  HttpRequest req = makeRequest("GET", "/static/hello.txt");
+  req.addHeader("If-None-Match", "\"other\", W/" + etag);
+  resp.reset(false);
+  handler.handle(req, &resp);
+  BOOST_CHECK_EQUAL(resp.statusCode(), HttpResponse::k304NotModified);
+  BOOST_CHECK(!resp.hasFileBody());
+  BOOST_CHECK_EQUAL(resp.headers().get(HttpHeaders::kETag).as_string(), etag);
+
+  req = makeRequest("GET", "/static/hello.txt");
+  req.addHeader("If-Modified-Since", lastModified);
+  resp.reset(false);
+  handler.handle(req, &resp);
+  BOOST_CHECK_EQUAL(resp.statusCode(), HttpResponse::k304NotModified);
+
+  req = makeRequest("GET", "/static/hello.txt");
+  req.addHeader("If-Modified-Since", "Sun, 06 Nov 1994 08:49:37 GMT");
+  resp.reset(false);
+  handler.handle(req, &resp);
+  BOOST_CHECK_EQUAL(resp.statusCode(), HttpResponse::k200Ok);
+
+  // If-None-Match wins
+  req = makeRequest("GET", "/static/hello.txt");
+  req.addHeader("If-None-Match", "\"other\"");
+  req.addHeader("If-Modified-Since", lastModified);
+  resp.reset(false);
+  handler.handle(req, &resp);
+  BOOST_CHECK_EQUAL(resp.statusCode(), HttpResponse::k200Ok);
+}
+
+BOOST_AUTO_TEST_CASE(testRange)
+{
+  Root root;
+  HttpStaticHandler handler("/static/", root.dir);
+  struct Case
+  {
+    const char* range;
+    HttpResponse::HttpStatusCode code;
+    const char* contentRange;
+    const char* body;
+  } cases[] =
+  {
+    { "bytes=0-4", HttpResponse::k206PartialContent, "bytes 0-4/14", "hello" },
+    { "bytes=7-", HttpResponse::k206PartialContent, "bytes 7-13/14", "world!\n" },
+    { "bytes=-7", HttpResponse::k206PartialContent, "bytes 7-13/14", "world!\n" },
+    { "bytes=7-100", HttpResponse::k206PartialContent, "bytes 7-13/14", "world!\n" },
+    { "bytes=-100", HttpResponse::k206PartialContent, "bytes 0-13/14", "hello, world!\n" },
+    { "bytes=14-", HttpResponse::k416RangeNotSatisfiable, "bytes */14", NULL },
+    { "bytes=-0", HttpResponse::k416RangeNotSatisfiable, "bytes */14", NULL },
+    // ignored
+    { "bytes=0-1,4-5", HttpResponse::k200Ok, "", "hello, world!\n" },
+    { "bytes=5-4", HttpResponse::k200Ok, "", "hello, world!\n" },
+    { "lines=1-2", HttpResponse::k200Ok, "", "hello, world!\n" },
+  };
+  for (const Case& c : cases)
+  {
+    BOOST_TEST_CHECKPOINT(c.range);
+    HttpRequest req = makeRequest("GET", "/static/hello.txt");
+    req.addHeader("Range", c.range);
+    HttpResponse resp(false);
+    handler.handle(req, &resp);
+    BOOST_CHECK_EQUAL(resp.statusCode(), c.code);
+    BOOST_CHECK_EQUAL(resp.headers().get(HttpHeaders::kContentRange).as_string(),
+                      c.contentRange);
+    if (c.body)
+    {
+      BOOST_CHECK_EQUAL(fileBody(resp), c.body);
+    }
+    else
+    {
+      BOOST_CHECK(!resp.hasFileBody());
+    }
+  }
+
+  // If-Range of another version, the whole
+  HttpRequest req = makeRequest("GET", "/static/hello.txt");
+  req.addHeader("Range", "bytes=0-4");
+  req.addHeader("If-Range", "\"other\"");
+  HttpResponse resp(false);
+  handler.handle(req, &resp);
+  BOOST_CHECK_EQUAL(resp.statusCode(), HttpResponse::k200Ok);
+  BOOST_CHECK_EQUAL(resp.fileLength(), 14u);
+}
+
+BOOST_AUTO_TEST_CASE(testFileCache)
+{
+  Root root;
+  string path = root.dir + "/hello.txt";
+  HttpFileCache cache(1, 10.0);
+  Timestamp now = Timestamp::now();
+
+  // a hit, the same fd
+  HttpFileCache::FilePtr file = cache.open(path, now);
+  BOOST_REQUIRE(file);
+  BOOST_CHECK_EQUAL(file->size(), 14);
+  BOOST_CHECK(cache.open(path, now) == file);
+
+  // evicted, still open for its holder
+  BOOST_CHECK(cache.open(root.dir + "/docs/index.html", now));
+  BOOST_CHECK_EQUAL(cache.size(), 1u);
+  BOOST_CHECK_EQUAL(file.use_count(), 1);
+  char buf[5];
+  BOOST_CHECK_EQUAL(::pread(file->fd(), buf, sizeof buf, 0), 5);
+
+  // replaced, seen once revalidated
+  HttpFileCache::FilePtr again = cache.open(path, now);
+  BOOST_REQUIRE(again);
+  ::unlink(path.c_str());
+  root.write("/hello.txt", "bye\n");
+  BOOST_CHECK(cache.open(path, now) == again);
+  HttpFileCache::FilePtr replaced = cache.open(path, addTime(now, 11.0));
+  BOOST_REQUIRE(replaced);
+  BOOST_CHECK(replaced != again);
+  BOOST_CHECK_EQUAL(replaced->size(), 4);
+
+  ::unlink(path.c_str());
+  BOOST_CHECK(!cache.open(path, addTime(now, 22.0)));
+  BOOST_CHECK_EQUAL(cache.size(), 0u);
+  root.write("/hello.txt", "");
+}
+
+BOOST_AUTO_TEST_CASE(testHttpDate)
+{
+  BOOST_CHECK_EQUAL(HttpFileCache::formatHttpDate(784111777),
+                    "Sun, 06 Nov 1994 08:49:37 GMT");
+  BOOST_CHECK_EQUAL(HttpFileCache::parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT"),
+                    784111777);
+  BOOST_CHECK_EQUAL(HttpFileCache::parseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT"), -1);
+  BOOST_CHECK_EQUAL(HttpFileCache::parseHttpDate("Sun, 06 Foo 1994 08:49:37 GMT"), -1);
+}
@@ -17,6 +17,7 @@
 #include <muduo/net/inspect/ProcessInspector.h>
 #include <muduo/net/inspect/PerformanceInspector.h>
 #include <muduo/net/inspect/SystemInspector.h>
+#include <muduo/net/inspect/TrafficInspector.h>
 
 //#include <iostream>
 //#include <iterator>
@@ -64,7 +65,8 @@ Inspector::Inspector(EventLoop* loop,
                      const string& name)
     : server_(loop, httpAddr, "Inspector:"+name),
       processInspector_(new ProcessInspector),
-      systemInspector_(new SystemInspector)
+      systemInspector_(new SystemInspector),
+      trafficInspector_(new TrafficInspector)
 {
   //断言这个对象是在主线程中调用的
   assert(CurrentThread::isMainThread());
@@ -74,6 +76,7 @@ Inspector::Inspector(EventLoop* loop,
   //注册一些命令
   processInspector_->registerCommands(this);
   systemInspector_->registerCommands(this);
+  trafficInspector_->registerCommands(this);
 #ifdef HAVE_TCMALLOC
   performanceInspector_.reset(new PerformanceInspector);
   performanceInspector_->registerCommands(this);
@@ -113,6 +116,16 @@ void Inspector::remove(const string& module, const string& command)
   }
 }
 
+void Inspector::addTcpServer(TcpServer* server)
+{
+  trafficInspector_->addServer(server);
+}
+
+void Inspector::removeTcpServer(TcpServer* server)
+{
+  trafficInspector_->removeServer(server);
+}
+
 void Inspector::start()
 {
   server_.start();
@@ -25,6 +25,8 @@ namespace net
 class ProcessInspector;
 class PerformanceInspector;
 class SystemInspector;
+class TcpServer;
+class TrafficInspector;
 
 // An internal inspector of the running process, usually a singleton.
 // Better to run in a seperated thread, as some method may block for seconds
@@ -49,6 +51,12 @@ class Inspector : noncopyable
            const string& help);
   void remove(const string& module, const string& command);
 
+  /// Shows the traffic of server under /traffic, server must be
+  /// removed before it is destructed.
+  /// Thread safe.
+  void addTcpServer(TcpServer* server);
+  void removeTcpServer(TcpServer* server);
+
  private:
   typedef std::map<string, Callback> CommandList;  //<command, callback>
   typedef std::map<string, string> HelpList;       //<command, help>
@@ -60,6 +68,7 @@ class Inspector : noncopyable
   std::unique_ptr<ProcessInspector> processInspector_;
   std::unique_ptr<PerformanceInspector> performanceInspector_;
   std::unique_ptr<SystemInspector> systemInspector_;
+  std::unique_ptr<TrafficInspector> trafficInspector_;
   MutexLock mutex_;
   std::map<string, CommandList> modules_ GUARDED_BY(mutex_);
   std::map<string, HelpList> helps_ GUARDED_BY(mutex_);
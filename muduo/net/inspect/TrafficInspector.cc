@@ -0,0 +1,170 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+
+#include <muduo/net/inspect/TrafficInspector.h>
+
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/EventLoopThreadPool.h>
+#include <muduo/net/TcpServer.h>
+
+#include <algorithm>
+#include <set>
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+#include <stdlib.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+namespace muduo
+{
+namespace inspect
+{
+int stringPrintf(string* out, const char* fmt, ...) __attribute__ ((format (printf, 2, 3)));
+}
+}
+
+using namespace muduo::inspect;
+
+namespace
+{
+
+const int kDefaultTopConnections = 20;
+
+int64_t totalBytes(const TcpConnectionPtr& conn)
+{
+  const TrafficCounters& c = conn->trafficCounters();
+  return c.get(TrafficCounters::kBytesReceived) + c.get(TrafficCounters::kBytesSent);
+}
+
+bool moreBytes(const TcpConnectionPtr& lhs, const TcpConnectionPtr& rhs)
+{
+  return totalBytes(lhs) > totalBytes(rhs);
+}
+
+}  // namespace
+
+void TrafficInspector::registerCommands(Inspector* ins)
+{
+  using std::placeholders::_1;
+  using std::placeholders::_2;
+  ins->add("traffic", "servers", std::bind(&TrafficInspector::servers, this, _1, _2),
+           "print traffic of each server");
+  ins->add("traffic", "loops", std::bind(&TrafficInspector::loops, this, _1, _2),
+           "print traffic of each event loop");
+  ins->add("traffic", "connections", std::bind(&TrafficInspector::connections, this, _1, _2),
+           "print busiest connections, /traffic/connections/N for top N");
+}
+
+void TrafficInspector::addServer(TcpServer* server)
+{
+  MutexLockGuard lock(mutex_);
+  servers_.push_back(server);
+}
+
+void TrafficInspector::removeServer(TcpServer* server)
+{
+  MutexLockGuard lock(mutex_);
+  servers_.erase(std::remove(servers_.begin(), servers_.end(), server), servers_.end());
+}
+
+string TrafficInspector::servers(HttpRequest::Method, const Inspector::ArgList&)
+{
+  string result;
+  MutexLockGuard lock(mutex_);
+  for (TcpServer* server : servers_)
+  {
+    TrafficCounters total;
+    server->getTrafficCounters(&total);
+    TcpServer::AcceptStats stats = server->acceptStats();
+    result += "[" + server->name() + "] " + server->ipPort() + "\n";
+    result += total.toString();
+    stringPrintf(&result, "acceptWakeups      %" PRId64 "\n"
+                          "accepted           %" PRId64 "\n"
+                          "acceptThrottled    %" PRId64 "\n"
+                          "acceptFailures     %" PRId64 "\n",
+                 stats.wakeups, stats.accepted, stats.throttled, stats.failures);
+    result += "\n";
+  }
+  return result;
+}
+
+string TrafficInspector::loops(HttpRequest::Method, const Inspector::ArgList&)
+{
+  string result;
+  std::set<EventLoop*> printed;
+  MutexLockGuard lock(mutex_);
+  for (TcpServer* server : servers_)
+  {
+    std::vector<EventLoop*> loops = server->threadPool()->getAllLoops();
+    for (size_t i = 0; i < loops.size(); ++i)
+    {
+      if (printed.insert(loops[i]).second)
+      {
+        stringPrintf(&result, "[%s] loop %zd\n", server->name().c_str(), i);
+        result += loops[i]->trafficCounters()->toString();
+        result += "\n";
+      }
+    }
+  }
+  return result;
+}
+
+string TrafficInspector::connections(HttpRequest::Method, const Inspector::ArgList& args)
+{
+  int top = kDefaultTopConnections;
+  if (!args.empty())
+  {
+    top = std::max(atoi(args[0].c_str()), 1);
+  }
+
+  std::vector<TcpConnectionPtr> conns;
+  {
+  MutexLockGuard lock(mutex_);
+  for (TcpServer* server : servers_)
+  {
+    std::vector<TcpConnectionPtr> some = server->connections();
+    conns.insert(conns.end(), some.begin(), some.end());
+  }
+  }
+
+  size_t n = std::min(conns.size(), static_cast<size_t>(top));
+  std::partial_sort(conns.begin(), conns.begin() + n, conns.end(), moreBytes);
+
+  Timestamp now = Timestamp::now();
+  string result;
+  stringPrintf(&result, "%zd connections, top %zd by bytes\n", conns.size(), n);
+  result += "name age(s) idle(s) bytesReceived bytesSent messagesReceived messagesSent "
+            "outputBytesPeak highWaterMarkHits\n";
+  for (size_t i = 0; i < n; ++i)
+  {
+    const TcpConnectionPtr& conn = conns[i];
+    const TrafficCounters& c = conn->trafficCounters();
+    int64_t lastReceive = c.get(TrafficCounters::kLastReceiveTime);
+    double idle = lastReceive > 0
+        ? timeDifference(now, Timestamp(lastReceive))
+        : timeDifference(now, conn->creationTime());
+    stringPrintf(&result, "%s %.3f %.3f %" PRId64 " %" PRId64 " %" PRId64 " %" PRId64
+                 " %" PRId64 " %" PRId64 "\n",
+                 conn->name().c_str(),
+                 timeDifference(now, conn->creationTime()),
+                 idle,
+                 c.get(TrafficCounters::kBytesReceived),
+                 c.get(TrafficCounters::kBytesSent),
+                 c.get(TrafficCounters::kMessagesReceived),
+                 c.get(TrafficCounters::kMessagesSent),
+                 c.get(TrafficCounters::kOutputBytesPeak),
+                 c.get(TrafficCounters::kHighWaterMarkHits));
+  }
+  return result;
+}
@@ -0,0 +1,46 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+// This is an internal header file, you should not include this.
+
+#ifndef MUDUO_NET_INSPECT_TRAFFICINSPECTOR_H
+#define MUDUO_NET_INSPECT_TRAFFICINSPECTOR_H
+
+#include <muduo/net/inspect/Inspector.h>
+
+#include <vector>
+
+namespace muduo
+{
+namespace net
+{
+
+class TcpServer;
+
+// Traffic of the TcpServers added to Inspector, and of their loops.
+class TrafficInspector : noncopyable
+{
+ public:
+  void registerCommands(Inspector* ins);
+
+  void addServer(TcpServer* server);
+  void removeServer(TcpServer* server);
+
+  string servers(HttpRequest::Method, const Inspector::ArgList&);
+  string loops(HttpRequest::Method, const Inspector::ArgList&);
+  string connections(HttpRequest::Method, const Inspector::ArgList&);
+
+ private:
+  MutexLock mutex_;
+  std::vector<TcpServer*> servers_ GUARDED_BY(mutex_);
+};
+
+}  // namespace net
+}  // namespace muduo
+
+#endif  // MUDUO_NET_INSPECT_TRAFFICINSPECTOR_H
@@ -9,6 +9,11 @@
 #include <muduo/net/Poller.h>
 #include <muduo/net/poller/PollPoller.h>
 #include <muduo/net/poller/EPollPoller.h>
+#ifndef NO_IO_URING
+#include <muduo/net/poller/IoUringPoller.h>
+#endif
+
+#include <muduo/base/Logging.h>
 
 #include <stdlib.h>
 
@@ -20,8 +25,16 @@ Poller* Poller::newDefaultPoller(EventLoop* loop)
   {
     return new PollPoller(loop);
   }
-  else
+#ifndef NO_IO_URING
+  if (::getenv("MUDUO_USE_URING"))
   {
-    return new EPollPoller(loop);
+    std::unique_ptr<IoUringPoller> poller(new IoUringPoller(loop));
+    if (poller->ok())
+    {
+      return poller.release();
+    }
+    LOG_WARN << "io_uring is not available, fall back to epoll";
   }
+#endif
+  return new EPollPoller(loop);
 }
@@ -0,0 +1,698 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+
+#ifndef NO_IO_URING
+
+#include <muduo/net/poller/IoUringPoller.h>
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/Channel.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+namespace
+{
+const uint64_t kCancelUserData = ~static_cast<uint64_t>(0);
+
+int io_uring_setup(unsigned entries, struct io_uring_params* p)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int io_uring_register(int fd, unsigned opcode, const void* arg, unsigned nrArgs)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+}
+
+int io_uring_enter(int fd, unsigned toSubmit, unsigned minComplete,
+                   unsigned flags, const void* arg, size_t argsz)
+{
+  return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit,
+                                    minComplete, flags, arg, argsz));
+}
+
+const uint64_t kRecvUserDataBit = static_cast<uint64_t>(1) << 31;
+const int kReadEvents = POLLIN | POLLPRI;
+
+// a poll and a recv for each fd we may have, the kernel clamps it
+unsigned completionEntries(unsigned ringEntries)
+{
+  struct rlimit rl;
+  rlim_t files = ::getrlimit(RLIMIT_NOFILE, &rl) == 0 ? rl.rlim_cur : 0;
+  rlim_t entries = std::max(static_cast<rlim_t>(2 * ringEntries), 2 * files);
+  return static_cast<unsigned>(std::min(entries, static_cast<rlim_t>(1u << 20)));
+}
+
+// generation:32 | recv:1 | slot:31
+uint64_t makeUserData(int slot, unsigned generation, bool recv)
+{
+  return (static_cast<uint64_t>(generation) << 32)
+      | (recv ? kRecvUserDataBit : 0)
+      | static_cast<uint32_t>(slot);
+}
+
+void* mmapRing(int fd, size_t length, off_t offset)
+{
+  void* p = ::mmap(NULL, length, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, offset);
+  return p == MAP_FAILED ? NULL : p;
+}
+
+template<typename T>
+T* ringField(void* ring, unsigned offset)
+{
+  return static_cast<T*>(static_cast<void*>(static_cast<char*>(ring) + offset));
+}
+}  // namespace
+
+IoUringPoller::IoUringPoller(EventLoop* loop)
+  : Poller(loop),
+    ringfd_(-1),
+    sqEntries_(0),
+    toSubmit_(0),
+    sqFull_(false),
+    sqRing_(NULL),
+    sqRingSize_(0),
+    cqRing_(NULL),
+    cqRingSize_(0),
+    sqes_(NULL),
+    sqesSize_(0),
+    sqHead_(NULL),
+    sqTail_(NULL),
+    sqMask_(NULL),
+    sqArray_(NULL),
+    cqHead_(NULL),
+    cqTail_(NULL),
+    cqMask_(NULL),
+    cqes_(NULL),
+    recvRingTried_(false),
+    recvRing_(NULL),
+    recvRingBufs_(NULL),
+    recvRingTailPtr_(NULL),
+    recvRingTail_(0)
+{
+  if (!setupRing())
+  {
+    LOG_SYSERR << "IoUringPoller::IoUringPoller";
+    if (ringfd_ >= 0)
+    {
+      ::close(ringfd_);
+      ringfd_ = -1;
+    }
+  }
+}
+
+IoUringPoller::~IoUringPoller()
+{
+  // closing the ring cancels all requests in flight,
+  // so no more writes into recvBuffers_ after this.
+  if (ringfd_ >= 0)
+  {
+    ::close(ringfd_);
+  }
+  if (recvRing_)
+  {
+    ::munmap(recvRing_, kRecvBufferCount * sizeof(struct io_uring_buf));
+  }
+  if (sqes_)
+  {
+    ::munmap(sqes_, sqesSize_);
+  }
+  if (cqRing_ && cqRing_ != sqRing_)
+  {
+    ::munmap(cqRing_, cqRingSize_);
+  }
+  if (sqRing_)
+  {
+    ::munmap(sqRing_, sqRingSize_);
+  }
+}
+
+bool IoUringPoller::setupRing()
+{
+  struct io_uring_params params;
+  memZero(&params, sizeof params);
+  // the default of twice kRingEntries overflows with many channels
+  params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+  params.cq_entries = completionEntries(kRingEntries);
+  ringfd_ = io_uring_setup(kRingEntries, &params);
+  if (ringfd_ < 0)
+  {
+    return false;
+  }
+  // we wait with a timeout via IORING_ENTER_EXT_ARG,
+  // and rely on the kernel never dropping completions.
+  if (!(params.features & IORING_FEAT_EXT_ARG)
+      || !(params.features & IORING_FEAT_NODROP))
+  {
+    errno = ENOSYS;
+    return false;
+  }
+
+  sqEntries_ = params.sq_entries;
+  sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP)
+  {
+    sqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+    cqRingSize_ = sqRingSize_;
+  }
+
+  sqRing_ = mmapRing(ringfd_, sqRingSize_, IORING_OFF_SQ_RING);
+  if (!sqRing_)
+  {
+    return false;
+  }
+  if (params.features & IORING_FEAT_SINGLE_MMAP)
+  {
+    cqRing_ = sqRing_;
+  }
+  else
+  {
+    cqRing_ = mmapRing(ringfd_, cqRingSize_, IORING_OFF_CQ_RING);
+    if (!cqRing_)
+    {
+      return false;
+    }
+  }
+  sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  sqes_ = static_cast<struct io_uring_sqe*>(mmapRing(ringfd_, sqesSize_, IORING_OFF_SQES));
+  if (!sqes_)
+  {
+    return false;
+  }
+
+  sqHead_ = ringField<unsigned>(sqRing_, params.sq_off.head);
+  sqTail_ = ringField<unsigned>(sqRing_, params.sq_off.tail);
+  sqMask_ = ringField<unsigned>(sqRing_, params.sq_off.ring_mask);
+  sqArray_ = ringField<unsigned>(sqRing_, params.sq_off.array);
+  cqHead_ = ringField<unsigned>(cqRing_, params.cq_off.head);
+  cqTail_ = ringField<unsigned>(cqRing_, params.cq_off.tail);
+  cqMask_ = ringField<unsigned>(cqRing_, params.cq_off.ring_mask);
+  cqes_ = ringField<struct io_uring_cqe>(cqRing_, params.cq_off.cqes);
+  return true;
+}
+
+bool IoUringPoller::setupRecvRing()
+{
+  assert(!recvRingTried_);
+  recvRingTried_ = true;
+  size_t ringSize = kRecvBufferCount * sizeof(struct io_uring_buf);
+  void* ring = ::mmap(NULL, ringSize, PROT_READ | PROT_WRITE,
+                      MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+  if (ring == MAP_FAILED)
+  {
+    LOG_SYSERR << "IoUringPoller::setupRecvRing - mmap";
+    return false;
+  }
+  struct io_uring_buf_reg reg;
+  memZero(&reg, sizeof reg);
+  reg.ring_addr = reinterpret_cast<uintptr_t>(ring);
+  reg.ring_entries = kRecvBufferCount;
+  reg.bgid = kRecvBufferGroup;
+  if (io_uring_register(ringfd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+  {
+    LOG_SYSERR << "IoUringPoller::setupRecvRing - fall back to polling";
+    ::munmap(ring, ringSize);
+    return false;
+  }
+
+  recvRing_ = ring;
+  recvRingBufs_ = static_cast<struct io_uring_buf*>(ring);
+  recvRingTailPtr_ = &static_cast<struct io_uring_buf_ring*>(ring)->tail;
+  recvBuffers_.assign(kRecvBufferCount, Buffer(kRecvBufferSize));
+  for (unsigned bid = 0; bid < kRecvBufferCount; ++bid)
+  {
+    provideRecvBuffer(static_cast<int>(bid));
+  }
+  return true;
+}
+
+Timestamp IoUringPoller::poll(int timeoutMs, ChannelList* activeChannels)
+{
+  LOG_TRACE << "fd total count " << channels_.size();
+  for (int bid : lentBuffers_)
+  {
+    provideRecvBuffer(bid);
+  }
+  lentBuffers_.clear();
+
+  if (!pendingCancels_.empty())
+  {
+    // those the ring was too full for
+    std::vector<Cancel> cancels;
+    cancels.swap(pendingCancels_);
+    for (const Cancel& c : cancels)
+    {
+      cancel(c.opcode, c.target);
+    }
+  }
+
+  // those that don't fit in the ring are queued again
+  armingSlots_.swap(pendingSlots_);
+  for (int slot : armingSlots_)
+  {
+    Slot& s = slots_[slot];
+    s.queued = false;
+    if (s.channel == NULL)
+    {
+      continue;
+    }
+    if (s.armedEvents == 0 && pollEventsOf(s.channel) != 0)
+    {
+      armPoll(slot);
+    }
+    if (wantRecv(s.channel))
+    {
+      if (s.parkedBuffer >= 0)
+      {
+        // reading was resumed, deliver what we got in the meantime,
+        // and receive again in next poll(), after it's handed over
+        activateSlot(slot, POLLIN, s.parkedBuffer);
+        s.parkedBuffer = -1;
+        queueSlot(slot);
+      }
+      else if (!s.recvArmed)
+      {
+        armRecv(slot);
+      }
+    }
+  }
+  armingSlots_.clear();
+
+  // don't sleep on those left for the ring to drain
+  int ret = submitAndWait(activeSlots_.empty() && pendingSlots_.empty() ? timeoutMs : 0);
+  int savedErrno = errno;
+  sqFull_ = false;
+  Timestamp now(Timestamp::now());
+  if (ret < 0 && savedErrno != EINTR && savedErrno != ETIME && savedErrno != EBUSY)
+  {
+    errno = savedErrno;
+    LOG_SYSERR << "IoUringPoller::poll()";
+  }
+  // completions may be there even if waiting failed
+  reapCompletions();
+  if (!activeSlots_.empty())
+  {
+    LOG_TRACE << activeSlots_.size() << " events happened";
+    fillActiveChannels(activeChannels);
+  }
+  else
+  {
+    LOG_TRACE << "nothing happened";
+  }
+  return now;
+}
+
+int IoUringPoller::submitAndWait(int timeoutMs)
+{
+  struct __kernel_timespec ts;
+  struct io_uring_getevents_arg arg;
+  memZero(&arg, sizeof arg);
+  if (timeoutMs >= 0)
+  {
+    ts.tv_sec = timeoutMs / 1000;
+    ts.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000 * 1000;
+    arg.ts = reinterpret_cast<uintptr_t>(&ts);
+  }
+  int ret = io_uring_enter(ringfd_, toSubmit_, timeoutMs == 0 ? 0 : 1,
+                           IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                           &arg, sizeof arg);
+  if (ret >= 0)
+  {
+    assert(implicit_cast<unsigned>(ret) <= toSubmit_);
+    toSubmit_ -= ret;
+  }
+  return ret;
+}
+
+void IoUringPoller::reapCompletions()
+{
+  unsigned head = *cqHead_;
+  unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head)
+  {
+    const struct io_uring_cqe& cqe = cqes_[head & *cqMask_];
+    if (cqe.user_data == kCancelUserData)
+    {
+      continue;
+    }
+    int slot = static_cast<int>(cqe.user_data & (kRecvUserDataBit - 1));
+    unsigned generation = static_cast<unsigned>(cqe.user_data >> 32);
+    bool recv = (cqe.user_data & kRecvUserDataBit) != 0;
+    assert(implicit_cast<size_t>(slot) < slots_.size());
+    Slot& s = slots_[slot];
+    if (recv)
+    {
+      int bid = -1;
+      if (cqe.flags & IORING_CQE_F_BUFFER)
+      {
+        bid = static_cast<int>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+      }
+      if (s.channel == NULL || s.generation != generation)
+      {
+        // the channel has been removed
+        if (bid >= 0)
+        {
+          provideRecvBuffer(bid);
+        }
+        continue;
+      }
+      s.recvArmed = false;
+      queueSlot(slot);
+      if (cqe.res > 0 && bid >= 0)
+      {
+        recvBuffers_[bid].hasWritten(cqe.res);
+        if (s.channel->isReading())
+        {
+          activateSlot(slot, POLLIN, bid);
+        }
+        else
+        {
+          s.parkedBuffer = bid;
+        }
+      }
+      else
+      {
+        // EOF, error or out of buffers, let readCallback_ find out by read(2).
+        if (bid >= 0)
+        {
+          provideRecvBuffer(bid);
+        }
+        if (s.channel->isReading())
+        {
+          activateSlot(slot, POLLIN, -1);
+        }
+      }
+    }
+    else
+    {
+      if (s.channel == NULL || s.pollGeneration != generation)
+      {
+        // completion of a cancelled poll, the channel has been re-armed or removed.
+        continue;
+      }
+      s.armedEvents = 0;
+      queueSlot(slot);
+      activateSlot(slot, cqe.res >= 0 ? cqe.res : POLLNVAL, -1);
+    }
+  }
+  __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+}
+
+void IoUringPoller::fillActiveChannels(ChannelList* activeChannels)
+{
+  for (int slot : activeSlots_)
+  {
+    Slot& s = slots_[slot];
+    assert(s.active);
+    Channel* channel = s.channel;
+#ifndef NDEBUG
+    ChannelMap::const_iterator it = channels_.find(channel->fd());
+    assert(it != channels_.end());
+    assert(it->second == channel);
+#endif
+    channel->set_revents(s.revents);
+    if (s.readyBuffer >= 0)
+    {
+      channel->set_recvBuffer(&recvBuffers_[s.readyBuffer]);
+      lentBuffers_.push_back(s.readyBuffer);
+    }
+    else
+    {
+      channel->set_recvBuffer(NULL);
+    }
+    s.active = false;
+    activeChannels->push_back(channel);
+  }
+  activeSlots_.clear();
+}
+
+void IoUringPoller::updateChannel(Channel* channel)
+{
+  Poller::assertInLoopThread();
+  LOG_TRACE << "fd = " << channel->fd()
+    << " events = " << channel->events() << " index = " << channel->index();
+  if (channel->index() < 0)
+  {
+    // a new one, will be armed in next poll()
+    assert(channels_.find(channel->fd()) == channels_.end());
+    if (channel->hasRecvCallback() && !recvRingTried_)
+    {
+      setupRecvRing();
+    }
+    int slot;
+    if (freeSlots_.empty())
+    {
+      slot = static_cast<int>(slots_.size());
+      Slot s = { NULL, 0, 0, 0, false, -1, false, false, 0, -1 };
+      slots_.push_back(s);
+    }
+    else
+    {
+      slot = freeSlots_.back();
+      freeSlots_.pop_back();
+    }
+    slots_[slot].channel = channel;
+    channel->set_index(slot);
+    channels_[channel->fd()] = channel;
+    queueSlot(slot);
+  }
+  else
+  {
+    // update existing one
+    int slot = channel->index();
+    assert(channels_.find(channel->fd()) != channels_.end());
+    assert(channels_[channel->fd()] == channel);
+    assert(implicit_cast<size_t>(slot) < slots_.size());
+    Slot& s = slots_[slot];
+    assert(s.channel == channel);
+    if (s.armedEvents != 0 && s.armedEvents != pollEventsOf(channel))
+    {
+      cancelPoll(slot);
+    }
+    // a recv in flight is kept even if reading is disabled,
+    // the data it brings is parked until reading is enabled again.
+    queueSlot(slot);
+  }
+}
+
+void IoUringPoller::removeChannel(Channel* channel)
+{
+  Poller::assertInLoopThread();
+  int fd = channel->fd();
+  LOG_TRACE << "fd = " << fd;
+  assert(channels_.find(fd) != channels_.end());
+  assert(channels_[fd] == channel);
+  assert(channel->isNoneEvent());
+  int slot = channel->index();
+  assert(0 <= slot && implicit_cast<size_t>(slot) < slots_.size());
+  Slot& s = slots_[slot];
+  assert(s.channel == channel);
+  assert(!s.active);
+  if (s.armedEvents != 0)
+  {
+    cancelPoll(slot);
+  }
+  if (s.recvArmed)
+  {
+    cancelRecv(slot);
+  }
+  if (s.parkedBuffer >= 0)
+  {
+    provideRecvBuffer(s.parkedBuffer);
+    s.parkedBuffer = -1;
+  }
+  s.channel = NULL;
+  ++s.generation;
+  ++s.pollGeneration;
+  freeSlots_.push_back(slot);
+  size_t n = channels_.erase(fd);
+  (void)n;
+  assert(n == 1);
+  channel->set_index(-1);
+}
+
+int IoUringPoller::pollEventsOf(const Channel* channel) const
+{
+  // kernel reads on behalf of receiving channels, only POLLOUT is polled.
+  return recvRing_ && channel->hasRecvCallback()
+      ? channel->events() & ~kReadEvents
+      : channel->events();
+}
+
+bool IoUringPoller::wantRecv(const Channel* channel) const
+{
+  return recvRing_ && channel->hasRecvCallback() && channel->isReading();
+}
+
+io_uring_sqe* IoUringPoller::getSqe()
+{
+  if (sqFull_)
+  {
+    return NULL;
+  }
+  unsigned tail = *sqTail_;
+  while (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_)
+  {
+    // submission ring is full, flush it without waiting
+    int ret = io_uring_enter(ringfd_, toSubmit_, 0, 0, NULL, 0);
+    if (ret > 0)
+    {
+      toSubmit_ -= ret;
+    }
+    else if (ret == 0 || errno != EINTR)
+    {
+      // EBUSY till completions are reaped, EAGAIN till the kernel has
+      // memory, the caller tries again in next poll().
+      if (ret < 0 && errno != EBUSY && errno != EAGAIN)
+      {
+        LOG_SYSERR << "IoUringPoller::getSqe()";
+      }
+      sqFull_ = true;
+      return NULL;
+    }
+  }
+  unsigned index = tail & *sqMask_;
+  struct io_uring_sqe* sqe = &sqes_[index];
+  memZero(sqe, sizeof *sqe);
+  sqArray_[index] = index;
+  // the kernel only looks at the ring in io_uring_enter(),
+  // so it's fine to publish the tail before filling the sqe.
+  __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+  ++toSubmit_;
+  return sqe;
+}
+
+void IoUringPoller::armPoll(int slot)
+{
+  Slot& s = slots_[slot];
+  assert(s.armedEvents == 0);
+  int events = pollEventsOf(s.channel);
+  struct io_uring_sqe* sqe = getSqe();
+  if (sqe == NULL)
+  {
+    queueSlot(slot);
+    return;
+  }
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = s.channel->fd();
+  sqe->poll32_events = static_cast<uint32_t>(events);
+  sqe->user_data = makeUserData(slot, s.pollGeneration, false);
+  s.armedEvents = events;
+  LOG_TRACE << "poll_add fd = " << sqe->fd
+    << " event = { " << s.channel->eventsToString() << " }";
+}
+
+void IoUringPoller::cancelPoll(int slot)
+{
+  Slot& s = slots_[slot];
+  assert(s.armedEvents != 0);
+  cancel(IORING_OP_POLL_REMOVE, makeUserData(slot, s.pollGeneration, false));
+  ++s.pollGeneration;
+  s.armedEvents = 0;
+}
+
+void IoUringPoller::armRecv(int slot)
+{
+  Slot& s = slots_[slot];
+  assert(!s.recvArmed);
+  struct io_uring_sqe* sqe = getSqe();
+  if (sqe == NULL)
+  {
+    queueSlot(slot);
+    return;
+  }
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = s.channel->fd();
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = kRecvBufferGroup;
+  sqe->user_data = makeUserData(slot, s.generation, true);
+  s.recvArmed = true;
+  LOG_TRACE << "recv fd = " << sqe->fd;
+}
+
+void IoUringPoller::cancelRecv(int slot)
+{
+  Slot& s = slots_[slot];
+  assert(s.recvArmed);
+  cancel(IORING_OP_ASYNC_CANCEL, makeUserData(slot, s.generation, true));
+  s.recvArmed = false;
+}
+
+void IoUringPoller::cancel(uint8_t opcode, uint64_t target)
+{
+  struct io_uring_sqe* sqe = getSqe();
+  if (sqe == NULL)
+  {
+    // the completion of target is stale already, it's just dropped later
+    Cancel c = { opcode, target };
+    pendingCancels_.push_back(c);
+    return;
+  }
+  sqe->opcode = opcode;
+  sqe->fd = -1;
+  sqe->addr = target;
+  sqe->user_data = kCancelUserData;
+}
+
+void IoUringPoller::provideRecvBuffer(int bid)
+{
+  Buffer& buf = recvBuffers_[bid];
+  // swapped by the receiver with one as large, so this doesn't allocate
+  buf.retrieveAll();
+  buf.ensureWritableBytes(kRecvBufferSize);
+  struct io_uring_buf* entry = &recvRingBufs_[recvRingTail_ & (kRecvBufferCount - 1)];
+  entry->addr = reinterpret_cast<uintptr_t>(buf.beginWrite());
+  entry->len = static_cast<uint32_t>(kRecvBufferSize);
+  entry->bid = static_cast<uint16_t>(bid);
+  ++recvRingTail_;
+  __atomic_store_n(recvRingTailPtr_, recvRingTail_, __ATOMIC_RELEASE);
+}
+
+void IoUringPoller::queueSlot(int slot)
+{
+  Slot& s = slots_[slot];
+  if (!s.queued)
+  {
+    s.queued = true;
+    pendingSlots_.push_back(slot);
+  }
+}
+
+void IoUringPoller::activateSlot(int slot, int revents, int bid)
+{
+  Slot& s = slots_[slot];
+  if (!s.active)
+  {
+    s.active = true;
+    s.revents = 0;
+    s.readyBuffer = -1;
+    activeSlots_.push_back(slot);
+  }
+  s.revents |= revents;
+  if (bid >= 0)
+  {
+    assert(s.readyBuffer < 0);
+    s.readyBuffer = bid;
+  }
+}
+
+#endif  // NO_IO_URING
@@ -0,0 +1,147 @@
+// Copyright 2010, Shuo Chen.  All rights reserved.
+// http://code.google.com/p/muduo/
+//
+// Use of this source code is governed by a BSD-style license
+// that can be found in the License file.
+
+// Author: Shuo Chen (chenshuo at chenshuo dot com)
+//
+// This is an internal header file, you should not include this.
+
+#ifndef MUDUO_NET_POLLER_IOURINGPOLLER_H
+#define MUDUO_NET_POLLER_IOURINGPOLLER_H
+
+#include <muduo/net/Buffer.h>
+#include <muduo/net/Poller.h>
+
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf;
+
+namespace muduo
+{
+namespace net
+{
+
+///
+/// IO Multiplexing with io_uring(7).
+///
+/// Each interested Channel has one one-shot IORING_OP_POLL_ADD in flight,
+/// which keeps the level-triggered semantics of EPollPoller.
+/// Interest changes and re-arms are queued in the submission ring and
+/// flushed together with the wait, so one poll() costs one io_uring_enter(2)
+/// no matter how many channels changed, and completions are reaped from
+/// the shared completion ring without further syscalls.
+///
+/// Channels with a RecvCallback are read by the kernel instead: an
+/// IORING_OP_RECV picks a Buffer from a provided buffer ring, and that
+/// Buffer is handed to the channel as is.  Buffers lent out are given
+/// back to the ring at the beginning of next poll().
+///
+/// Requires Linux 5.11 or later (IORING_FEAT_EXT_ARG), check ok() after
+/// construction.  Receiving needs 5.19 (IORING_REGISTER_PBUF_RING),
+/// otherwise those channels are polled as usual.
+///
+/// A request that finds the submission ring full, and the kernel taking
+/// none of it, e.g. EBUSY till completions are reaped, is made in next
+/// poll() instead.
+class IoUringPoller : public Poller
+{
+ public:
+  IoUringPoller(EventLoop* loop);
+  ~IoUringPoller() override;
+
+  /// false if io_uring is not available on this kernel.
+  bool ok() const { return ringfd_ >= 0; }
+
+  Timestamp poll(int timeoutMs, ChannelList* activeChannels) override;
+  void updateChannel(Channel* channel) override;
+  void removeChannel(Channel* channel) override;
+
+ private:
+  static const unsigned kRingEntries = 1024;
+  static const unsigned kRecvBufferCount = 128;  // power of 2
+  static const size_t kRecvBufferSize = 32 * 1024;
+  static const int kRecvBufferGroup = 0;
+
+  // per-channel state, indexed by Channel::index()
+  struct Slot
+  {
+    Channel* channel;
+    unsigned generation;      // bumped on remove, stale completions are dropped
+    unsigned pollGeneration;  // bumped on remove or cancelling the poll
+    int armedEvents;          // events of the poll in flight, 0 if none
+    bool recvArmed;           // a recv in flight
+    int parkedBuffer;         // received while not reading, -1 if none
+    bool queued;              // in pendingSlots_
+    bool active;              // in activeSlots_
+    int revents;
+    int readyBuffer;          // to be handed to the channel, -1 if none
+  };
+
+  struct Cancel
+  {
+    uint8_t opcode;   // IORING_OP_POLL_REMOVE or IORING_OP_ASYNC_CANCEL
+    uint64_t target;  // user_data of the request
+  };
+
+  bool setupRing();
+  bool setupRecvRing();
+  // NULL if the ring is full and can't be flushed now
+  io_uring_sqe* getSqe();
+  int submitAndWait(int timeoutMs);
+  int pollEventsOf(const Channel* channel) const;
+  bool wantRecv(const Channel* channel) const;
+  void armPoll(int slot);
+  void cancelPoll(int slot);
+  void armRecv(int slot);
+  void cancelRecv(int slot);
+  void cancel(uint8_t opcode, uint64_t target);
+  void provideRecvBuffer(int bid);
+  void queueSlot(int slot);
+  void activateSlot(int slot, int revents, int bid);
+  void reapCompletions();
+  void fillActiveChannels(ChannelList* activeChannels);
+
+  int ringfd_;
+  unsigned sqEntries_;
+  unsigned toSubmit_;
+  bool sqFull_;     // till next poll(), once flushing took nothing
+
+  void* sqRing_;
+  size_t sqRingSize_;
+  void* cqRing_;
+  size_t cqRingSize_;
+  io_uring_sqe* sqes_;
+  size_t sqesSize_;
+
+  unsigned* sqHead_;
+  unsigned* sqTail_;
+  unsigned* sqMask_;
+  unsigned* sqArray_;
+  unsigned* cqHead_;
+  unsigned* cqTail_;
+  unsigned* cqMask_;
+  io_uring_cqe* cqes_;
+
+  bool recvRingTried_;
+  void* recvRing_;
+  io_uring_buf* recvRingBufs_;
+  uint16_t* recvRingTailPtr_;
+  uint16_t recvRingTail_;
+  std::vector<Buffer> recvBuffers_;
+  std::vector<int> lentBuffers_;   // handed to channels in last poll()
+
+  std::vector<Slot> slots_;
+  std::vector<int> freeSlots_;
+  std::vector<int> pendingSlots_;  // to be (re-)armed in next poll()
+  std::vector<int> armingSlots_;   // pendingSlots_ being armed in poll()
+  std::vector<Cancel> pendingCancels_;  // the ring was full for
+  std::vector<int> activeSlots_;
+};
+
+}  // namespace net
+}  // namespace muduo
+#endif  // MUDUO_NET_POLLER_IOURINGPOLLER_H
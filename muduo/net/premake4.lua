@@ -19,20 +19,26 @@ project "net"
         'TcpConnection.h',
         'TcpServer.h',
         'TimerId.h',
+        'TrafficCounters.h',
     }
 
     files {
         'Acceptor.cc',
         'Buffer.cc',
+        'BufferPool.cc',
         'Channel.cc',
         'Connector.cc',
         'EventLoop.cc',
         'EventLoopThread.cc',
         'EventLoopThreadPool.cc',
+        'FunctorQueue.cc',
+        'IdleConnectionList.cc',
         'InetAddress.cc',
+        'OutputQueue.cc',
         'Poller.cc',
         'poller/DefaultPoller.cc',
         'poller/EPollPoller.cc',
+        'poller/IoUringPoller.cc',
         'poller/PollPoller.cc',
         'Socket.cc',
         'SocketsOps.cc',
@@ -41,5 +47,7 @@ project "net"
         'TcpServer.cc',
         'Timer.cc',
         'TimerQueue.cc',
+        'TimerWheel.cc',
+        'TrafficCounters.cc',
      }
 
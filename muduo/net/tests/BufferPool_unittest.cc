@@ -0,0 +1,113 @@
+#include <muduo/net/BufferPool.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/TcpServer.h>
+
+//#define BOOST_TEST_MODULE BufferPoolTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using muduo::string;
+using muduo::Timestamp;
+using muduo::net::Buffer;
+using muduo::net::BufferPool;
+using muduo::net::EventLoop;
+using muduo::net::InetAddress;
+using muduo::net::TcpConnectionPtr;
+using muduo::net::TcpServer;
+
+BOOST_AUTO_TEST_CASE(testBufferPoolReuse)
+{
+  BufferPool pool;
+  Buffer buf;
+  pool.reserve(&buf, 100 * 1000);
+  BOOST_CHECK_GE(buf.writableBytes(), 100 * 1000);
+  buf.append(string(100, 'x'));
+  const char* storage = buf.peek();
+
+  pool.shrink(&buf);
+  BOOST_CHECK_EQUAL(buf.readableBytes(), 100);
+  BOOST_CHECK_EQUAL(buf.retrieveAllAsString(), string(100, 'x'));
+  BOOST_CHECK_LT(buf.internalCapacity(), BufferPool::kMinPooledSize);
+  BOOST_CHECK_EQUAL(pool.numPooled(), 1);
+  BOOST_CHECK_GE(pool.pooledBytes(), 100 * 1000);
+
+  // same storage comes back, all of it writable
+  Buffer other(0);
+  pool.reserve(&other, 70 * 1000);
+  BOOST_CHECK(other.peek() == storage);
+  BOOST_CHECK_GE(other.writableBytes(), 100 * 1000);
+  BOOST_CHECK_EQUAL(pool.numPooled(), 0);
+  BOOST_CHECK_EQUAL(pool.pooledBytes(), 0);
+
+  pool.recycle(&other);
+  BOOST_CHECK_EQUAL(pool.numPooled(), 1);
+  BOOST_CHECK_EQUAL(other.readableBytes(), 0);
+  BOOST_CHECK_LT(other.internalCapacity(), BufferPool::kMinPooledSize);
+
+  // too small a request doesn't get a large storage
+  Buffer small(0);
+  pool.reserve(&small, 10 * 1000);
+  BOOST_CHECK_EQUAL(pool.numPooled(), 1);
+  BOOST_CHECK_GE(small.writableBytes(), 10 * 1000);
+}
+
+BOOST_AUTO_TEST_CASE(testBufferPoolLimit)
+{
+  BufferPool pool(100 * 1000);
+  Buffer a(64 * 1000);
+  Buffer b(64 * 1000);
+  Buffer huge(BufferPool::kMaxPooledSize);
+  pool.recycle(&a);
+  pool.recycle(&b);
+  pool.recycle(&huge);
+  BOOST_CHECK_EQUAL(pool.numPooled(), 1);
+  BOOST_CHECK_LE(pool.pooledBytes(), 100 * 1000);
+  BOOST_CHECK_LT(huge.internalCapacity(), BufferPool::kMinPooledSize);
+}
+
+BOOST_AUTO_TEST_CASE(testInputBufferShrink)
+{
+  EventLoop loop;
+  const uint16_t port = 23458;
+  TcpServer server(&loop, InetAddress(port, true), "ShrinkServer");
+  server.setBufferShrinkReads(4);
+  size_t peakCapacity = 0;
+  size_t lastCapacity = 0;
+  server.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    // capacity seen by this read, before adapting
+    peakCapacity = std::max(peakCapacity, buf->internalCapacity());
+    buf->retrieveAll();
+    lastCapacity = conn->inputBuffer()->internalCapacity();
+  });
+  server.start();
+
+  int fd = -1;
+  loop.runInLoop([&] {
+    fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    InetAddress addr(port, true);
+    BOOST_REQUIRE(::connect(fd, addr.getSockAddr(), sizeof(struct sockaddr_in)) == 0);
+    // a burst
+    string big(1024 * 1024, 'x');
+    BOOST_CHECK_EQUAL(::write(fd, big.data(), big.size()), big.size());
+  });
+  int ticks = 0;
+  loop.runEvery(0.05, [&] {
+    // then a trickle
+    if (++ticks > 4)
+    {
+      BOOST_CHECK_EQUAL(::write(fd, "x", 1), 1);
+    }
+  });
+  loop.runAfter(1.0, [&] { loop.quit(); });
+  loop.loop();
+
+  BOOST_CHECK_GT(peakCapacity, 128 * 1024);
+  BOOST_CHECK_LT(lastCapacity, BufferPool::kMinPooledSize);
+  BOOST_CHECK_EQUAL(loop.bufferPool()->numPooled() > 0, true);
+  ::close(fd);
+}
@@ -0,0 +1,149 @@
+#include <muduo/net/FunctorQueue.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/base/Thread.h>
+
+//#define BOOST_TEST_MODULE FunctorQueueTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <vector>
+
+using muduo::Thread;
+using muduo::net::EventLoop;
+using muduo::net::FunctorQueue;
+
+BOOST_AUTO_TEST_CASE(testFunctorQueueOrder)
+{
+  FunctorQueue queue;
+  BOOST_CHECK(queue.empty());
+  std::vector<int> result;
+  for (int i = 0; i < 10; ++i)
+  {
+    queue.push([&result, i] { result.push_back(i); });
+  }
+  BOOST_CHECK_EQUAL(queue.size(), 10);
+
+  std::vector<FunctorQueue::Functor> functors;
+  queue.takeAll(&functors);
+  BOOST_CHECK(queue.empty());
+  BOOST_CHECK_EQUAL(queue.size(), 0);
+  BOOST_REQUIRE_EQUAL(functors.size(), 10);
+  for (const FunctorQueue::Functor& f : functors)
+  {
+    f();
+  }
+  for (int i = 0; i < 10; ++i)
+  {
+    BOOST_CHECK_EQUAL(result[i], i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testFunctorQueueRecycle)
+{
+  FunctorQueue queue;
+  std::shared_ptr<int> captured(new int(0));
+  std::vector<int> result;
+  for (int round = 0; round < 3; ++round)
+  {
+    // more than the pool holds
+    const int n = FunctorQueue::kPoolNodes + 10;
+    for (int i = 0; i < n; ++i)
+    {
+      queue.push([&result, captured, i] { result.push_back(i); });
+    }
+    std::vector<FunctorQueue::Functor> functors;
+    queue.takeAll(&functors);
+    BOOST_REQUIRE_EQUAL(functors.size(), static_cast<size_t>(n));
+    // nodes hold nothing once taken
+    BOOST_CHECK_EQUAL(captured.use_count(), n + 1);
+    result.clear();
+    for (const FunctorQueue::Functor& f : functors)
+    {
+      f();
+    }
+    functors.clear();
+    BOOST_CHECK_EQUAL(captured.use_count(), 1);
+    for (int i = 0; i < n; ++i)
+    {
+      BOOST_CHECK_EQUAL(result[i], i);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testFunctorQueueProducers)
+{
+  const int kThreads = 4;
+  const int kPerThread = 100000;
+  FunctorQueue queue;
+  std::vector<int> last(kThreads, -1);
+  bool ordered = true;
+  int count = 0;
+
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int t = 0; t < kThreads; ++t)
+  {
+    threads.emplace_back(new Thread([&, t] {
+      for (int i = 0; i < kPerThread; ++i)
+      {
+        queue.push([&, t, i] {
+          // run by the consumer only
+          ordered = ordered && last[t] == i - 1;
+          last[t] = i;
+          ++count;
+        });
+      }
+    }));
+    threads.back()->start();
+  }
+
+  std::vector<FunctorQueue::Functor> functors;
+  while (count < kThreads * kPerThread)
+  {
+    functors.clear();
+    queue.takeAll(&functors);
+    for (const FunctorQueue::Functor& f : functors)
+    {
+      f();
+    }
+  }
+  for (auto& thr : threads)
+  {
+    thr->join();
+  }
+  BOOST_CHECK(ordered);
+  BOOST_CHECK_EQUAL(count, kThreads * kPerThread);
+  BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(testQueueInLoopFromThreads)
+{
+  const int kThreads = 4;
+  const int kPerThread = 20000;
+  EventLoop loop;
+  int count = 0;
+
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int t = 0; t < kThreads; ++t)
+  {
+    threads.emplace_back(new Thread([&] {
+      for (int i = 0; i < kPerThread; ++i)
+      {
+        loop.queueInLoop([&] {
+          if (++count == kThreads * kPerThread)
+          {
+            loop.quit();
+          }
+        });
+      }
+    }));
+    threads.back()->start();
+  }
+  loop.loop();
+  for (auto& thr : threads)
+  {
+    thr->join();
+  }
+  BOOST_CHECK_EQUAL(count, kThreads * kPerThread);
+}
@@ -0,0 +1,106 @@
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/TcpServer.h>
+
+//#define BOOST_TEST_MODULE IdleConnectionListTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using muduo::Timestamp;
+using muduo::net::Buffer;
+using muduo::net::EventLoop;
+using muduo::net::InetAddress;
+using muduo::net::TcpConnectionPtr;
+using muduo::net::TcpServer;
+
+namespace
+{
+int connectTo(uint16_t port)
+{
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  InetAddress addr(port, true);
+  BOOST_REQUIRE(::connect(fd, addr.getSockAddr(), sizeof(struct sockaddr_in)) == 0);
+  return fd;
+}
+}
+
+BOOST_AUTO_TEST_CASE(testIdleTimeout)
+{
+  EventLoop loop;
+  const uint16_t port = 23456;
+  TcpServer server(&loop, InetAddress(port, true), "IdleServer");
+  int up = 0;
+  int down = 0;
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    conn->connected() ? ++up : ++down;
+  });
+  server.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    conn->send(buf);
+  });
+  server.setIdleTimeout(0.3);
+  server.start();
+
+  int idle = -1;
+  int active = -1;
+  loop.runInLoop([&] {
+    idle = connectTo(port);
+    active = connectTo(port);
+  });
+  // keeps one of them talking
+  loop.runEvery(0.1, [&] {
+    BOOST_CHECK_EQUAL(::write(active, "x", 1), 1);
+  });
+  loop.runAfter(1.0, [&] { loop.quit(); });
+  loop.loop();
+
+  BOOST_CHECK_EQUAL(up, 2);
+  BOOST_CHECK_EQUAL(down, 1);
+  char buf[64];
+  // closed by the server
+  BOOST_CHECK_EQUAL(::read(idle, buf, sizeof buf), 0);
+  ::close(idle);
+  ::close(active);
+}
+
+// Only sending, every write done at once, is not idle either.
+BOOST_AUTO_TEST_CASE(testPushedIsNotIdle)
+{
+  EventLoop loop;
+  const uint16_t port = 23466;
+  TcpServer server(&loop, InetAddress(port, true), "PushServer");
+  int down = 0;
+  TcpConnectionPtr pushed;
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      pushed = conn;
+    }
+    else
+    {
+      ++down;
+      pushed.reset();
+    }
+  });
+  server.setIdleTimeout(0.3);
+  server.start();
+
+  int fd = -1;
+  loop.runInLoop([&] { fd = connectTo(port); });
+  loop.runEvery(0.1, [&] {
+    if (pushed)
+    {
+      pushed->send("x");
+    }
+  });
+  loop.runAfter(1.0, [&] { loop.quit(); });
+  loop.loop();
+
+  BOOST_CHECK_EQUAL(down, 0);
+  BOOST_CHECK(pushed);
+  pushed.reset();
+  ::close(fd);
+}
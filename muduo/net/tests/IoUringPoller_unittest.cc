@@ -0,0 +1,277 @@
+#include <muduo/net/poller/IoUringPoller.h>
+#include <muduo/base/Thread.h>
+#include <muduo/net/Channel.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/TcpServer.h>
+
+//#define BOOST_TEST_MODULE IoUringPollerTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using muduo::Thread;
+using muduo::Timestamp;
+using muduo::net::Buffer;
+using muduo::net::Channel;
+using muduo::net::EventLoop;
+using muduo::net::InetAddress;
+using muduo::net::IoUringPoller;
+using muduo::net::TcpConnectionPtr;
+using muduo::net::TcpServer;
+
+namespace
+{
+
+// and makes the EventLoops after it use one
+bool useIoUring()
+{
+  {
+    EventLoop loop;
+    IoUringPoller poller(&loop);
+    if (!poller.ok())
+    {
+      BOOST_TEST_MESSAGE("io_uring is not available, skipped");
+      return false;
+    }
+  }
+  ::setenv("MUDUO_USE_URING", "1", 1);
+  return true;
+}
+
+int connectTo(uint16_t port)
+{
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  InetAddress addr(port, true);
+  BOOST_REQUIRE(::connect(fd, addr.getSockAddr(), sizeof(struct sockaddr_in)) == 0);
+  return fd;
+}
+
+char byteAt(size_t offset)
+{
+  return static_cast<char>(offset % 251);
+}
+
+// echoes whole records only, the rest waits for more
+const size_t kRecordSize = 10;
+
+size_t echoRecords(const TcpConnectionPtr& conn, Buffer* buf)
+{
+  size_t n = buf->readableBytes() / kRecordSize * kRecordSize;
+  conn->send(buf->peek(), static_cast<int>(n));
+  buf->retrieve(n);
+  return n;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(testMoreChannelsThanRing)
+{
+  if (!useIoUring())
+  {
+    return;
+  }
+  struct rlimit rl;
+  BOOST_REQUIRE(::getrlimit(RLIMIT_NOFILE, &rl) == 0);
+  // a poll for each, armed in one poll(), 1024 fit in the ring
+  const int kChannels = static_cast<int>(std::min<rlim_t>(3000, (rl.rlim_cur - 64) / 2));
+  BOOST_REQUIRE(kChannels > 1024);
+
+  EventLoop loop;
+  std::vector<int> writers;
+  std::vector<std::unique_ptr<Channel>> channels;
+  int fired = 0;
+  for (int i = 0; i < kChannels; ++i)
+  {
+    int fds[2];
+    BOOST_REQUIRE(::pipe(fds) == 0);
+    BOOST_REQUIRE(::write(fds[1], "x", 1) == 1);
+    writers.push_back(fds[1]);
+    channels.emplace_back(new Channel(&loop, fds[0]));
+    Channel* channel = channels.back().get();
+    channel->setReadCallback([&, channel](Timestamp) {
+      char c;
+      BOOST_CHECK_EQUAL(::read(channel->fd(), &c, 1), 1);
+      channel->disableAll();
+      if (++fired == kChannels)
+      {
+        loop.quit();
+      }
+    });
+  }
+  loop.runInLoop([&] {
+    for (auto& channel : channels)
+    {
+      channel->enableReading();
+    }
+  });
+  loop.runAfter(10.0, [&] { loop.quit(); });
+  loop.loop();
+  BOOST_CHECK_EQUAL(fired, kChannels);
+
+  for (auto& channel : channels)
+  {
+    channel->disableAll();
+    channel->remove();
+    ::close(channel->fd());
+  }
+  for (int fd : writers)
+  {
+    ::close(fd);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testZeroCopyEcho)
+{
+  if (!useIoUring())
+  {
+    return;
+  }
+  EventLoop loop;
+  const uint16_t port = 23475;
+  TcpServer server(&loop, InetAddress(port, true), "ZeroCopyServer");
+  server.setZeroCopyRecv(true);
+  // the ring lends 128 buffers of 32KiB, more than that must be given back,
+  // whole records
+  const size_t kTotal = 8000000;
+  size_t sentBack = 0;
+  int lentCalls = 0;
+  int lateLentCalls = 0;
+  server.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    if (buf != conn->inputBuffer())
+    {
+      ++lentCalls;
+      if (sentBack > kTotal / 2)
+      {
+        ++lateLentCalls;
+      }
+    }
+    sentBack += echoRecords(conn, buf);
+  });
+  server.start();
+
+  int fd = connectTo(port);
+  std::atomic<bool> matched(true);
+  std::atomic<size_t> echoed(0);
+  // not split at records, so some are kept for the next recv
+  Thread writer([&] {
+    std::vector<char> chunk;
+    size_t sent = 0;
+    for (size_t i = 0; sent < kTotal; ++i)
+    {
+      size_t len = std::min<size_t>(i * 7919 % 20000 + 1, kTotal - sent);
+      chunk.resize(len);
+      for (size_t j = 0; j < len; ++j)
+      {
+        chunk[j] = byteAt(sent + j);
+      }
+      if (::write(fd, chunk.data(), len) != static_cast<ssize_t>(len))
+      {
+        matched = false;
+        break;
+      }
+      sent += len;
+    }
+  });
+  Thread reader([&] {
+    char buf[65536];
+    size_t offset = 0;
+    while (offset < kTotal)
+    {
+      ssize_t n = ::read(fd, buf, sizeof buf);
+      if (n <= 0)
+      {
+        break;
+      }
+      for (ssize_t j = 0; j < n; ++j)
+      {
+        if (buf[j] != byteAt(offset + j))
+        {
+          matched = false;
+        }
+      }
+      offset += n;
+    }
+    echoed = offset;
+    loop.quit();
+  });
+  writer.start();
+  reader.start();
+  loop.runAfter(20.0, [&] { loop.quit(); ::shutdown(fd, SHUT_RDWR); });
+  loop.loop();
+  writer.join();
+  reader.join();
+  ::close(fd);
+
+  BOOST_CHECK(matched);
+  BOOST_CHECK_EQUAL(echoed, kTotal);
+  BOOST_CHECK_EQUAL(sentBack, kTotal);
+  // provided buffers were handed over, and kept coming back
+  BOOST_CHECK_GT(lentCalls, 0);
+  BOOST_CHECK_GT(lateLentCalls, 0);
+}
+
+BOOST_AUTO_TEST_CASE(testZeroCopyParked)
+{
+  if (!useIoUring())
+  {
+    return;
+  }
+  EventLoop loop;
+  const uint16_t port = 23476;
+  TcpServer server(&loop, InetAddress(port, true), "ParkedServer");
+  server.setZeroCopyRecv(true);
+  TcpConnectionPtr connection;
+  size_t received = 0;
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      connection = conn;
+    }
+  });
+  server.setMessageCallback([&](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    received += buf->readableBytes();
+    echoRecords(conn, buf);
+  });
+  server.start();
+
+  int fd = connectTo(port);
+  // once a recv is in flight
+  loop.runAfter(0.1, [&] {
+    BOOST_REQUIRE(connection);
+    connection->stopRead();
+  });
+  loop.runAfter(0.2, [&] {
+    BOOST_CHECK_EQUAL(::write(fd, "0123456789", 10), 10);
+  });
+  loop.runAfter(0.3, [&] {
+    // received by the recv in flight, parked till reading again
+    BOOST_CHECK_EQUAL(received, 0u);
+    connection->startRead();
+  });
+  loop.runAfter(0.5, [&] {
+    BOOST_CHECK_EQUAL(received, 10u);
+    char buf[16];
+    BOOST_CHECK_EQUAL(::read(fd, buf, sizeof buf), 10);
+    BOOST_CHECK_EQUAL(::memcmp(buf, "0123456789", 10), 0);
+    BOOST_CHECK_EQUAL(::write(fd, "abcdefghij", 10), 10);
+  });
+  loop.runAfter(0.7, [&] {
+    BOOST_CHECK_EQUAL(received, 20u);
+    ::close(fd);
+  });
+  loop.runAfter(0.9, [&] { loop.quit(); });
+  loop.loop();
+  BOOST_CHECK(server.connections().empty());
+  connection.reset();
+}
@@ -0,0 +1,182 @@
+#include <muduo/net/OutputQueue.h>
+
+//#define BOOST_TEST_MODULE OutputQueueTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using muduo::string;
+using muduo::net::Buffer;
+using muduo::net::OutputQueue;
+
+namespace
+{
+string readAll(int fd)
+{
+  string result;
+  char buf[4096];
+  ssize_t n = 0;
+  while ((n = ::read(fd, buf, sizeof buf)) > 0)
+  {
+    result.append(buf, n);
+  }
+  return result;
+}
+}
+
+BOOST_AUTO_TEST_CASE(testOutputQueueAppend)
+{
+  OutputQueue queue;
+  BOOST_CHECK(queue.empty());
+  queue.append("hello", 5);
+  queue.append(" world", 6);
+  BOOST_CHECK_EQUAL(queue.readableBytes(), 11);
+  BOOST_CHECK_EQUAL(queue.numSegments(), 1);
+
+  const string big(OutputQueue::kMaxCoalesceBytes, 'x');
+  queue.append(big.data(), big.size());
+  BOOST_CHECK_EQUAL(queue.readableBytes(), 11 + big.size());
+  BOOST_CHECK_EQUAL(queue.numSegments(), 2);
+
+  queue.retrieve(5);
+  BOOST_CHECK_EQUAL(queue.readableBytes(), 6 + big.size());
+  BOOST_CHECK_EQUAL(queue.numSegments(), 2);
+  queue.retrieve(6);
+  BOOST_CHECK_EQUAL(queue.numSegments(), 1);
+  queue.retrieveAll();
+  BOOST_CHECK(queue.empty());
+  BOOST_CHECK_EQUAL(queue.numSegments(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testOutputQueueAppendBuffer)
+{
+  OutputQueue queue;
+  Buffer small;
+  small.append("abc", 3);
+  queue.appendBuffer(&small);
+  BOOST_CHECK_EQUAL(small.readableBytes(), 0);
+  BOOST_CHECK_EQUAL(queue.numSegments(), 1);
+
+  Buffer large;
+  large.append(string(4096, 'y'));
+  queue.appendBuffer(&large);
+  BOOST_CHECK_EQUAL(large.readableBytes(), 0);
+  BOOST_CHECK_EQUAL(queue.numSegments(), 2);
+  BOOST_CHECK_EQUAL(queue.readableBytes(), 3 + 4096);
+
+  int fds[2];
+  BOOST_REQUIRE(::pipe2(fds, O_NONBLOCK) == 0);
+  int savedErrno = 0;
+  ssize_t n = queue.writeFd(fds[1], &savedErrno);
+  BOOST_CHECK_EQUAL(n, 3 + 4096);
+  BOOST_CHECK(queue.empty());
+  ::close(fds[1]);
+  BOOST_CHECK_EQUAL(readAll(fds[0]), "abc" + string(4096, 'y'));
+  ::close(fds[0]);
+}
+
+BOOST_AUTO_TEST_CASE(testOutputQueueSlice)
+{
+  std::shared_ptr<const string> block(new string("shared block"));
+  OutputQueue queue;
+  queue.append("head,", 5);
+  queue.appendSlice(block->data(), block->size(), block);
+  BOOST_CHECK_EQUAL(block.use_count(), 2);
+  queue.append(",tail", 5);
+  BOOST_CHECK_EQUAL(queue.numSegments(), 3);
+
+  queue.retrieve(8);
+  BOOST_CHECK_EQUAL(queue.numSegments(), 2);
+  BOOST_CHECK_EQUAL(block.use_count(), 2);
+
+  int fds[2];
+  BOOST_REQUIRE(::pipe2(fds, O_NONBLOCK) == 0);
+  int savedErrno = 0;
+  ssize_t n = queue.writeFd(fds[1], &savedErrno);
+  BOOST_CHECK_EQUAL(n, 14);
+  BOOST_CHECK(queue.empty());
+  BOOST_CHECK_EQUAL(block.use_count(), 1);
+  ::close(fds[1]);
+  BOOST_CHECK_EQUAL(readAll(fds[0]), "red block,tail");
+  ::close(fds[0]);
+}
+BOOST_AUTO_TEST_CASE(testOutputQueueFileAndPipe)
+{
+  char name[] = "/tmp/outputqueue_XXXXXX";
+  int file = ::mkstemp(name);
+  BOOST_REQUIRE(file >= 0);
+  ::unlink(name);
+  BOOST_REQUIRE(::write(file, "0123456789", 10) == 10);
+
+  int source[2];
+  BOOST_REQUIRE(::pipe2(source, O_NONBLOCK) == 0);
+  BOOST_REQUIRE(::write(source[1], "piped", 5) == 5);
+
+  OutputQueue queue;
+  queue.append("<", 1);
+  queue.appendFile(file, 2, 6);
+  queue.appendPipe(source[0], 5);
+  queue.append(">", 1);
+  BOOST_CHECK_EQUAL(queue.readableBytes(), 13);
+  BOOST_CHECK_EQUAL(queue.numSegments(), 4);
+
+  int fds[2];
+  BOOST_REQUIRE(::pipe2(fds, O_NONBLOCK) == 0);
+  int savedErrno = 0;
+  // in memory, file, pipe, in memory
+  BOOST_CHECK_EQUAL(queue.writeFd(fds[1], &savedErrno), 1);
+  BOOST_CHECK_EQUAL(queue.writeFd(fds[1], &savedErrno), 6);
+  BOOST_CHECK_EQUAL(queue.writeFd(fds[1], &savedErrno), 5);
+  BOOST_CHECK_EQUAL(queue.writeFd(fds[1], &savedErrno), 1);
+  BOOST_CHECK(queue.empty());
+
+  // file is shorter than queued, the owner goes with it
+  std::shared_ptr<const void> owner = std::make_shared<int>(file);
+  queue.appendFile(file, 8, 10, owner);
+  BOOST_CHECK_EQUAL(owner.use_count(), 2);
+  BOOST_CHECK_EQUAL(queue.writeFd(fds[1], &savedErrno), 2);
+  BOOST_CHECK_EQUAL(queue.writeFd(fds[1], &savedErrno), -1);
+  BOOST_CHECK_EQUAL(savedErrno, EIO);
+  BOOST_CHECK(queue.empty());
+  BOOST_CHECK_EQUAL(owner.use_count(), 1);
+  // nothing to write, no syscall
+  savedErrno = 0;
+  BOOST_CHECK_EQUAL(queue.writeFd(-1, &savedErrno), 0);
+  BOOST_CHECK_EQUAL(savedErrno, 0);
+
+  ::close(fds[1]);
+  BOOST_CHECK_EQUAL(readAll(fds[0]), "<234567piped>89");
+  ::close(fds[0]);
+
+  // pipe holds less than queued, but is still open
+  BOOST_REQUIRE(::pipe2(fds, O_NONBLOCK) == 0);
+  BOOST_REQUIRE(::write(source[1], "abc", 3) == 3);
+  queue.appendPipe(source[0], 5);
+  BOOST_CHECK_EQUAL(queue.writeFd(fds[1], &savedErrno), 3);
+  BOOST_CHECK_EQUAL(queue.writeFd(fds[1], &savedErrno), -1);
+  BOOST_CHECK_EQUAL(savedErrno, EIO);
+  BOOST_CHECK(queue.empty());
+
+  // the sink is full, not the pipe empty, wait for it
+  std::string fill(65536, 'f');
+  while (::write(fds[1], fill.data(), fill.size()) > 0)
+  {
+  }
+  BOOST_REQUIRE(::write(source[1], "def", 3) == 3);
+  queue.appendPipe(source[0], 3);
+  BOOST_CHECK_EQUAL(queue.writeFd(fds[1], &savedErrno), -1);
+  BOOST_CHECK_EQUAL(savedErrno, EAGAIN);
+  BOOST_CHECK_EQUAL(queue.readableBytes(), 3);
+
+  ::close(fds[1]);
+  ::close(fds[0]);
+  queue.retrieveAll();
+  ::close(source[0]);
+  ::close(source[1]);
+  ::close(file);
+}
@@ -0,0 +1,307 @@
+#include <muduo/base/CurrentThread.h>
+#include <muduo/base/Thread.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/SocketsOps.h>
+#include <muduo/net/TcpServer.h>
+
+//#define BOOST_TEST_MODULE TcpServerTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using muduo::MutexLock;
+using muduo::MutexLockGuard;
+using muduo::Thread;
+using muduo::Timestamp;
+using muduo::net::Buffer;
+using muduo::net::EventLoop;
+using muduo::net::EventLoopThreadPool;
+using muduo::net::InetAddress;
+using muduo::net::TcpConnectionPtr;
+using muduo::net::TcpServer;
+
+BOOST_AUTO_TEST_CASE(testReusePortEachLoop)
+{
+  EventLoop loop;
+  const uint16_t port = 23459;
+  TcpServer server(&loop, InetAddress(port, true), "EachLoopServer",
+                   TcpServer::kReusePortEachLoop);
+  server.setThreadNum(4);
+  MutexLock mutex;
+  std::set<EventLoop*> loops;
+  std::atomic<int> up(0);
+  std::atomic<int> down(0);
+  std::atomic<int> handedOff(0);
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      ++up;
+      MutexLockGuard lock(mutex);
+      loops.insert(conn->getLoop());
+    }
+    else
+    {
+      ++down;
+    }
+    if (conn->getLoop() == &loop)
+    {
+      ++handedOff;
+    }
+  });
+  server.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    conn->send(buf);
+  });
+  server.start();
+
+  const int kClients = 64;
+  int fds[kClients];
+  loop.runAfter(0.1, [&] {
+    for (int i = 0; i < kClients; ++i)
+    {
+      fds[i] = ::socket(AF_INET, SOCK_STREAM, 0);
+      InetAddress addr(port, true);
+      BOOST_REQUIRE(::connect(fds[i], addr.getSockAddr(), sizeof(struct sockaddr_in)) == 0);
+      BOOST_CHECK_EQUAL(::write(fds[i], "ping", 4), 4);
+    }
+  });
+  loop.runAfter(0.5, [&] {
+    BOOST_CHECK_EQUAL(server.connections().size(), kClients);
+    for (int i = 0; i < kClients; ++i)
+    {
+      char buf[16];
+      BOOST_CHECK_EQUAL(::read(fds[i], buf, sizeof buf), 4);
+      ::close(fds[i]);
+    }
+  });
+  loop.runAfter(0.8, [&] { loop.quit(); });
+  loop.loop();
+
+  BOOST_CHECK_EQUAL(up, kClients);
+  BOOST_CHECK_EQUAL(down, kClients);
+  BOOST_CHECK_EQUAL(handedOff, 0);
+  // the kernel spreads them among the loops
+  BOOST_CHECK_GT(loops.size(), 1);
+  BOOST_CHECK(server.connections().empty());
+}
+
+namespace
+{
+void connectMany(uint16_t port, int* fds, int n)
+{
+  for (int i = 0; i < n; ++i)
+  {
+    fds[i] = ::socket(AF_INET, SOCK_STREAM, 0);
+    InetAddress addr(port, true);
+    BOOST_REQUIRE(::connect(fds[i], addr.getSockAddr(), sizeof(struct sockaddr_in)) == 0);
+  }
+}
+}
+
+BOOST_AUTO_TEST_CASE(testBatchedAccept)
+{
+  EventLoop loop;
+  const uint16_t port = 23460;
+  TcpServer server(&loop, InetAddress(port, true), "BatchServer");
+  server.setMaxAcceptsPerRead(16);
+  server.start();
+
+  const int kClients = 32;
+  int fds[kClients];
+  // all in backlog before the loop gets to accept
+  loop.runAfter(0.1, [&] { connectMany(port, fds, kClients); });
+  loop.runAfter(0.3, [&] { loop.quit(); });
+  loop.loop();
+
+  TcpServer::AcceptStats stats = server.acceptStats();
+  BOOST_CHECK_EQUAL(stats.accepted, kClients);
+  BOOST_CHECK_LE(stats.wakeups, 3);
+  BOOST_CHECK_EQUAL(stats.throttled, 0);
+  for (int i = 0; i < kClients; ++i)
+  {
+    ::close(fds[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testAcceptRateLimit)
+{
+  EventLoop loop;
+  const uint16_t port = 23461;
+  TcpServer server(&loop, InetAddress(port, true), "LimitedServer");
+  server.setAcceptRateLimit(10, 5);
+  server.start();
+
+  const int kClients = 20;
+  int fds[kClients];
+  loop.runAfter(0.1, [&] { connectMany(port, fds, kClients); });
+  loop.runAfter(0.6, [&] { loop.quit(); });
+  loop.loop();
+
+  // 5 at once, then one per 0.1 second
+  TcpServer::AcceptStats stats = server.acceptStats();
+  BOOST_CHECK_GE(stats.accepted, 5 + 3);
+  BOOST_CHECK_LE(stats.accepted, 5 + 6);
+  BOOST_CHECK_GE(stats.throttled, 3);
+  BOOST_CHECK_EQUAL(server.connections().size(), stats.accepted);
+  for (int i = 0; i < kClients; ++i)
+  {
+    ::close(fds[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testLeastConnectionsPlacement)
+{
+  EventLoop loop;
+  const uint16_t port = 23462;
+  TcpServer server(&loop, InetAddress(port, true), "PlacedServer");
+  server.setThreadNum(3);
+  server.setLoopPlacement(EventLoopThreadPool::kLeastConnections);
+  MutexLock mutex;
+  std::map<uint16_t, EventLoop*> placed;  // by client port
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->connected())
+    {
+      MutexLockGuard lock(mutex);
+      placed[conn->peerAddress().toPort()] = conn->getLoop();
+    }
+  });
+  server.start();
+
+  int fds[4];
+  uint16_t ports[4];
+  auto connectSome = [&](int first, int n) {
+    connectMany(port, fds + first, n);
+    for (int i = first; i < first + n; ++i)
+    {
+      ports[i] = InetAddress(muduo::net::sockets::getLocalAddr(fds[i])).toPort();
+    }
+  };
+  // a burst of 3 is spread, though none is established when placed
+  loop.runAfter(0.1, [&] { connectSome(0, 3); });
+  // frees the loop of the second one
+  loop.runAfter(0.3, [&] { ::close(fds[1]); });
+  loop.runAfter(0.5, [&] { connectSome(3, 1); });
+  loop.runAfter(0.7, [&] { loop.quit(); });
+  loop.loop();
+
+  EventLoop* loops[4];
+  for (int i = 0; i < 4; ++i)
+  {
+    MutexLockGuard lock(mutex);
+    loops[i] = placed[ports[i]];
+    BOOST_CHECK(loops[i] != NULL);
+  }
+  BOOST_CHECK_EQUAL(std::set<EventLoop*>(loops, loops + 3).size(), 3);
+  BOOST_CHECK(loops[3] == loops[1]);
+  ::close(fds[0]);
+  ::close(fds[2]);
+  ::close(fds[3]);
+}
+
+BOOST_AUTO_TEST_CASE(testLeastQueuedAndBusyPlacement)
+{
+  EventLoop loop;
+  EventLoopThreadPool pool(&loop, "placement");
+  pool.setThreadNum(3);
+  pool.start();
+  std::vector<EventLoop*> loops = pool.getAllLoops();
+
+  // keeps loops[0] busy with a long queue
+  for (int i = 0; i < 10; ++i)
+  {
+    loops[0]->queueInLoop([] { ::usleep(30 * 1000); });
+  }
+  pool.setPlacement(EventLoopThreadPool::kLeastQueued);
+  for (int i = 0; i < 6; ++i)
+  {
+    BOOST_CHECK(pool.getNextLoop() != loops[0]);
+  }
+
+  pool.setPlacement(EventLoopThreadPool::kLeastBusy);
+  pool.getNextLoop();  // first sample
+  ::usleep(150 * 1000);
+  for (int i = 0; i < 6; ++i)
+  {
+    BOOST_CHECK(pool.getNextLoop() != loops[0]);
+  }
+}
+
+// A file shorter than what's queued of it closes the connection, the
+// peer isn't left waiting for the rest, sent at once or once writable.
+BOOST_AUTO_TEST_CASE(testShortFileCloses)
+{
+  char name[] = "/tmp/tcpserver_XXXXXX";
+  int file = ::mkstemp(name);
+  BOOST_REQUIRE(file >= 0);
+  ::unlink(name);
+  BOOST_REQUIRE(::write(file, "0123456789", 10) == 10);
+
+  EventLoop loop;
+  const uint16_t port = 23465;
+  TcpServer server(&loop, InetAddress(port, true), "ShortFileServer");
+  const std::string big(4 * 1024 * 1024, 'x');
+  std::atomic<int> down(0);
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (!conn->connected())
+    {
+      ++down;
+      return;
+    }
+    if (down == 0)
+    {
+      // the file goes with the first write
+      conn->sendFile(file, 0, 100);
+    }
+    else
+    {
+      // queued behind what fills up the socket
+      conn->send(big);
+      conn->sendFile(file, 0, 100);
+    }
+  });
+  server.start();
+
+  std::vector<size_t> received;
+  Thread client([&] {
+    for (int i = 0; i < 2; ++i)
+    {
+      int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+      struct timeval timeout = { 5, 0 };
+      ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+      InetAddress addr(port, true);
+      BOOST_REQUIRE(::connect(fd, addr.getSockAddr(), sizeof(struct sockaddr_in)) == 0);
+      ::usleep(100 * 1000);
+      size_t total = 0;
+      char buf[65536];
+      ssize_t n = 0;
+      while ((n = ::read(fd, buf, sizeof buf)) > 0)
+      {
+        total += n;
+      }
+      BOOST_CHECK_EQUAL(n, 0);  // closed, not timed out
+      received.push_back(total);
+      ::close(fd);
+    }
+    loop.quit();
+  });
+  loop.runAfter(0.1, [&client] { client.start(); });
+  loop.runAfter(20.0, [&loop] { loop.quit(); });
+  loop.loop();
+  client.join();
+  ::close(file);
+
+  BOOST_REQUIRE_EQUAL(received.size(), 2);
+  BOOST_CHECK_EQUAL(received[0], 10);
+  BOOST_CHECK_EQUAL(received[1], big.size() + 10);
+  BOOST_CHECK_EQUAL(down, 2);
+}
@@ -0,0 +1,182 @@
+#include <muduo/net/TimerWheel.h>
+#include <muduo/net/Timer.h>
+
+//#define BOOST_TEST_MODULE TimerWheelTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+using muduo::Timestamp;
+using muduo::net::Timer;
+using muduo::net::TimerWheel;
+
+namespace
+{
+const int64_t kTick = 1000;  // 1ms
+const Timestamp kOrigin(1000 * 1000 * 1000);
+
+Timestamp at(int64_t us)
+{
+  return Timestamp(kOrigin.microSecondsSinceEpoch() + us);
+}
+
+struct Recorder
+{
+  std::vector<int> fired;
+  std::vector<int64_t> when;
+};
+
+void add(TimerWheel* wheel, Recorder* rec, int id, int64_t us, double interval = 0.0)
+{
+  Timer* timer = wheel->newTimer([rec, id] { rec->fired.push_back(id); },
+                                 at(us), interval);
+  wheel->insert(timer);
+}
+}
+
+BOOST_AUTO_TEST_CASE(testTimerWheelExpire)
+{
+  TimerWheel wheel(kOrigin, kTick);
+  Recorder rec;
+  BOOST_CHECK(!wheel.nextWakeup().valid());
+
+  add(&wheel, &rec, 1, 1500);
+  add(&wheel, &rec, 2, 3000);
+  add(&wheel, &rec, 3, 300 * 1000);  // level 1
+  BOOST_CHECK_EQUAL(wheel.size(), 3);
+  // rounded up to tick, never early
+  BOOST_CHECK(wheel.nextWakeup() == at(2000));
+
+  wheel.expire(at(1999));
+  BOOST_CHECK(rec.fired.empty());
+  wheel.expire(at(2000));
+  BOOST_REQUIRE_EQUAL(rec.fired.size(), 1);
+  BOOST_CHECK_EQUAL(rec.fired[0], 1);
+  BOOST_CHECK(wheel.nextWakeup() == at(3000));
+
+  wheel.expire(at(10000));
+  BOOST_REQUIRE_EQUAL(rec.fired.size(), 2);
+  // cascaded at 256 ticks
+  BOOST_CHECK(wheel.nextWakeup() == at(256 * 1000));
+  wheel.expire(at(256 * 1000));
+  BOOST_CHECK_EQUAL(rec.fired.size(), 2);
+  BOOST_CHECK(wheel.nextWakeup() == at(300 * 1000));
+  wheel.expire(at(300 * 1000));
+  BOOST_REQUIRE_EQUAL(rec.fired.size(), 3);
+  BOOST_CHECK_EQUAL(rec.fired[2], 3);
+  BOOST_CHECK_EQUAL(wheel.size(), 0);
+  BOOST_CHECK(!wheel.nextWakeup().valid());
+}
+
+BOOST_AUTO_TEST_CASE(testTimerWheelFarAway)
+{
+  TimerWheel wheel(kOrigin, kTick);
+  Recorder rec;
+  const int64_t kHour = 3600LL * 1000 * 1000;
+  const int64_t kYear = 365 * 24 * kHour;  // beyond the top level
+  add(&wheel, &rec, 1, kHour);
+  add(&wheel, &rec, 2, kYear);
+
+  // wakes up only to cascade, then fires on time
+  int wakeups = 0;
+  while (wheel.size() > 0)
+  {
+    Timestamp next = wheel.nextWakeup();
+    BOOST_REQUIRE(next.valid());
+    wheel.expire(next);
+    ++wakeups;
+    if (rec.fired.size() == 1 && wakeups < 1000)
+    {
+      BOOST_CHECK(next == at(kHour));
+      wakeups = 1000;
+    }
+  }
+  BOOST_REQUIRE_EQUAL(rec.fired.size(), 2);
+  BOOST_CHECK(wheel.nextWakeup().valid() == false);
+  BOOST_CHECK_LT(wakeups, 1000 + 100);
+}
+
+BOOST_AUTO_TEST_CASE(testTimerWheelCancel)
+{
+  TimerWheel wheel(kOrigin, kTick);
+  Recorder rec;
+  Timer* t1 = wheel.newTimer([&rec] { rec.fired.push_back(1); }, at(5000), 0.0);
+  int64_t seq1 = t1->sequence();
+  wheel.insert(t1);
+  Timer* t2 = wheel.newTimer([&rec] { rec.fired.push_back(2); }, at(5000), 0.0);
+  wheel.insert(t2);
+  // t3 cancels t2, which is in the same slot
+  int64_t seq2 = t2->sequence();
+  Timer* t3 = wheel.newTimer([&] { rec.fired.push_back(3); wheel.cancel(t2, seq2); },
+                             at(5000), 0.0);
+  wheel.insert(t3);
+
+  wheel.cancel(t1, seq1);
+  BOOST_CHECK_EQUAL(wheel.size(), 2);
+  // pooled and reused, the old id doesn't cancel the new one
+  Timer* t4 = wheel.newTimer([&rec] { rec.fired.push_back(4); }, at(6000), 0.0);
+  BOOST_CHECK(t4 == t1);
+  wheel.insert(t4);
+  wheel.cancel(t1, seq1);
+  BOOST_CHECK_EQUAL(wheel.size(), 3);
+
+  wheel.expire(at(10000));
+  BOOST_REQUIRE_EQUAL(rec.fired.size(), 2);
+  BOOST_CHECK_EQUAL(rec.fired[0], 3);
+  BOOST_CHECK_EQUAL(rec.fired[1], 4);
+}
+
+BOOST_AUTO_TEST_CASE(testTimerWheelRepeat)
+{
+  TimerWheel wheel(kOrigin, kTick);
+  int count = 0;
+  Timer* timer = nullptr;
+  int64_t seq = 0;
+  timer = wheel.newTimer([&] {
+    if (++count == 3)
+    {
+      wheel.cancel(timer, seq);  // from its own callback
+    }
+  }, at(2000), 0.002);
+  seq = timer->sequence();
+  wheel.insert(timer);
+
+  for (int64_t us = 0; us < 100 * 1000; us += 500)
+  {
+    wheel.expire(at(us));
+  }
+  BOOST_CHECK_EQUAL(count, 3);
+  BOOST_CHECK_EQUAL(wheel.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testTimerWheelMany)
+{
+  TimerWheel wheel(kOrigin, kTick);
+  int64_t fired = 0;
+  int64_t spurious = 0;
+  const int kTimers = 100000;
+  for (int i = 0; i < kTimers; ++i)
+  {
+    int64_t us = (static_cast<int64_t>(i) * 7919) % (600LL * 1000 * 1000);
+    Timer* timer = wheel.newTimer([&fired] { ++fired; }, at(us), 0.0);
+    wheel.insert(timer);
+  }
+  BOOST_CHECK_EQUAL(wheel.size(), kTimers);
+  Timestamp next = wheel.nextWakeup();
+  while (next.valid())
+  {
+    size_t before = wheel.size();
+    wheel.expire(next);
+    int64_t us = next.microSecondsSinceEpoch() - kOrigin.microSecondsSinceEpoch();
+    // woke up for nothing, not even cascading
+    if (before == wheel.size() && us % (256 * kTick) != 0)
+    {
+      ++spurious;
+    }
+    next = wheel.nextWakeup();
+  }
+  BOOST_CHECK_EQUAL(fired, kTimers);
+  BOOST_CHECK_EQUAL(spurious, 0);
+}
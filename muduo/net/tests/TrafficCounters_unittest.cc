@@ -0,0 +1,96 @@
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/TcpServer.h>
+
+//#define BOOST_TEST_MODULE TrafficCountersTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using muduo::Timestamp;
+using muduo::net::Buffer;
+using muduo::net::EventLoop;
+using muduo::net::InetAddress;
+using muduo::net::TcpConnectionPtr;
+using muduo::net::TcpServer;
+using muduo::net::TrafficCounters;
+
+BOOST_AUTO_TEST_CASE(testTrafficCountersAccumulate)
+{
+  TrafficCounters a;
+  a.add(TrafficCounters::kBytesSent, 10);
+  a.setMax(TrafficCounters::kOutputBytesPeak, 100);
+  a.setMax(TrafficCounters::kOutputBytesPeak, 50);
+  BOOST_CHECK_EQUAL(a.get(TrafficCounters::kOutputBytesPeak), 100);
+
+  TrafficCounters b;
+  b.add(TrafficCounters::kBytesSent, 5);
+  b.setMax(TrafficCounters::kOutputBytesPeak, 70);
+
+  TrafficCounters total;
+  total.accumulate(a);
+  total.accumulate(b);
+  BOOST_CHECK_EQUAL(total.get(TrafficCounters::kBytesSent), 15);
+  BOOST_CHECK_EQUAL(total.get(TrafficCounters::kOutputBytesPeak), 100);
+  BOOST_CHECK(total.toString().find("bytesSent          15\n") != muduo::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(testTrafficOfEchoServer)
+{
+  EventLoop loop;
+  const uint16_t port = 23457;
+  TcpServer server(&loop, InetAddress(port, true), "TrafficServer");
+  int64_t connReceived = 0;
+  server.setConnectionCallback([&](const TcpConnectionPtr& conn) {
+    if (conn->disconnected())
+    {
+      connReceived = conn->trafficCounters().get(TrafficCounters::kBytesReceived);
+    }
+  });
+  server.setMessageCallback([](const TcpConnectionPtr& conn, Buffer* buf, Timestamp) {
+    conn->send(buf);
+  });
+  server.start();
+
+  int fd = -1;
+  loop.runInLoop([&] {
+    fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    InetAddress addr(port, true);
+    BOOST_REQUIRE(::connect(fd, addr.getSockAddr(), sizeof(struct sockaddr_in)) == 0);
+  });
+  int sent = 0;
+  loop.runEvery(0.05, [&] {
+    if (sent < 3)
+    {
+      BOOST_CHECK_EQUAL(::write(fd, "hello", 5), 5);
+      ++sent;
+    }
+  });
+  loop.runAfter(0.3, [&] {
+    TrafficCounters total;
+    server.getTrafficCounters(&total);
+    BOOST_CHECK_EQUAL(server.connections().size(), 1);
+    BOOST_CHECK_EQUAL(total.get(TrafficCounters::kConnections), 1);
+    BOOST_CHECK_EQUAL(loop.trafficCounters()->get(TrafficCounters::kConnections), 1);
+    char buf[64];
+    BOOST_CHECK_EQUAL(::read(fd, buf, sizeof buf), 15);
+    ::close(fd);
+  });
+  loop.runAfter(0.5, [&] { loop.quit(); });
+  loop.loop();
+
+  TrafficCounters total;
+  server.getTrafficCounters(&total);
+  BOOST_CHECK_EQUAL(total.get(TrafficCounters::kBytesReceived), 15);
+  BOOST_CHECK_EQUAL(total.get(TrafficCounters::kBytesSent), 15);
+  BOOST_CHECK_EQUAL(total.get(TrafficCounters::kMessagesReceived), 3);
+  BOOST_CHECK_EQUAL(total.get(TrafficCounters::kMessagesSent), 3);
+  BOOST_CHECK_EQUAL(total.get(TrafficCounters::kConnections), 0);
+  BOOST_CHECK_EQUAL(total.get(TrafficCounters::kConnectionsTotal), 1);
+  BOOST_CHECK(total.get(TrafficCounters::kLastReceiveTime) > 0);
+  BOOST_CHECK_EQUAL(connReceived, 15);
+  BOOST_CHECK(server.connections().empty());
+}